@@ -2,6 +2,7 @@
 
 #include <string>
 #include "rapidjson/document.h"
+#include "gdax/json.h"
 
 namespace gdax {
 
@@ -22,13 +23,17 @@ namespace gdax {
 
         template<typename parserT>
         std::pair<int, std::string> fromJSON(const parserT& parser) {
-            parser.get<std::string>("id", id);
-            parser.get<std::string>("currency", currency);
-            parser.get<std::string>("profile_id", profile_id);
-            parser.get<double>("balance", balance);
-            parser.get<double>("available", available);
-            parser.get<double>("hold", hold);
-            parser.get<bool>("trading_enabled", trading_enabled);
+            parser.forEach([this](uint64_t field, const auto& value) {
+                switch (field) {
+                case "id"_field: readJson(value, id); break;
+                case "currency"_field: readJson(value, currency); break;
+                case "profile_id"_field: readJson(value, profile_id); break;
+                case "balance"_field: readJson(value, balance); break;
+                case "available"_field: readJson(value, available); break;
+                case "hold"_field: readJson(value, hold); break;
+                case "trading_enabled"_field: readJson(value, trading_enabled); break;
+                }
+            });
             return std::make_pair(0, "OK");
         }
     };
@@ -0,0 +1,86 @@
+#include "stdafx.h"
+#include "gdax/async_orders.h"
+
+#include "request.h"
+#include "logger.h"
+
+namespace gdax {
+
+    AsyncOrderTracker::AsyncOrderTracker(std::function<void()> onAck)
+        : onAck_(std::move(onAck))
+        , worker_([this]() { run(); }) {
+    }
+
+    AsyncOrderTracker::~AsyncOrderTracker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        jobsCv_.notify_all();
+        worker_.join();
+
+        for (auto& job : jobs_) {
+            transport().free(job.request_id);
+        }
+    }
+
+    void AsyncOrderTracker::track(int32_t tradeId, int requestId) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back({ tradeId, requestId });
+            ++pending_;
+        }
+        jobsCv_.notify_all();
+    }
+
+    bool AsyncOrderTracker::wait(uint32_t timeout_ms) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return acksCv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return !acks_.empty(); });
+    }
+
+    size_t AsyncOrderTracker::pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_;
+    }
+
+    void AsyncOrderTracker::run() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                jobsCv_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+                if (stop_) {
+                    return;
+                }
+                job = jobs_.front();
+                jobs_.pop_front();
+            }
+
+            // the requests are in flight together, the ones behind are likely done when they are reached
+            long n;
+            while (!(n = transport().wait(job.request_id, 100))) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop_) {
+                    transport().free(job.request_id);
+                    return;
+                }
+            }
+
+            OrderAck ack;
+            ack.trade_id = job.trade_id;
+            ack.response = receive_response<Order>(job.request_id, n, nullptr, LogLevel::L_TRACE);
+            if (!ack.response) {
+                LOG_ERROR("Order of trade %d failed. err=%s\n", job.trade_id, ack.response.what().c_str());
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                acks_.push_back(std::move(ack));
+            }
+            acksCv_.notify_all();
+            if (onAck_) {
+                onAck_();
+            }
+        }
+    }
+
+} // namespace gdax
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "response.h"
+#include "gdax/order.h"
+
+namespace gdax {
+
+    /**
+     * @brief Response of an order request sent without waiting for it.
+     */
+    struct OrderAck {
+        int32_t trade_id = 0;
+        Response<Order> response;
+    };
+
+    /**
+     * @brief Waits for the responses of order requests on a background thread.
+     *
+     * The Zorro thread sends an order request, hands its request id to track() and returns. The worker
+     * waits for the response, parses it and queues the acknowledgement. The Zorro thread applies the
+     * acknowledgements with drain(), onAck is called by the worker to have it do so soon.
+     *
+     * Only the transport is used by the worker, which must be safe to use from several threads.
+     */
+    class AsyncOrderTracker {
+    public:
+        explicit AsyncOrderTracker(std::function<void()> onAck);
+        ~AsyncOrderTracker();
+
+        AsyncOrderTracker(const AsyncOrderTracker&) = delete;
+        AsyncOrderTracker& operator=(const AsyncOrderTracker&) = delete;
+
+        /**
+         * @brief Wait for the response of the order request of a trade.
+         *
+         * @param requestId id of the request returned by send_request().
+         */
+        void track(int32_t tradeId, int requestId);
+
+        /**
+         * @brief Call f for every acknowledgement received, in order, on the calling thread.
+         *
+         * Reentrant: Zorro may run GET_CALLBACK from the BrokerProgress of a request made by f.
+         *
+         * @return number of acknowledgements.
+         */
+        template<typename F>
+        size_t drain(F&& f) {
+            std::vector<OrderAck> acks;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                acks.swap(acks_);
+                pending_ -= acks.size();
+            }
+            for (auto& ack : acks) {
+                f(ack);
+            }
+            return acks.size();
+        }
+
+        /**
+         * @brief Wait for an acknowledgement, or the timeout.
+         *
+         * @return true if there are acknowledgements to drain.
+         */
+        bool wait(uint32_t timeout_ms);
+
+        /**
+         * @brief Number of requests not acknowledged yet, including the ones waiting to be drained.
+         */
+        size_t pending() const;
+
+    private:
+        struct Job {
+            int32_t trade_id;
+            int request_id;
+        };
+
+        void run();
+
+    private:
+        std::function<void()> onAck_;
+        mutable std::mutex mutex_;
+        // woken up by new jobs and by stop
+        std::condition_variable jobsCv_;
+        // woken up by new acknowledgements
+        std::condition_variable acksCv_;
+        std::deque<Job> jobs_;
+        std::vector<OrderAck> acks_;
+        size_t pending_ = 0;
+        bool stop_ = false;
+        std::thread worker_;
+    };
+
+} // namespace gdax
@@ -1,8 +1,11 @@
 #pragma once
 
-#include <map>
+#include <cstdint>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <string>
-#include <vector>
+#include "rapidjson/reader.h"
 
 namespace gdax {
 	struct Candle {
@@ -14,47 +17,111 @@ namespace gdax {
 		double volume;
 	};
 
-	struct Candles {
-		std::vector<Candle> candles;
+	/**
+	 * @brief SAX handler of the /candles payload [[time, low, high, open, close, volume], ...].
+	 *
+	 * Candles are handed to onCandle while the payload is parsed, no DOM nor candle array is built.
+	 * Candles outside of [start, end] are skipped. Parsing is stopped once onCandle returns false.
+	 * An error object {"message": "..."} is reported through error().
+	 */
+	template<typename F>
+	class CandleHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, CandleHandler<F>> {
+	public:
+		CandleHandler(uint32_t start, uint32_t end, F& onCandle) : start_(start), end_(end), onCandle_(onCandle) {}
 
-	private:
-		template<typename> friend class Response;
-
-		template<typename T>
-		std::pair<int, std::string> fromJSON(const T& parser) {
-			assert(parser.json.IsArray());
-			auto candleArray = parser.json.GetArray();
-			candles.resize(candleArray.Size());
-			for (rapidjson::SizeType i = 0; i < candleArray.Size(); ++i) {
-				auto& item = candleArray[i];
-				if (item.IsArray()) {
-					auto arr = item.GetArray();
-					auto& candle = candles[i];
-					for (rapidjson::SizeType j = 0; j < arr.Size(); ++j) {
-						switch (j) {
-						case 0:
-							candle.time = arr[j].GetUint();
-							break;
-						case 1:
-							candle.low = arr[j].GetDouble();
-							break;
-						case 2:
-							candle.high = arr[j].GetDouble();
-							break;
-						case 3:
-							candle.open = arr[j].GetDouble();
-							break;
-						case 4:
-							candle.close = arr[j].GetDouble();
-							break;
-						case 5:
-							candle.volume = arr[j].GetDouble();
-							break;
-						}
-					}
+		bool stopped() const noexcept { return stopped_; }
+		// number of candles within [start, end]
+		uint32_t count() const noexcept { return count_; }
+		const std::string& error() const noexcept { return error_; }
+
+		bool Null() { return value(NAN); }
+		bool Int(int i) { return value(i); }
+		bool Uint(unsigned i) { return value(i); }
+		bool Int64(int64_t i) { return value((double)i); }
+		bool Uint64(uint64_t i) { return value((double)i); }
+		bool Double(double d) { return value(d); }
+
+		bool String(const char* str, rapidjson::SizeType length, bool) {
+			if (depth_ == 0 && isMessage_) {
+				error_.assign(str, length);
+				return true;
+			}
+			return value(strtod(str, nullptr));
+		}
+
+		bool StartObject() {
+			// only an error object is expected
+			return depth_ == 0;
+		}
+
+		bool Key(const char* str, rapidjson::SizeType length, bool) {
+			isMessage_ = length == 7 && memcmp(str, "message", 7) == 0;
+			return true;
+		}
+
+		bool EndObject(rapidjson::SizeType) {
+			if (error_.empty()) {
+				error_ = "Unexpected candles response";
+			}
+			return true;
+		}
+
+		bool StartArray() {
+			if (++depth_ == 2) {
+				field_ = 0;
+			}
+			return depth_ <= 2;
+		}
+
+		bool EndArray(rapidjson::SizeType) {
+			if (--depth_ == 1 && field_ >= 6 && candle_.time >= start_ && candle_.time <= end_) {
+				++count_;
+				if (!onCandle_(candle_)) {
+					stopped_ = true;
+					return false;
 				}
 			}
-			return std::make_pair(0, "OK");
+			return true;
 		}
+
+	private:
+		bool value(double v) {
+			if (depth_ != 2) {
+				return depth_ == 0;
+			}
+			switch (field_++) {
+			case 0:
+				candle_.time = (uint32_t)v;
+				break;
+			case 1:
+				candle_.low = v;
+				break;
+			case 2:
+				candle_.high = v;
+				break;
+			case 3:
+				candle_.open = v;
+				break;
+			case 4:
+				candle_.close = v;
+				break;
+			case 5:
+				candle_.volume = v;
+				break;
+			}
+			return true;
+		}
+
+	private:
+		uint32_t start_;
+		uint32_t end_;
+		F& onCandle_;
+		Candle candle_;
+		uint32_t depth_ = 0;
+		uint32_t field_ = 0;
+		uint32_t count_ = 0;
+		bool isMessage_ = false;
+		bool stopped_ = false;
+		std::string error_;
 	};
 } // namespace gdax
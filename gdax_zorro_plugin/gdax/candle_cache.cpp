@@ -0,0 +1,219 @@
+#include "stdafx.h"
+#include "gdax/candle_cache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "logger.h"
+
+namespace {
+    constexpr const char* s_cacheDir = "./History/Gdax";
+    constexpr char s_magic[4] = { 'G', 'D', 'X', 'C' };
+    constexpr uint32_t s_version = 1;
+
+    bool writeAll(HANDLE file, const void* data, size_t size) {
+        auto* p = (const char*)data;
+        while (size) {
+            DWORD written = 0;
+            auto n = (DWORD)std::min<size_t>(size, 1 << 30);
+            if (!WriteFile(file, p, n, &written, nullptr) || !written) {
+                return false;
+            }
+            p += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    bool seek(HANDLE file, int64_t offset, DWORD method) {
+        LARGE_INTEGER li;
+        li.QuadPart = offset;
+        return SetFilePointerEx(file, li, nullptr, method) != 0;
+    }
+}
+
+namespace gdax {
+
+    CandleCache::CandleCache(const std::string& product, uint32_t granularity)
+        : path_(std::string(s_cacheDir) + "/" + product + "_" + std::to_string(granularity) + ".bin")
+        , granularity_(granularity)
+    {
+        memset(&header_, 0, sizeof(header_));
+        CreateDirectoryA("./History", nullptr);
+        CreateDirectoryA(s_cacheDir, nullptr);
+        open();
+    }
+
+    CandleCache::~CandleCache() {
+        close();
+    }
+
+    bool CandleCache::open() {
+        auto file = CreateFileA(path_.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            LOG_ERROR("Failed to open candle cache %s. err=%d\n", path_.c_str(), GetLastError());
+            return false;
+        }
+        file_ = file;
+
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+
+        DWORD read = 0;
+        bool valid = size.QuadPart >= (int64_t)sizeof(Header) &&
+            ReadFile(file, &header_, sizeof(Header), &read, nullptr) && read == sizeof(Header) &&
+            memcmp(header_.magic, s_magic, sizeof(s_magic)) == 0 &&
+            header_.version == s_version &&
+            header_.granularity == granularity_ &&
+            header_.record_size == sizeof(CandleRecord) &&
+            (size.QuadPart - sizeof(Header)) % sizeof(CandleRecord) == 0;
+
+        if (!valid) {
+            if (size.QuadPart) {
+                LOG_WARNING("Invalid candle cache %s, reset.\n", path_.c_str());
+            }
+            memset(&header_, 0, sizeof(header_));
+            memcpy(header_.magic, s_magic, sizeof(s_magic));
+            header_.version = s_version;
+            header_.granularity = granularity_;
+            header_.record_size = sizeof(CandleRecord);
+            if (!seek(file, 0, FILE_BEGIN) || !SetEndOfFile(file) || !writeHeader()) {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        count_ = (size_t)((size.QuadPart - sizeof(Header)) / sizeof(CandleRecord));
+        if (!map()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void CandleCache::close() {
+        unmap();
+        if (file_) {
+            CloseHandle((HANDLE)file_);
+            file_ = nullptr;
+        }
+        count_ = 0;
+    }
+
+    bool CandleCache::map() {
+        unmap();
+        if (!count_) {
+            return true;
+        }
+
+        mapping_ = CreateFileMappingA((HANDLE)file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) {
+            LOG_ERROR("Failed to map candle cache %s. err=%d\n", path_.c_str(), GetLastError());
+            return false;
+        }
+
+        view_ = (const char*)MapViewOfFile((HANDLE)mapping_, FILE_MAP_READ, 0, 0, 0);
+        if (!view_) {
+            LOG_ERROR("Failed to map candle cache %s. err=%d\n", path_.c_str(), GetLastError());
+            unmap();
+            return false;
+        }
+        records_ = (const CandleRecord*)(view_ + sizeof(Header));
+        return true;
+    }
+
+    void CandleCache::unmap() {
+        if (view_) {
+            UnmapViewOfFile(view_);
+            view_ = nullptr;
+        }
+        if (mapping_) {
+            CloseHandle((HANDLE)mapping_);
+            mapping_ = nullptr;
+        }
+        records_ = nullptr;
+    }
+
+    bool CandleCache::writeHeader() {
+        if (!seek((HANDLE)file_, 0, FILE_BEGIN) || !writeAll((HANDLE)file_, &header_, sizeof(Header))) {
+            LOG_ERROR("Failed to write candle cache %s. err=%d\n", path_.c_str(), GetLastError());
+            return false;
+        }
+        return true;
+    }
+
+    std::pair<const CandleRecord*, const CandleRecord*> CandleCache::find(uint32_t start, uint32_t end) const noexcept {
+        auto first = std::lower_bound(begin(), this->end(), start, [](const CandleRecord& r, uint32_t t) { return r.time < t; });
+        auto last = std::upper_bound(first, this->end(), end, [](uint32_t t, const CandleRecord& r) { return t < r.time; });
+        return std::make_pair(first, last);
+    }
+
+    bool CandleCache::append(const std::vector<CandleRecord>& records, uint32_t coveredEnd) {
+        if (!file_) {
+            return false;
+        }
+        assert(records.empty() || empty() || records.front().time > header_.covered_end);
+
+        unmap();
+        if (!seek((HANDLE)file_, 0, FILE_END) || !writeAll((HANDLE)file_, records.data(), records.size() * sizeof(CandleRecord))) {
+            LOG_ERROR("Failed to append candle cache %s. err=%d\n", path_.c_str(), GetLastError());
+            close();
+            return false;
+        }
+        count_ += records.size();
+
+        if (empty()) {
+            header_.covered_start = records.empty() ? coveredEnd : records.front().time;
+        }
+        header_.covered_end = coveredEnd;
+        return writeHeader() && map();
+    }
+
+    bool CandleCache::prepend(const std::vector<CandleRecord>& records, uint32_t coveredStart) {
+        if (!file_) {
+            return false;
+        }
+        assert(records.empty() || records.back().time < header_.covered_start);
+
+        header_.covered_start = coveredStart;
+        return rewrite(records.data(), records.size(), records_, count_);
+    }
+
+    bool CandleCache::reset(const std::vector<CandleRecord>& records, uint32_t coveredStart, uint32_t coveredEnd) {
+        if (!file_) {
+            return false;
+        }
+
+        header_.covered_start = coveredStart;
+        header_.covered_end = coveredEnd;
+        return rewrite(records.data(), records.size(), nullptr, 0);
+    }
+
+    bool CandleCache::rewrite(const CandleRecord* head, size_t nHead, const CandleRecord* tail, size_t nTail) {
+        // write a new file next to the cache, then replace the cache with it
+        auto tmpPath = path_ + ".tmp";
+        auto tmp = CreateFileA(tmpPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (tmp == INVALID_HANDLE_VALUE) {
+            LOG_ERROR("Failed to create %s. err=%d\n", tmpPath.c_str(), GetLastError());
+            return false;
+        }
+
+        bool ok = writeAll(tmp, &header_, sizeof(Header)) &&
+            writeAll(tmp, head, nHead * sizeof(CandleRecord)) &&
+            writeAll(tmp, tail, nTail * sizeof(CandleRecord));
+        CloseHandle(tmp);
+
+        // tail may point into the mapping, only close the cache once the new file has been written
+        close();
+        if (!ok || !MoveFileExA(tmpPath.c_str(), path_.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+            LOG_ERROR("Failed to rewrite candle cache %s. err=%d\n", path_.c_str(), GetLastError());
+            DeleteFileA(tmpPath.c_str());
+            open();
+            return false;
+        }
+        return open();
+    }
+
+} // namespace gdax
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace gdax {
+
+    /**
+     * @brief A candle as stored in the candle cache file. Fixed size, no padding.
+     */
+    struct CandleRecord {
+        uint32_t time;  // candle start time
+        float low;
+        float high;
+        float open;
+        float close;
+        float volume;
+    };
+    static_assert(sizeof(CandleRecord) == 24, "CandleRecord must be 24 bytes");
+
+    /**
+     * @brief Persistent on-disk candle store of one product and granularity.
+     *
+     * The file is a 64 bytes header followed by fixed size records sorted by time. The header holds
+     * the covered time range, i.e. candles in the range have been downloaded already, a missing candle
+     * in the range means there was no trade. New candles are appended, older candles are prepended by
+     * rewriting the file. The records are memory mapped, a lookup is a binary search on the mapping.
+     */
+    class CandleCache {
+    public:
+        CandleCache(const std::string& product, uint32_t granularity);
+        ~CandleCache();
+
+        CandleCache(const CandleCache&) = delete;
+        CandleCache& operator=(const CandleCache&) = delete;
+
+        bool isOpen() const noexcept { return file_ != nullptr; }
+        bool empty() const noexcept { return header_.covered_end == 0; }
+
+        uint32_t coveredStart() const noexcept { return header_.covered_start; }
+        uint32_t coveredEnd() const noexcept { return header_.covered_end; }
+
+        const CandleRecord* begin() const noexcept { return records_; }
+        const CandleRecord* end() const noexcept { return records_ + count_; }
+        size_t size() const noexcept { return count_; }
+
+        /**
+         * @brief Returns the records with start time in [start, end], sorted by time.
+         */
+        std::pair<const CandleRecord*, const CandleRecord*> find(uint32_t start, uint32_t end) const noexcept;
+
+        /**
+         * @brief Append records newer than the covered range and extend the covered range to coveredEnd.
+         *
+         * @param records sorted by time.
+         */
+        bool append(const std::vector<CandleRecord>& records, uint32_t coveredEnd);
+
+        /**
+         * @brief Prepend records older than the covered range and extend the covered range to coveredStart.
+         *
+         * @param records sorted by time.
+         */
+        bool prepend(const std::vector<CandleRecord>& records, uint32_t coveredStart);
+
+        /**
+         * @brief Replace the cache content.
+         *
+         * @param records sorted by time.
+         */
+        bool reset(const std::vector<CandleRecord>& records, uint32_t coveredStart, uint32_t coveredEnd);
+
+    private:
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint32_t granularity;
+            uint32_t record_size;
+            uint32_t covered_start;
+            uint32_t covered_end;
+            uint32_t reserved[10];
+        };
+        static_assert(sizeof(Header) == 64, "Header must be 64 bytes");
+
+        bool open();
+        void close();
+        bool map();
+        void unmap();
+        bool writeHeader();
+        bool rewrite(const CandleRecord* head, size_t nHead, const CandleRecord* tail, size_t nTail);
+
+    private:
+        std::string path_;
+        uint32_t granularity_;
+        Header header_;
+        void* file_ = nullptr;
+        void* mapping_ = nullptr;
+        const char* view_ = nullptr;
+        const CandleRecord* records_ = nullptr;
+        size_t count_ = 0;
+    };
+
+} // namespace gdax
@@ -6,6 +6,8 @@
 #include <optional>
 #include <chrono>
 #include <algorithm>
+#include <deque>
+#include <iterator>
 
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
@@ -14,25 +16,6 @@
 #include "cryptopp/cryptlib.h"
 using CryptoPP::Exception;
 
-#include "cryptopp/hmac.h"
-using CryptoPP::HMAC;
-
-#include "cryptopp/sha.h"
-using CryptoPP::SHA256;
-
-#include "cryptopp/base64.h"
-using CryptoPP::Base64Encoder;
-using CryptoPP::Base64Decoder;
-using CryptoPP::byte;
-
-#include "cryptopp/hex.h"
-using CryptoPP::HexEncoder;
-
-#include "cryptopp/filters.h"
-using CryptoPP::StringSink;
-using CryptoPP::StringSource;
-using CryptoPP::HashFilter;
-
 namespace {
     /// The base URL for API calls to the live trading API
     constexpr const char* s_APIBaseURLLive = "https://api.pro.coinbase.com";
@@ -53,34 +36,30 @@ namespace {
         return ((lots / qty_multiplier) + 1e-11) * lots;
     }
 
-    constexpr double epsilon = 1e-9;
-    constexpr uint64_t default_norm_factor = 1e8;
+    /// Max number of candle requests in flight during a history download
+    constexpr size_t s_max_pipelined_requests = 3;
 
-    inline static double fix_floating_error(double value, int32_t norm_factor = default_norm_factor) {
-        auto v = value + epsilon;
-        return ((double)((int64_t)(v * norm_factor)) / norm_factor);
-    }
+    /// Number of empty candle windows in a row after which nothing older is requested, e.g. before a product
+    /// was listed. Coinbase omits the candles without trades, so a single empty window may be a quiet period.
+    constexpr uint32_t s_max_empty_windows = 4;
 
-    inline static uint32_t compute_number_decimals(double value) {
-        value = std::abs(fix_floating_error(value));
-        uint32_t count = 0;
-        while (value - std::floor(value) > epsilon) {
-            ++count;
-            value *= 10;
-        }
-        return count;
+    /// Max number of events kept for orders which are not cached yet
+    constexpr size_t s_max_unmatched_events = 256;
+
+    /// Max number of times the orders matched during a resync are requested
+    constexpr uint32_t s_max_resync_passes = 3;
+
+    /// Wall clock in nanoseconds since epoch, comparable with the feed timestamps
+    int64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     }
+
+    /// Page size of the order sweep, the limit of its request
+    constexpr size_t s_sweep_page_size = 1000;
+
 }
 
 namespace gdax {
-    std::string timeToString(time_t time) {
-        tm* tm;
-        tm = gmtime(&time);
-        char buf[64];
-        strftime(buf, 64, "%Y-%m-%dT%H:%M:%SZ", tm);
-        return buf;
-    }
-
     Client::Client(const std::string& key, const std::string& passphrase, const std::string& secret, bool isPaperTrading, const std::string& stp)
         : baseUrl_(isPaperTrading ? s_APIBaseURLPaper : s_APIBaseURLLive)
         , stp_(stp)
@@ -91,7 +70,7 @@ namespace gdax {
         , isLiveMode_(!isPaperTrading)
     {
         try {
-            StringSource(secret, true, new Base64Decoder(new StringSink(secret_)));
+            signer_.setBase64Key(secret);
         }
         catch (const CryptoPP::Exception& e) {
             BrokerError(("failed to decode API secret. err=" + std::string(e.what())).c_str());
@@ -99,20 +78,21 @@ namespace gdax {
         }
     }
 
-    bool Client::sign(
-        const char* method,
-        const std::string& request_path,
-        std::string& timestamp,
-        std::string& sign,
-        const std::string& body) const {
+    bool Client::sign(RequestBuilder& builder, const char* method, const char* body) const {
         try {
-            timestamp = std::to_string(get_timestamp());
-            std::string msg = timestamp;
-            msg.append(method).append(request_path).append(body);
-            std::string mac;
-            HMAC<SHA256> hmac((unsigned char*)secret_.c_str(), secret_.size());
-            StringSource(msg, true, new HashFilter(hmac, new StringSink(mac)));
-            StringSource(mac, true, new Base64Encoder(new StringSink(sign), false));
+            char timestamp[24];
+            char signature[HmacSigner::s_base64Size + 1];
+            auto n = snprintf(timestamp, sizeof(timestamp), "%llu", (unsigned long long)get_timestamp());
+            HmacSigner::Message msg(signer_);
+            msg.update(timestamp, n).update(method, strlen(method)).update(builder.path(), builder.pathLength());
+            if (body) {
+                msg.update(body, strlen(body));
+            }
+            msg.finalBase64(signature);
+
+            builder.header(constant_headers_)
+                .header("\nCB-ACCESS-SIGN:").header(signature, HmacSigner::s_base64Size)
+                .header("\nCB-ACCESS-TIMESTAMP:").header(timestamp, n);
             return true;
         }
         catch (const CryptoPP::Exception& e) {
@@ -121,18 +101,30 @@ namespace gdax {
         return false;
     }
 
-    std::string Client::headers(const std::string& sign, const std::string& timestamp) const {
-        std::stringstream ss;
-        ss << constant_headers_ << "\nCB-ACCESS-SIGN:" << sign << "\nCB-ACCESS-TIMESTAMP:" << timestamp;
-        //logger_.logDebug("%s\n", ss.str().c_str());
-        return ss.str();
+    RequestBuilder& Client::publicRequest(const char* path) const {
+        return RequestBuilder::get().reset(Lane::Public).url(baseUrl_).path(path).header(public_api_headers_);
+    }
+
+    RequestBuilder& Client::privateRequest(const char* path) const {
+        return RequestBuilder::get().reset(Lane::Private).url(baseUrl_).path(path);
+    }
+
+    RequestBuilder& Client::orderRequest(const Uuid& id) const {
+        char buf[Uuid::s_length + 1];
+        return privateRequest("/orders/").path(buf, id.format(buf));
+    }
+
+    void Client::warmUp() {
+        // one public request opens a connection which is kept alive afterwards, the products are needed anyway.
+        // The pipelined requests of a history download open the other connections.
+        getProducts();
+        LOG_DEBUG("public connection warmed up, %d products\n", (int)products_.size());
     }
 
     Response<std::vector<Account>> Client::getAccounts() const {
-        std::string timestamp;
-        std::string signature;
-        if (sign("GET", "/accounts", timestamp, signature)) {
-            return request<std::vector<Account>>(baseUrl_ + "/accounts", headers(signature, timestamp).c_str());
+        auto& builder = privateRequest("/accounts");
+        if (sign(builder, "GET")) {
+            return request<std::vector<Account>>(builder);
         }
         return Response<std::vector<Account>>(1, "Failed to sign /accounts request");
     }
@@ -141,13 +133,13 @@ namespace gdax {
         if (!products_.empty()) {
             return products_;
         }
-        auto response =  request<std::vector<Product>>(baseUrl_ + "/products", public_api_headers_.c_str());
+        auto response =  request<std::vector<Product>>(publicRequest("/products"), nullptr, nullptr, LogLevel::L_TRACE2, P_BULK);
         if (!response) {
             BrokerError(("Failed to get products. err=" + response.what()).c_str());
         }
         else {
             for (auto& prod : response.content()) {
-                products_.insert(std::make_pair(prod.id, prod));
+                products_.insert(std::make_pair(prod.id.str(), prod));
             }
         }
         return products_;
@@ -163,119 +155,182 @@ namespace gdax {
     }
 
     Response<Ticker> Client::getTicker(const std::string& id) const {
-        return request<Ticker>(baseUrl_ + "/products/" + id + "/ticker", public_api_headers_.c_str());
+        auto& builder = publicRequest("/products/").path(id.c_str(), id.size()).path("/ticker");
+        return request<Ticker>(builder, nullptr, nullptr, LogLevel::L_TRACE2, P_BULK);
     }
 
     Response<Time> Client::getTime() const {
-        return request<Time>(baseUrl_ + "/time", public_api_headers_.c_str());
+        return request<Time>(publicRequest("/time"));
     }
 
-    Response<Candles> Client::getCandles(const std::string& AssetId, uint32_t start, uint32_t end, uint32_t granularity, uint32_t nCandles) const {
-        static std::vector<uint32_t> s_valid_granularity = { 60, 300, 900, 3600, 21600, 86400 };
-        auto iter = std::find(s_valid_granularity.begin(), s_valid_granularity.end(), granularity);
-
-        uint32_t supported_granularity = granularity;
-        uint32_t n = 1;
-
-        if (iter == s_valid_granularity.end()) {
-            // not a supported granularity;
-            assert(false);
-            bool find = false;
-            for (auto it = s_valid_granularity.rbegin(); it != s_valid_granularity.rend(); ++it) {
-                if ((granularity % (*it)) == 0) {
-                    supported_granularity = *it;
-                    n = (uint32_t)(granularity / supported_granularity);
-                    LOG_DEBUG("Grenularity %n is not supported by Coinbase Pro, use %d instead.", granularity, supported_granularity);
-                    find = true;
-                    break;
-                }
-            }
+    Response<uint32_t> Client::getCandles(const std::string& AssetId, uint32_t start, uint32_t end, uint32_t granularity, uint32_t nCandles, const std::function<bool(const Candle&)>& onCandle) const {
+        static const uint32_t s_valid_granularity[] = { 60, 300, 900, 3600, 21600, 86400 };
 
-            if (!find) {
-                return Response<Candles>(1, "Granularity " + std::to_string(granularity) + " is not supported");
+        uint32_t supported_granularity = 0;
+        for (auto it = std::rbegin(s_valid_granularity); it != std::rend(s_valid_granularity); ++it) {
+            if ((granularity % (*it)) == 0) {
+                supported_granularity = *it;
+                break;
             }
         }
 
-        uint32_t s;
-        uint32_t e = end;
-        nCandles *= n;
-
-        auto download_candles = [this, &s, e, supported_granularity, AssetId, start]() {
-            // make sure only 300 candles requests
-            s = e - 300 * supported_granularity;
-            if (s < start) {
-                s = start;
-            }
+        if (!supported_granularity) {
+            return Response<uint32_t>(1, "Granularity " + std::to_string(granularity) + " is not supported");
+        }
 
-            std::stringstream ss;
-            ss << baseUrl_ << "/products/" << AssetId << "/candles?start=" << timeToString(time_t(s)) << "&end=" << timeToString(time_t(e)) << "&granularity=" << supported_granularity;
+        if (supported_granularity != granularity) {
+            LOG_DEBUG("Granularity %d is not supported by Coinbase Pro, use %d instead.\n", granularity, supported_granularity);
+        }
 
-            return request<Candles>(ss.str(), public_api_headers_.c_str(), nullptr, nullptr, LogLevel::L_TRACE);
+        // precompute [start, end] of all windows, newest first. Each window has at most 300 candles.
+        struct Window {
+            uint32_t start;
+            uint32_t end;
         };
+        std::vector<Window> windows;
+        const uint32_t span = 299 * supported_granularity;
+        for (uint32_t e = end; e >= start;) {
+            uint32_t s = (e - start > span) ? e - span : start;
+            windows.push_back({ s, e });
+            if (s == start) {
+                break;
+            }
+            e = s - 1;
+        }
 
-        if (n == 1) {
-            auto rsp = download_candles();
-            if (!rsp) {
-                return rsp;
+        Response<uint32_t> rt;
+        rt.content() = 0;
+        uint32_t& delivered = rt.content();
+
+        // aggregate candles into granularity buckets when granularity is not supported natively
+        const uint32_t n = granularity / supported_granularity;
+        Candle aggregated;
+        bool hasAggregated = false;
+        auto emit = [&](const Candle& candle) {
+            if (n == 1) {
+                ++delivered;
+                return onCandle(candle) && delivered < nCandles;
             }
 
-            auto& downloadedCandles = rsp.content().candles;
-            for (auto it = downloadedCandles.begin(); it != downloadedCandles.end();) {
-                if (it->time > e || it->time < s) {
-                    it = downloadedCandles.erase(it);
-                }
-                else {
-                    ++it;
+            // candles arrive newest first
+            uint32_t bucket = candle.time - candle.time % granularity;
+            if (hasAggregated && aggregated.time != bucket) {
+                hasAggregated = false;
+                ++delivered;
+                if (!onCandle(aggregated) || delivered >= nCandles) {
+                    return false;
                 }
             }
-            return rsp;
-        }
 
-        Response<Candles> rt;
-        auto& candles = rt.content().candles;
-        candles.reserve(nCandles);
-        uint32_t i = 0;
-        Candle c;
+            if (!hasAggregated) {
+                aggregated = candle;
+                aggregated.time = bucket;
+                hasAggregated = true;
+            }
+            else {
+                aggregated.high = std::max<double>(candle.high, aggregated.high);
+                aggregated.low = std::min<double>(candle.low, aggregated.low);
+                aggregated.open = candle.open;
+                aggregated.volume += candle.volume;
+            }
+            return true;
+        };
 
-        do {
-            auto rsp = download_candles();
-            if (!rsp) {
-                BrokerError(rsp.what().c_str());
-                break;
+        auto candlesRequest = [&](const Window& window) -> RequestBuilder& {
+            char startTime[32];
+            char endTime[32];
+            formatTimestamp(window.start * s_nanosPerSecond, startTime, 0);
+            formatTimestamp(window.end * s_nanosPerSecond, endTime, 0);
+            char query[128];
+            snprintf(query, sizeof(query), "/candles?start=%s&end=%s&granularity=%u", startTime, endTime, supported_granularity);
+            return publicRequest("/products/").path(AssetId.c_str(), AssetId.size()).path(query);
+        };
+
+        struct Pending {
+            int id;
+            size_t window;
+        };
+        std::deque<Pending> inflight;
+
+        auto cancel = [&inflight]() {
+            for (auto& pending : inflight) {
+                transport().free(pending.id);
             }
-            auto& downloadedCandles = rsp.content().candles;
-            for (size_t i = 0; i < downloadedCandles.size(); ++i) {
-                auto& candle = downloadedCandles[i];
-                e = candle.time;
-                if (candle.time > e) {
-                    continue;
+            inflight.clear();
+        };
+
+        size_t next = 0;
+        uint32_t emptyWindows = 0;
+        bool done = false;
+        while (!done && (next < windows.size() || !inflight.empty())) {
+            // keep the pipeline full as long as the throttler allows
+            while (next < windows.size() && inflight.size() < s_max_pipelined_requests) {
+                std::string err;
+                auto& builder = candlesRequest(windows[next]);
+                int id = builder.ok() ? send_request(builder.lane(), builder.url(), builder.headers(), nullptr, P_BULK, err, inflight.empty()) : 0;
+                if (!builder.ok()) {
+                    err = "Request too long";
                 }
-                if (candle.time < s) {
+                if (!id) {
+                    if (!err.empty()) {
+                        cancel();
+                        rt.onError(1, err);
+                        return rt;
+                    }
+                    // throttled, try again once the head request completed
                     break;
                 }
+                inflight.push_back({ id, next++ });
+            }
 
-                if (i == 0) {
-                    c = candle;
-                }
-                else {
-                    c.high = std::max<double>(candle.high, c.high);
-                    c.low = std::min<double>(candle.low, c.low);
-                    c.close = candle.close;
-                    c.volume += candle.volume;
+            // windows are merged in order, always wait for the oldest request
+            auto head = inflight.front();
+            long status = transport().wait(head.id, 10);
+            if (!status) {
+                if (!BrokerProgress(1)) {
+                    cancel();
+                    rt.onError(1, "Brokerprogress returned zero. Aborting...");
+                    return rt;
                 }
+                continue;
+            }
+            inflight.pop_front();
 
-                if (++i == n) {
-                    candles.emplace_back(std::move(c));
-                    i = 0;
-                    --nCandles;
-                }
+            auto body = receive_content(head.id, status, LogLevel::L_TRACE);
+            if (!body) {
+                cancel();
+                rt.onError(body.getCode(), body.what());
+                return rt;
+            }
 
-                if (!nCandles) {
-                    return rt;
-                }
+            // stream the candles of the window straight into emit
+            auto& window = windows[head.window];
+            CandleHandler<decltype(emit)> handler(window.start, window.end, emit);
+            rapidjson::Reader reader;
+            rapidjson::InsituStringStream ss(body.content());
+            auto result = reader.Parse<rapidjson::kParseInsituFlag>(ss, handler);
+            if (handler.stopped()) {
+                done = true;
+            }
+            else if (result.IsError() || !handler.error().empty()) {
+                cancel();
+                rt.onError(1, handler.error().empty() ? "Failed to parse candles. err=" + std::to_string(result.Code()) : handler.error());
+                return rt;
+            }
+            else if (handler.count()) {
+                emptyWindows = 0;
             }
-            e -= 30;
-        } while (nCandles > 0 && s > start);
+            else if (++emptyWindows >= s_max_empty_windows) {
+                LOG_DEBUG("%u empty candle windows in a row, nothing older is requested\n", emptyWindows);
+                done = true;
+            }
+        }
+        cancel();
+
+        if (hasAggregated && delivered < nCandles) {
+            onCandle(aggregated);
+            ++delivered;
+        }
         return rt;
     }
 
@@ -286,154 +341,299 @@ namespace gdax {
     //}
 
     Response<std::vector<Order>> Client::getOrders() const {
-        std::string timestamp;
-        std::string signature;
-        if (sign("GET", "/orders?status=all", timestamp, signature)) {
-            return request<std::vector<Order>>(baseUrl_ + "/orders?status=all", headers(signature, timestamp).c_str());
+        auto& builder = privateRequest("/orders?status=all");
+        if (sign(builder, "GET")) {
+            return request<std::vector<Order>>(builder);
         }
         return Response<std::vector<Order>>(1, "Failed to sign /orders request");
     }
 
     Response<Order*> Client::getOrder(const std::string& order_id) {
+        Uuid id;
+        if (!Uuid::parse(order_id.c_str(), order_id.size(), id)) {
+            return Response<Order*>(1, "Invalid order id " + order_id);
+        }
+        return getOrder(id);
+    }
+
+    Response<Order*> Client::getOrder(const Uuid& id) {
+        if (orderEventsLive()) {
+            applyOrderEvents();
+        }
+
+        auto* order = orders_.find(id);
+        if (order) {
+            return refreshOrder(order);
+        }
+
         Response<Order*> rt;
         rt.content() = nullptr;
+        auto& builder = orderRequest(id);
+        if (sign(builder, "GET")) {
+            auto response = request<Order>(builder, nullptr, nullptr, LogLevel::L_TRACE);
+            if (response) {
+                rt.content() = orders_.insert(response.content());
+            }
+            else {
+                rt.onError(response.getCode(), response.what());
+            }
+            return rt;
+        }
+        return Response<Order*>(1, "Failed to sign " + std::string(builder.path()) + " request");
+    }
 
-        auto ord_it = orders_.find(order_id);
-        if (ord_it != orders_.end()) {
-            rt.content() = &ord_it->second;
-            if (rt.content()->status == "done" ||
-                rt.content()->status == "canceled") {
-                return rt;
+    Response<Order*> Client::refreshOrder(Order* order, bool sweep) {
+        bool live = orderEventsLive(*order);
+        if (live) {
+            applyOrderEvents();
+        }
+        Response<Order*> rt;
+        rt.content() = order;
+        if (live || order->status == OrderStatus::Done || order->status == OrderStatus::Canceled) {
+            // kept up to date by the order events, or final
+            return rt;
+        }
+
+        if (!sweep || sweepInterval_.count() == 0) {
+            return getOrder(order);
+        }
+        if (std::chrono::steady_clock::now() - lastSweep_ >= sweepInterval_) {
+            auto response = sweepOrders();
+            if (!response) {
+                rt.onError(response.getCode(), response.what());
             }
         }
+        return rt;
+    }
 
-        std::string path = "/orders/";
-        if (rt.content()) {
-            path.append(rt.content()->id);
+    Response<size_t> Client::sweepOrders() {
+        // without a status the open, pending and active orders are returned. The response is paginated, its cursor
+        // is in a response header the transports do not return: ask for the largest page, the working orders
+        // beyond it are requested on their own below.
+        auto& builder = privateRequest("/orders?limit=1000");
+        if (!sign(builder, "GET")) {
+            return Response<size_t>(1, "Failed to sign /orders request");
         }
-        else {
-            path.append(order_id);
+        auto response = request<std::vector<Order>>(builder, nullptr, nullptr, LogLevel::L_TRACE, P_STATUS);
+        if (!response) {
+            return Response<size_t>(response.getCode(), response.what());
         }
+        lastSweep_ = std::chrono::steady_clock::now();
 
-        std::string timestamp;
-        std::string signature;
-        if (sign("GET", path, timestamp, signature)) {
-            auto response = request<Order>(baseUrl_ + path, headers(signature, timestamp).c_str(), nullptr, rt.content(), LogLevel::L_TRACE);
-            if (response && !rt.content()) {
-                auto it = orders_.emplace(order_id, std::move(response.content())).first;
-                rt.content() = &it->second;
+        std::vector<Order*> working;
+        orders_.forEach([&working](Order& order) {
+            auto status = order.status;
+            if (status != OrderStatus::Done && status != OrderStatus::Canceled && status != OrderStatus::Rejected) {
+                working.push_back(&order);
+            }
+        });
+
+        std::vector<Order*> open;
+        open.reserve(response.content().size());
+        for (auto& order : response.content()) {
+            auto* cached = orders_.find(order.id);
+            if (cached) {
+                cached->update(order);
+                open.push_back(cached);
+            }
+        }
+
+        if (response.content().size() >= s_sweep_page_size) {
+            LOG_WARNING("Order sweep returned a full page, working orders beyond it are requested one by one\n");
+        }
+
+        // the working orders which are not open anymore, or beyond the page
+        std::sort(open.begin(), open.end());
+        for (auto* order : working) {
+            if (!std::binary_search(open.begin(), open.end(), order)) {
+                getOrder(order);
             }
-            return rt;
         }
-        return Response<Order*>(1, "Failed to sign " + path + " request");
+        LOG_DEBUG("order sweep: %d open, %d working\n", (int)response.content().size(), (int)working.size());
+        return Response<size_t>(0, "OK", response.content().size());
     }
 
     Response<Order*> Client::getOrder(Order* order) {
-        std::string path = "/orders/" + order->id;
-        std::string timestamp;
-        std::string signature;
+        auto& builder = orderRequest(order->id);
         Response<Order*> rt;
         rt.content() = order;
-        if (sign("GET", path, timestamp, signature)) {
-            auto response = request<Order>(baseUrl_ + path, headers(signature, timestamp).c_str(), nullptr, order, LogLevel::L_TRACE);
+        if (sign(builder, "GET")) {
+            auto response = request<Order>(builder, nullptr, order, LogLevel::L_TRACE);
             if (!response) {
                 rt.onError(response.getCode(), response.what());
             }
             return rt;
         }
-        rt.onError(1, "Failed to sign " + path + " request");
+        rt.onError(1, "Failed to sign " + std::string(builder.path()) + " request");
         return rt;
     }
 
-    Response<Order*> Client::submitOrder(
-        const Product* const product,
-        double lots,
-        OrderSide side,
-        OrderType type,
-        TimeInForce tif,
-        double limit_price,
-        double stop_price,
-        bool post_only) {
-
-        Response<Order*> response;
-        response.content() = nullptr;
-        
-        rapidjson::StringBuffer s;
-        s.Clear();
-        rapidjson::Writer<rapidjson::StringBuffer> writer(s);
-        writer.StartObject();
-
-        writer.Key("product_id");
-        writer.String(product->id.c_str());
-
-        writer.Key("side");
-        writer.String(to_string(side));
-
-        writer.Key("type");
-        writer.String(to_string(type));
+    Response<Order*> Client::waitOrder(Order* order, const std::function<bool(const Order&)>& done, uint32_t timeout_ms) {
+        Response<Order*> rt;
+        rt.content() = order;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (true) {
+            bool live = orderEventsLive(*order);
+            if (live) {
+                applyOrderEvents();
+            }
+            else {
+                rt = getOrder(order);
+                if (!rt) {
+                    return rt;
+                }
+            }
 
-        if (!stp_.empty()) {
-            writer.Key("stp");
-            writer.String(stp_.c_str());
+            if (done(*order)) {
+                return rt;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                rt.onError(-2, "Order response timedout");
+                return rt;
+            }
+            if (!BrokerProgress(1)) {
+                rt.onError(1, "Brokerprogress returned zero. Aborting...");
+                return rt;
+            }
+            if (live) {
+                orderEvents_->wait(100);
+            }
         }
+    }
 
-        if (type == OrderType::Limit) {
-            writer.Key("time_in_force");
-            writer.String(to_string(tif));
+    void Client::applyOrderEvents() {
+        auto generation = orderEvents_->generation();
+        // the events queued before the resync are in its snapshots, applying them first records their trade ids
+        orderEvents_->drain([this](const OrderEvent& event) { onOrderEvent(event); });
+        if (generation != orderEventsGeneration_) {
+            // events may have been missed, resync the working orders once
+            orderEventsGeneration_ = generation;
+            resyncOrders();
+        }
+    }
 
-            std::ostringstream price;
-            price.precision(compute_number_decimals(product->quote_increment));
-            if (side == OrderSide::Buy) {
-                price << std::fixed << (limit_price - 0.5 * product->quote_increment);
+    void Client::resyncOrders() {
+        struct Snapshot {
+            Order* order;
+            int64_t sent;   // local time the request was sent
+        };
+        auto fetch = [this](Order* order) {
+            Snapshot snapshot{ order, nowNanos() };
+            if (getOrder(order)) {
+                // matches up to the response are in the snapshot, applyOrderEvent() skips them
+                order->synced_at = nowNanos();
             }
-            else {
-                price << std::fixed << (limit_price + 0.5 * product->quote_increment);
+            return snapshot;
+        };
+
+        std::vector<Snapshot> snapshots;
+        orders_.forEach([&snapshots, &fetch](Order& order) {
+            auto status = order.status;
+            if (status != OrderStatus::Done && status != OrderStatus::Canceled && status != OrderStatus::Rejected) {
+                snapshots.push_back(fetch(&order));
             }
+        });
+
+        for (uint32_t pass = 1; !snapshots.empty(); ++pass) {
+            // a match between the request and the response of a snapshot may not be in it, request the order again
+            std::vector<Order*> ambiguous;
+            orderEvents_->drain([this, &snapshots, &ambiguous](const OrderEvent& event) {
+                if (event.type == FeedType::Match) {
+                    for (auto& snapshot : snapshots) {
+                        auto* order = snapshot.order;
+                        if ((order->id == event.order_id || order->id == event.taker_order_id) && event.time > snapshot.sent && event.time <= order->synced_at &&
+                            std::find(ambiguous.begin(), ambiguous.end(), order) == ambiguous.end()) {
+                            ambiguous.push_back(order);
+                        }
+                    }
+                }
+                onOrderEvent(event);
+            });
 
-            writer.Key("price");
-            writer.String(price.str().c_str());
+            snapshots.clear();
+            if (pass == s_max_resync_passes) {
+                if (!ambiguous.empty()) {
+                    LOG_WARNING("%d orders kept matching during the resync, their fills may be behind until the next update\n", (int)ambiguous.size());
+                }
+                break;
+            }
+            for (auto* order : ambiguous) {
+                snapshots.push_back(fetch(order));
+            }
+        }
+    }
 
-            if (stop_price) {
-                writer.Key("stop_price");
-                writer.String(std::to_string(stop_price).c_str());
-                writer.Key("stop");
-                writer.String("loss");
+    void Client::onOrderEvent(const OrderEvent& event) {
+        bool found = false;
+        auto* order = orders_.find(event.order_id);
+        if (order) {
+            gdax::applyOrderEvent(*order, event);
+            found = true;
+        }
+        if (event.type == FeedType::Match) {
+            order = orders_.find(event.taker_order_id);
+            if (order) {
+                gdax::applyOrderEvent(*order, event);
+                found = true;
             }
+        }
 
-            if (tif != TimeInForce::FOK && tif != TimeInForce::IOC) {
-                writer.Key("post_only");
-                writer.Bool(post_only);
+        if (!found) {
+            if (unmatchedEvents_.size() == s_max_unmatched_events) {
+                unmatchedEvents_.pop_front();
             }
+            unmatchedEvents_.push_back(event);
         }
+    }
 
-        std::ostringstream qty;
-        qty.precision(compute_number_decimals(product->base_increment));
-        qty << std::fixed << lots;
+    const char* Client::buildOrder(const Product* product, double lots, OrderSide side, OrderType type, TimeInForce tif, double limit_price, double stop_price, bool post_only) {
+        auto it = orderTemplates_.find(product);
+        if (it == orderTemplates_.end()) {
+            it = orderTemplates_.emplace(product, OrderTemplate(*product, stp_)).first;
+        }
+        size_t length;
+        return it->second.build(side, type, tif, lots, limit_price, stop_price, post_only, length);
+    }
 
-        writer.Key("size");
-        writer.String(qty.str().c_str());
+    Order* Client::addOrder(const Order& order) {
+        auto& cached = *orders_.insert(order);
 
-        writer.EndObject();
-        auto data = s.GetString();
+        // events which arrived before the response
+        for (auto event = unmatchedEvents_.begin(); event != unmatchedEvents_.end();) {
+            if (cached.id == event->order_id || (event->type == FeedType::Match && cached.id == event->taker_order_id)) {
+                gdax::applyOrderEvent(cached, *event);
+                event = unmatchedEvents_.erase(event);
+            }
+            else {
+                ++event;
+            }
+        }
+        return &cached;
+    }
+
+    Response<Order*> Client::submitOrder(
+        const Product* const product,
+        double lots,
+        OrderSide side,
+        OrderType type,
+        TimeInForce tif,
+        double limit_price,
+        double stop_price,
+        bool post_only) {
 
-        auto start = std::time(nullptr);
-        std::string timestamp;
-        std::string signature;
-        if (sign("POST", "/orders", timestamp, signature, data)) {
-            auto rsp = request<Order>(baseUrl_ + "/orders", headers(signature, timestamp).c_str(), data, nullptr, LogLevel::L_TRACE);
+        Response<Order*> response;
+        response.content() = nullptr;
+        
+        auto data = buildOrder(product, lots, side, type, tif, limit_price, stop_price, post_only);
+        auto& builder = privateRequest("/orders");
+        if (sign(builder, "POST", data)) {
+            auto rsp = request<Order>(builder, data, nullptr, LogLevel::L_TRACE, P_TRADING);
             if (rsp) {
-                Order& order = rsp.content();
-                auto iter = orders_.insert(std::make_pair(order.id, order)).first;
-                response.content() = &iter->second;
-                while (iter->second.status == "pending") {
-                    response = getOrder(response.content());
-                    if (!response) {
-                        break;
-                    }
-                    if (std::difftime(std::time(nullptr), start) >= 30) {
-                        response.onError(-2, "Order response timedout");
-                        return response;
-                    }
+                auto& cached = *addOrder(rsp.content());
+                response.content() = &cached;
+
+                if (cached.status == OrderStatus::Pending) {
+                    response = waitOrder(&cached, [](const Order& o) { return o.status != OrderStatus::Pending; }, 30000);
                 }
             }
             else {
@@ -446,15 +646,40 @@ namespace gdax {
         return response;
     }
 
+    Response<int> Client::sendOrder(
+        const Product* const product,
+        double lots,
+        OrderSide side,
+        OrderType type,
+        TimeInForce tif,
+        double limit_price,
+        double stop_price,
+        bool post_only) {
+
+        auto data = buildOrder(product, lots, side, type, tif, limit_price, stop_price, post_only);
+        auto& builder = privateRequest("/orders");
+        if (!sign(builder, "POST", data)) {
+            return Response<int>(1, "Failed to sign order request");
+        }
+        if (!builder.ok()) {
+            return Response<int>(1, "Request too long");
+        }
+
+        std::string err;
+        int id = send_request(builder.lane(), builder.url(), builder.headers(), data, P_TRADING, err);
+        if (!id) {
+            return Response<int>(1, err);
+        }
+        return Response<int>(0, "OK", id);
+    }
+
     Response<bool> Client::cancelOrder(Order& order) {
-        LOG_DEBUG("--> DELETE %s/orders/%s\n", baseUrl_.c_str(), order.id.c_str());
-        auto path = "/orders/" + order.id;
-        std::string timestamp;
-        std::string signature;
-        if (sign("DELETE", path, timestamp, signature)) {
-            auto response = request<std::string>(baseUrl_ + path, headers(signature, timestamp).c_str(), "#DELETE", nullptr, LogLevel::L_TRACE);
+        auto& builder = orderRequest(order.id);
+        LOG_DEBUG("--> DELETE %s\n", builder.url());
+        if (sign(builder, "DELETE")) {
+            auto response = request<std::string>(builder, "#DELETE", nullptr, LogLevel::L_TRACE, P_TRADING);
             if (response) {
-                order.status = "canceled";
+                order.status = OrderStatus::Canceled;
                 return Response<bool>(0, "OK", true);
             }
             return Response<bool>(1, response.what(), false);
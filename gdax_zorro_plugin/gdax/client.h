@@ -3,6 +3,9 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <functional>
+#include <deque>
+#include <chrono>
 
 #include "request.h"
 #include "gdax/account.h"
@@ -12,12 +15,15 @@
 #include "gdax/ticker.h"
 #include "gdax/fill.h"
 #include "gdax/time.h"
+#include "gdax/order_template.h"
+#include "gdax/signer.h"
+#include "gdax/order_events.h"
+#include "gdax/order_cache.h"
 
 namespace gdax {
 
     class MarketData;
 
-    std::string timeToString(time_t time);
 
     class Client final {
     public:
@@ -27,6 +33,12 @@ namespace gdax {
 
         bool isLiveMode() const noexcept { return isLiveMode_;  }
 
+        /**
+         * @brief Open a public keep-alive connection ahead of time with the products request. Only one request
+         * is sent, so the rate limit tokens are left to the strategy.
+         */
+        void warmUp();
+
         Response<std::vector<Account>> getAccounts() const;
 
         const std::unordered_map<std::string, Product>& getProducts();
@@ -36,12 +48,77 @@ namespace gdax {
 
         Response<Time> getTime() const;
 
-        Response<Candles> getCandles(const std::string& AssetId, uint32_t start, uint32_t end, uint32_t granulairty, uint32_t nCandles) const;
+        /**
+         * @brief Download candles in [start, end], newest first.
+         *
+         * All 300-candle windows are precomputed and several of them are requested at a time.
+         * onCandle is called for each candle in order, returns false to stop the download.
+         *
+         * @return number of candles delivered to onCandle.
+         */
+        Response<uint32_t> getCandles(const std::string& AssetId, uint32_t start, uint32_t end, uint32_t granularity, uint32_t nCandles, const std::function<bool(const Candle&)>& onCandle) const;
         //Response<std::vector<Trade>> getTrades(const std::string& AssetId) const;
             
         Response<std::vector<Order>> getOrders() const;
 
         Response<Order*> getOrder(const std::string& order_id);
+        Response<Order*> getOrder(const Uuid& order_id);
+
+        /**
+         * @brief Bring a cached order up to date.
+         *
+         * From the order events while they are live. Otherwise from the last order sweep if it is younger
+         * than the sweep interval, a new sweep if not, or a request of its own if sweeping is disabled.
+         *
+         * @param sweep false to always request the order on its own while the events are not live.
+         */
+        Response<Order*> refreshOrder(Order* order, bool sweep = true);
+
+        /**
+         * @brief Refresh all cached working orders with one GET /orders request.
+         *
+         * A working order missing from the open orders has finished since, and is requested once more for
+         * its final state.
+         *
+         * @return number of open orders.
+         */
+        Response<size_t> sweepOrders();
+
+        /**
+         * @brief How long a sweep answers refreshOrder(), 0 to request every order on its own.
+         */
+        void setSweepInterval(uint32_t ms) noexcept { sweepInterval_ = std::chrono::milliseconds(ms); }
+
+        /**
+         * @brief The cached order, nullptr if it is not cached.
+         */
+        Order* findOrder(const Uuid& id) noexcept { return orders_.find(id); }
+
+        /**
+         * @brief Keep the order of an open trade in the cache until it is released.
+         */
+        bool retainOrder(const Uuid& id) noexcept { return orders_.retain(id); }
+        void releaseOrder(const Uuid& id) noexcept { orders_.release(id); }
+
+        /**
+         * @brief Archive the orders which are done and no longer retained. Invalidates their Order pointers.
+         */
+        void trimOrders() { orders_.trim(); }
+
+        /**
+         * @brief Wait until done(order) holds.
+         *
+         * While the websocket user channel is live the order is updated from its events and the wait is
+         * woken up by them. Otherwise the order is polled over REST.
+         *
+         * @return error -2 on timeout.
+         */
+        Response<Order*> waitOrder(Order* order, const std::function<bool(const Order&)>& done, uint32_t timeout_ms);
+
+        /**
+         * @brief Source of the order events, owned by the websocket. nullptr to poll orders over REST only.
+         */
+        void setOrderEvents(OrderEventQueue* events) noexcept { orderEvents_ = events; }
 
         Response<Order*> submitOrder(
             const Product* const product,
@@ -53,25 +130,68 @@ namespace gdax {
             double stop_price = 0.0,
             bool post_only = false);
 
+        /**
+         * @brief Send an order request without waiting for the response.
+         *
+         * @return id of the request, see send_request(). The response is an Order, to be passed to addOrder().
+         */
+        Response<int> sendOrder(
+            const Product* const product,
+            double lots,
+            OrderSide side,
+            OrderType type,
+            TimeInForce tif,
+            double limit_price = 0.0,
+            double stop_price = 0.0,
+            bool post_only = false);
+
+        /**
+         * @brief Cache an order returned by an order request, with the events which arrived before it.
+         */
+        Order* addOrder(const Order& order);
+
         Response<bool> cancelOrder(Order& order);
 
         const char* getOrderUUID(int32_t client_oid);
         void onPositionClosed(int32_t client_oid);
 
     private:
-        bool sign(
-            const char* method,
-            const std::string& request_path,
-            std::string& timestamp,
-            std::string& sign,
-            const std::string& body = "") const;
-        std::string headers(const std::string& sign, const std::string& timestamp) const;
+        /**
+         * @brief Start a request in the builder of the calling thread.
+         */
+        RequestBuilder& publicRequest(const char* path) const;
+        RequestBuilder& privateRequest(const char* path) const;
+        RequestBuilder& orderRequest(const Uuid& id) const;
+
+        /**
+         * @brief Sign the path of the request and append the authentication headers.
+         */
+        bool sign(RequestBuilder& builder, const char* method, const char* body = nullptr) const;
 
         Response<Order*> getOrder(Order*);
 
+        /**
+         * @return the body of an order request, valid until the next order of the product is built.
+         */
+        const char* buildOrder(const Product* product, double lots, OrderSide side, OrderType type, TimeInForce tif, double limit_price, double stop_price, bool post_only);
+
+        bool orderEventsLive() const { return orderEvents_ && orderEvents_->live(); }
+        bool orderEventsLive(const Order& order) const { return orderEvents_ && orderEvents_->live(order.product_id); }
+
+        /**
+         * @brief Bring the cached orders up to date with the queued order events.
+         */
+        void applyOrderEvents();
+        /**
+         * @brief Request the working orders after events may have been missed. The queued matches are checked
+         * against the time of the snapshots, so no fill is counted twice.
+         */
+        void resyncOrders();
+        void onOrderEvent(const OrderEvent& event);
+
     private:
         const std::string baseUrl_;
-        std::string secret_;
+        HmacSigner signer_;
         std::string stp_;
         const std::string constant_headers_;
         const std::string public_api_headers_;
@@ -79,7 +199,15 @@ namespace gdax {
         const bool isLiveMode_;
 
         std::unordered_map<std::string, Product> products_;
-        std::unordered_map<std::string, Order> orders_;
+        OrderCache orders_;
+        OrderEventQueue* orderEvents_ = nullptr;
+        uint32_t orderEventsGeneration_ = 0;
+        std::chrono::milliseconds sweepInterval_{ 1000 };
+        std::chrono::steady_clock::time_point lastSweep_;
+        // events of orders not cached yet, e.g. received before the response of the order request
+        std::deque<OrderEvent> unmatchedEvents_;
+        // order bodies of the products traded so far
+        std::unordered_map<const Product*, OrderTemplate> orderTemplates_;
     };
 
 } // namespace gdax
\ No newline at end of file
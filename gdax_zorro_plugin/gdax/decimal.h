@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <cstddef>
+
+namespace gdax {
+
+    /**
+     * @brief Exact decimal number with 8 fractional digits, stored as a 64 bits scaled integer.
+     *
+     * Coinbase sends prices and sizes as decimal strings with at most 8 decimals, parse() reads them
+     * without going through double and format() writes them back the same. Quantities such as order
+     * sizes are multiples of the product increments, ticks() and the tick rounding helpers work on the
+     * scaled integers. An invalid decimal stands for a missing value.
+     */
+    class Decimal {
+    public:
+        static constexpr int32_t s_decimals = 8;
+        static constexpr int64_t s_unit = 100000000;
+
+        constexpr Decimal() noexcept : value_(0) {}
+
+        static constexpr Decimal fromRaw(int64_t raw) noexcept { return Decimal(raw); }
+        static constexpr Decimal invalid() noexcept { return Decimal(s_invalid); }
+
+        /**
+         * @brief Rounds the value to the nearest 1e-8. NaN or out of range values give an invalid decimal.
+         */
+        static Decimal fromDouble(double value) noexcept {
+            if (std::isnan(value) || std::fabs(value) >= (double)(INT64_MAX / s_unit)) {
+                return invalid();
+            }
+            return Decimal(std::llround(value * s_unit));
+        }
+
+        /**
+         * @brief Parse a plain decimal string such as "-123.4500". Digits beyond 8 decimals are truncated.
+         *
+         * @return false if the string is not a decimal or does not fit.
+         */
+        static bool parse(const char* s, size_t len, Decimal& out) noexcept {
+            constexpr int64_t s_maxIntegral = INT64_MAX / s_unit - 1;
+            size_t i = 0;
+            bool negative = false;
+            if (i < len && (s[i] == '-' || s[i] == '+')) {
+                negative = s[i++] == '-';
+            }
+
+            size_t digits = 0;
+            int64_t integral = 0;
+            for (; i < len && (uint8_t)(s[i] - '0') < 10; ++i, ++digits) {
+                integral = integral * 10 + (s[i] - '0');
+                if (integral > s_maxIntegral) {
+                    return false;
+                }
+            }
+
+            int64_t fraction = 0;
+            int32_t fractionDigits = 0;
+            if (i < len && s[i] == '.') {
+                for (++i; i < len && (uint8_t)(s[i] - '0') < 10; ++i, ++digits) {
+                    if (fractionDigits < s_decimals) {
+                        fraction = fraction * 10 + (s[i] - '0');
+                        ++fractionDigits;
+                    }
+                }
+            }
+
+            if (i != len || !digits) {
+                return false;
+            }
+
+            auto value = integral * s_unit + fraction * pow10(s_decimals - fractionDigits);
+            out = Decimal(negative ? -value : value);
+            return true;
+        }
+
+        constexpr int64_t raw() const noexcept { return value_; }
+        constexpr bool isValid() const noexcept { return value_ != s_invalid; }
+        constexpr bool isZero() const noexcept { return value_ == 0; }
+
+        double toDouble() const noexcept {
+            return isValid() ? (double)value_ / s_unit : NAN;
+        }
+
+        /**
+         * @brief Number of decimals needed to write the value, e.g. 2 for an increment of 0.01.
+         */
+        int32_t decimals() const noexcept {
+            if (!isValid()) {
+                return 0;
+            }
+            auto v = value_;
+            int32_t n = s_decimals;
+            while (n && v % 10 == 0) {
+                v /= 10;
+                --n;
+            }
+            return n;
+        }
+
+        /**
+         * @brief Number of whole ticks in the value.
+         */
+        int64_t ticks(Decimal tick) const noexcept {
+            return tick.value_ > 0 && isValid() ? value_ / tick.value_ : 0;
+        }
+
+        Decimal floorToTick(Decimal tick) const noexcept {
+            if (tick.value_ <= 0 || !isValid()) {
+                return *this;
+            }
+            auto q = value_ / tick.value_;
+            if (value_ % tick.value_ && value_ < 0) {
+                --q;
+            }
+            return Decimal(q * tick.value_);
+        }
+
+        Decimal ceilToTick(Decimal tick) const noexcept {
+            if (tick.value_ <= 0 || !isValid()) {
+                return *this;
+            }
+            auto q = value_ / tick.value_;
+            if (value_ % tick.value_ && value_ > 0) {
+                ++q;
+            }
+            return Decimal(q * tick.value_);
+        }
+
+        Decimal roundToTick(Decimal tick) const noexcept {
+            if (tick.value_ <= 0 || !isValid()) {
+                return *this;
+            }
+            return Decimal(value_ + tick.value_ / 2).floorToTick(tick);
+        }
+
+        /**
+         * @brief Write the value with the given number of decimals, or with as few as needed if decimals < 0.
+         *
+         * @param buf at least 32 bytes.
+         * @return length of the null-terminated string.
+         */
+        size_t format(char* buf, int32_t decimals = -1) const noexcept {
+            if (decimals < 0) {
+                decimals = this->decimals();
+            }
+            else if (decimals > s_decimals) {
+                decimals = s_decimals;
+            }
+
+            char* p = buf;
+            uint64_t v = value_ < 0 ? (uint64_t)0 - (uint64_t)value_ : (uint64_t)value_;
+            if (value_ < 0) {
+                *p++ = '-';
+            }
+
+            auto integral = v / s_unit;
+            auto fraction = v % s_unit;
+
+            char digits[20];
+            int32_t n = 0;
+            do {
+                digits[n++] = (char)('0' + integral % 10);
+                integral /= 10;
+            } while (integral);
+            while (n) {
+                *p++ = digits[--n];
+            }
+
+            if (decimals) {
+                *p++ = '.';
+                fraction /= pow10(s_decimals - decimals);
+                for (int32_t i = decimals - 1; i >= 0; --i) {
+                    p[i] = (char)('0' + fraction % 10);
+                    fraction /= 10;
+                }
+                p += decimals;
+            }
+            *p = 0;
+            return p - buf;
+        }
+
+        constexpr Decimal operator+(Decimal rhs) const noexcept { return Decimal(value_ + rhs.value_); }
+        constexpr Decimal operator-(Decimal rhs) const noexcept { return Decimal(value_ - rhs.value_); }
+        constexpr Decimal operator-() const noexcept { return Decimal(-value_); }
+        Decimal& operator+=(Decimal rhs) noexcept { value_ += rhs.value_; return *this; }
+        Decimal& operator-=(Decimal rhs) noexcept { value_ -= rhs.value_; return *this; }
+
+        constexpr bool operator==(Decimal rhs) const noexcept { return value_ == rhs.value_; }
+        constexpr bool operator!=(Decimal rhs) const noexcept { return value_ != rhs.value_; }
+        constexpr bool operator<(Decimal rhs) const noexcept { return value_ < rhs.value_; }
+        constexpr bool operator<=(Decimal rhs) const noexcept { return value_ <= rhs.value_; }
+        constexpr bool operator>(Decimal rhs) const noexcept { return value_ > rhs.value_; }
+        constexpr bool operator>=(Decimal rhs) const noexcept { return value_ >= rhs.value_; }
+
+    private:
+        static constexpr int64_t s_invalid = INT64_MIN;
+
+        constexpr explicit Decimal(int64_t value) noexcept : value_(value) {}
+
+        static int64_t pow10(int32_t n) noexcept {
+            static const int64_t s_pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+            return s_pow10[n];
+        }
+
+        int64_t value_;
+    };
+
+} // namespace gdax
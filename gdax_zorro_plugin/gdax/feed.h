@@ -0,0 +1,493 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "rapidjson/reader.h"
+#include "gdax/decimal.h"
+#include "gdax/inline_string.h"
+#include "gdax/json.h"
+#include "gdax/order.h"
+#include "gdax/timestamp.h"
+#include "gdax/uuid.h"
+
+namespace gdax {
+
+    /**
+     * @brief Type of a websocket feed message.
+     */
+    enum class FeedType : uint8_t {
+        Unknown,
+        Ticker,
+        Snapshot,
+        L2Update,
+        Heartbeat,
+        Subscriptions,
+        Error,
+        Status,
+        Received,
+        Open,
+        Done,
+        Match,
+        LastMatch,
+        Change,
+        Activate,
+    };
+
+    namespace feed {
+        // names of the types in FeedType order, starting at Ticker
+        constexpr const char* s_typeNames[] = {
+            "ticker", "snapshot", "l2update", "heartbeat", "subscriptions", "error", "status",
+            "received", "open", "done", "match", "last_match", "change", "activate",
+        };
+        constexpr size_t s_typeCount = sizeof(s_typeNames) / sizeof(s_typeNames[0]);
+        constexpr size_t s_slots = 32;
+
+        constexpr size_t length(const char* s) {
+            size_t n = 0;
+            while (s[n]) {
+                ++n;
+            }
+            return n;
+        }
+
+        /**
+         * @brief Perfect hash of the type names: every known type gets its own slot.
+         */
+        constexpr uint32_t slot(const char* s, size_t len) {
+            return (uint32_t)(len * 3 + (uint8_t)s[0] + (uint8_t)s[len - 1] * 7) & (s_slots - 1);
+        }
+
+        constexpr bool isPerfect() {
+            for (size_t i = 0; i < s_typeCount; ++i) {
+                for (size_t j = i + 1; j < s_typeCount; ++j) {
+                    if (slot(s_typeNames[i], length(s_typeNames[i])) == slot(s_typeNames[j], length(s_typeNames[j]))) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+        static_assert(isPerfect(), "feed type names collide, change the slot() hash");
+
+        struct TypeTable {
+            uint8_t types[s_slots];
+            uint8_t lengths[s_slots];
+
+            constexpr TypeTable() : types(), lengths() {
+                for (size_t i = 0; i < s_typeCount; ++i) {
+                    auto len = length(s_typeNames[i]);
+                    auto n = slot(s_typeNames[i], len);
+                    types[n] = (uint8_t)(i + 1);
+                    lengths[n] = (uint8_t)len;
+                }
+            }
+        };
+        constexpr TypeTable s_typeTable;
+    }
+
+    /**
+     * @brief One hash, one length check and one memcmp.
+     */
+    inline FeedType to_feedType(const char* type, size_t len) {
+        if (!len) {
+            return FeedType::Unknown;
+        }
+        auto n = feed::slot(type, len);
+        auto t = feed::s_typeTable.types[n];
+        if (t && feed::s_typeTable.lengths[n] == len && memcmp(feed::s_typeNames[t - 1], type, len) == 0) {
+            return (FeedType)t;
+        }
+        return FeedType::Unknown;
+    }
+
+    /**
+     * @brief Fields shared by the feed messages.
+     *
+     * A message reads its fields with a table over "name"_field constants, like the REST structs do:
+     * onString() and onNumber() get the top level members, onElement() the strings of arrays nested in
+     * an array member, such as the changes of a l2update.
+     */
+    struct FeedMessage {
+        FeedType type = FeedType::Unknown;
+        uint64_t sequence = 0;
+        InlineString<15> product_id;
+        int64_t time = 0;           // nanoseconds since epoch
+
+        bool onString(uint64_t field, const char* s, size_t len) {
+            switch (field) {
+            case "product_id"_field: product_id.assign(s, len); return true;
+            case "time"_field: return parseTimestamp(s, len, time);
+            }
+            return false;
+        }
+
+        void onNumber(uint64_t field, uint64_t value) {
+            if (field == "sequence"_field) {
+                sequence = value;
+            }
+        }
+
+        void onElement(uint64_t, uint32_t, const char*, size_t) {}
+        void onElementEnd(uint64_t) {}
+    };
+
+    struct FeedTicker : FeedMessage {
+        uint64_t trade_id = 0;
+        OrderSide side = OrderSide::Buy;
+        Decimal price = Decimal::invalid();
+        Decimal best_bid = Decimal::invalid();
+        Decimal best_ask = Decimal::invalid();
+        Decimal last_size = Decimal::invalid();
+        // may exceed the range of Decimal, e.g. for tokens priced below a cent
+        double volume_24h = NAN;
+
+        bool onString(uint64_t field, const char* s, size_t len) {
+            switch (field) {
+            case "price"_field: return Decimal::parse(s, len, price);
+            case "best_bid"_field: return Decimal::parse(s, len, best_bid);
+            case "best_ask"_field: return Decimal::parse(s, len, best_ask);
+            case "last_size"_field: return Decimal::parse(s, len, last_size);
+            case "volume_24h"_field: return parseDouble(s, len, volume_24h);
+            case "side"_field: side = to_orderSide(s, len); return true;
+            }
+            return FeedMessage::onString(field, s, len);
+        }
+
+        void onNumber(uint64_t field, uint64_t value) {
+            if (field == "trade_id"_field) {
+                trade_id = value;
+            }
+            else {
+                FeedMessage::onNumber(field, value);
+            }
+        }
+    };
+
+    struct FeedL2Change {
+        OrderSide side = OrderSide::Buy;
+        Decimal price;
+        Decimal size;
+    };
+
+    struct FeedL2Update : FeedMessage {
+        static constexpr uint32_t s_maxChanges = 64;
+
+        uint32_t count = 0;
+        // more than s_maxChanges changes, the extra ones are dropped
+        bool truncated = false;
+        FeedL2Change changes[s_maxChanges];
+
+        void onElement(uint64_t field, uint32_t index, const char* s, size_t len) {
+            if (field != "changes"_field || count == s_maxChanges) {
+                return;
+            }
+            // ["buy", "price", "size"]
+            auto& change = changes[count];
+            switch (index) {
+            case 0: change.side = to_orderSide(s, len); break;
+            case 1: Decimal::parse(s, len, change.price); break;
+            case 2: Decimal::parse(s, len, change.size); break;
+            }
+        }
+
+        void onElementEnd(uint64_t field) {
+            if (field == "changes"_field) {
+                if (count < s_maxChanges) {
+                    ++count;
+                }
+                else {
+                    truncated = true;
+                }
+            }
+        }
+    };
+
+    struct FeedHeartbeat : FeedMessage {
+        uint64_t last_trade_id = 0;
+
+        void onNumber(uint64_t field, uint64_t value) {
+            if (field == "last_trade_id"_field) {
+                last_trade_id = value;
+            }
+            else {
+                FeedMessage::onNumber(field, value);
+            }
+        }
+    };
+
+    /**
+     * @brief match and last_match messages.
+     */
+    struct FeedMatch : FeedMessage {
+        uint64_t trade_id = 0;
+        OrderSide side = OrderSide::Buy;
+        Decimal price;
+        Decimal size;
+        Uuid maker_order_id;
+        Uuid taker_order_id;
+        // user channel only, the fee rate of the side which is ours
+        Decimal maker_fee_rate = Decimal::invalid();
+        Decimal taker_fee_rate = Decimal::invalid();
+
+        bool onString(uint64_t field, const char* s, size_t len) {
+            switch (field) {
+            case "price"_field: return Decimal::parse(s, len, price);
+            case "size"_field: return Decimal::parse(s, len, size);
+            case "maker_fee_rate"_field: return Decimal::parse(s, len, maker_fee_rate);
+            case "taker_fee_rate"_field: return Decimal::parse(s, len, taker_fee_rate);
+            case "side"_field: side = to_orderSide(s, len); return true;
+            case "maker_order_id"_field: return Uuid::parse(s, len, maker_order_id);
+            case "taker_order_id"_field: return Uuid::parse(s, len, taker_order_id);
+            }
+            return FeedMessage::onString(field, s, len);
+        }
+
+        void onNumber(uint64_t field, uint64_t value) {
+            if (field == "trade_id"_field) {
+                trade_id = value;
+            }
+            else {
+                FeedMessage::onNumber(field, value);
+            }
+        }
+    };
+
+    /**
+     * @brief received, open, done, change and activate messages, i.e. the life of an order.
+     */
+    struct FeedOrder : FeedMessage {
+        OrderSide side = OrderSide::Buy;
+        OrderType order_type = OrderType::Limit;
+        Decimal price = Decimal::invalid();
+        Decimal size = Decimal::invalid();
+        Decimal remaining_size = Decimal::invalid();
+        Decimal new_size = Decimal::invalid();
+        Decimal funds = Decimal::invalid();
+        Uuid order_id;
+        InlineString<36> client_oid;
+        // done reason: "filled" or "canceled"
+        InlineString<15> reason;
+
+        bool onString(uint64_t field, const char* s, size_t len) {
+            switch (field) {
+            case "order_id"_field: return Uuid::parse(s, len, order_id);
+            case "client_oid"_field: client_oid.assign(s, len); return true;
+            case "side"_field: side = to_orderSide(s, len); return true;
+            case "order_type"_field: return to_orderType(s, len, order_type);
+            case "price"_field: return Decimal::parse(s, len, price);
+            case "size"_field: return Decimal::parse(s, len, size);
+            case "remaining_size"_field: return Decimal::parse(s, len, remaining_size);
+            case "new_size"_field: return Decimal::parse(s, len, new_size);
+            case "funds"_field: return Decimal::parse(s, len, funds);
+            case "reason"_field: reason.assign(s, len); return true;
+            }
+            return FeedMessage::onString(field, s, len);
+        }
+    };
+
+    struct FeedError : FeedMessage {
+        InlineString<127> message;
+        InlineString<127> reason;
+
+        bool onString(uint64_t field, const char* s, size_t len) {
+            switch (field) {
+            case "message"_field: message.assign(s, len); return true;
+            case "reason"_field: reason.assign(s, len); return true;
+            }
+            return false;
+        }
+    };
+
+    /**
+     * @brief SAX handler filling one feed message. Only the members the message asks for are converted.
+     */
+    template<typename M>
+    class FeedMessageHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, FeedMessageHandler<M>> {
+    public:
+        explicit FeedMessageHandler(M& msg) : msg_(msg) {}
+
+        bool Int(int i) { return i < 0 || number((uint64_t)i); }
+        bool Uint(unsigned i) { return number(i); }
+        bool Int64(int64_t i) { return i < 0 || number((uint64_t)i); }
+        bool Uint64(uint64_t i) { return number(i); }
+
+        bool String(const char* str, rapidjson::SizeType length, bool) {
+            if (depth_ == 1) {
+                msg_.onString(field_, str, length);
+            }
+            else if (depth_ == 3) {
+                msg_.onElement(field_, index_++, str, length);
+            }
+            return true;
+        }
+
+        bool Key(const char* str, rapidjson::SizeType length, bool) {
+            if (depth_ == 1) {
+                field_ = fieldHash(str, length);
+            }
+            return true;
+        }
+
+        bool StartObject() {
+            ++depth_;
+            return true;
+        }
+
+        bool EndObject(rapidjson::SizeType) {
+            --depth_;
+            return true;
+        }
+
+        bool StartArray() {
+            if (++depth_ == 3) {
+                index_ = 0;
+            }
+            return true;
+        }
+
+        bool EndArray(rapidjson::SizeType) {
+            if (depth_-- == 3) {
+                msg_.onElementEnd(field_);
+            }
+            return true;
+        }
+
+    private:
+        bool number(uint64_t value) {
+            if (depth_ == 1) {
+                msg_.onNumber(field_, value);
+            }
+            return true;
+        }
+
+    private:
+        M& msg_;
+        uint64_t field_ = 0;
+        uint32_t depth_ = 0;
+        uint32_t index_ = 0;
+    };
+
+    /**
+     * @brief Default, empty callbacks of the feed decoder. A listener hides the ones it is interested in.
+     */
+    struct FeedListener {
+        void onFeedTicker(const FeedTicker&) {}
+        void onFeedL2Update(const FeedL2Update&) {}
+        void onFeedHeartbeat(const FeedHeartbeat&) {}
+        void onFeedMatch(const FeedMatch&) {}
+        void onFeedOrder(const FeedOrder&) {}
+        void onFeedError(const FeedError&) {}
+        // messages which are not decoded, e.g. subscriptions and snapshot
+        void onFeedMessage(FeedType, const char*, size_t) {}
+    };
+
+    /**
+     * @brief Decoder of the websocket feed messages.
+     *
+     * The "type" member is located first and dispatched through the perfect hash of to_feedType(),
+     * then the message is parsed in-situ by the SAX handler of its type into a fixed struct on the stack.
+     * The message is copied into a buffer which only grows, so decoding does not allocate in steady state.
+     * Not thread safe, a decoder belongs to the websocket thread.
+     */
+    template<typename Listener>
+    class FeedDecoder {
+    public:
+        static constexpr size_t s_initialCapacity = 64 * 1024;
+
+        explicit FeedDecoder(Listener& listener) : listener_(listener) {
+            buffer_.reserve(s_initialCapacity);
+        }
+
+        /**
+         * @return false if the message has no type or is not valid JSON.
+         */
+        bool decode(const char* data, size_t len) {
+            buffer_.assign(data, data + len);
+            buffer_.push_back(0);
+            char* json = buffer_.data();
+
+            const char* type;
+            size_t typeLength;
+            if (!findType(json, type, typeLength)) {
+                return false;
+            }
+
+            auto feedType = to_feedType(type, typeLength);
+            switch (feedType) {
+            case FeedType::Ticker:
+                return parse<FeedTicker>(json, feedType, [this](const FeedTicker& msg) { listener_.onFeedTicker(msg); });
+            case FeedType::L2Update:
+                return parse<FeedL2Update>(json, feedType, [this](const FeedL2Update& msg) { listener_.onFeedL2Update(msg); });
+            case FeedType::Heartbeat:
+                return parse<FeedHeartbeat>(json, feedType, [this](const FeedHeartbeat& msg) { listener_.onFeedHeartbeat(msg); });
+            case FeedType::Match:
+            case FeedType::LastMatch:
+                return parse<FeedMatch>(json, feedType, [this](const FeedMatch& msg) { listener_.onFeedMatch(msg); });
+            case FeedType::Received:
+            case FeedType::Open:
+            case FeedType::Done:
+            case FeedType::Change:
+            case FeedType::Activate:
+                return parse<FeedOrder>(json, feedType, [this](const FeedOrder& msg) { listener_.onFeedOrder(msg); });
+            case FeedType::Error:
+                return parse<FeedError>(json, feedType, [this](const FeedError& msg) { listener_.onFeedError(msg); });
+            default:
+                listener_.onFeedMessage(feedType, data, len);
+                return true;
+            }
+        }
+
+    private:
+        /**
+         * @brief Find the value of the "type" member. Coinbase sends it first, so this is a short scan.
+         */
+        static bool findType(const char* json, const char*& type, size_t& len) {
+            const char* p = strstr(json, "\"type\"");
+            if (!p) {
+                return false;
+            }
+            p += 6;
+            while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+                ++p;
+            }
+            if (*p++ != ':') {
+                return false;
+            }
+            while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+                ++p;
+            }
+            if (*p++ != '"') {
+                return false;
+            }
+            const char* end = strchr(p, '"');
+            if (!end) {
+                return false;
+            }
+            type = p;
+            len = end - p;
+            return true;
+        }
+
+        template<typename M, typename F>
+        bool parse(char* json, FeedType type, F&& deliver) {
+            M msg;
+            msg.type = type;
+            FeedMessageHandler<M> handler(msg);
+            rapidjson::InsituStringStream ss(json);
+            if (reader_.template Parse<rapidjson::kParseInsituFlag>(ss, handler).IsError()) {
+                return false;
+            }
+            deliver(msg);
+            return true;
+        }
+
+    private:
+        Listener& listener_;
+        std::vector<char> buffer_;
+        rapidjson::Reader reader_;
+    };
+
+} // namespace gdax
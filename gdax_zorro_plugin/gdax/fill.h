@@ -3,16 +3,18 @@
 #include <cstdint>
 #include <string>
 #include "order.h"
+#include "gdax/json.h"
+#include "gdax/timestamp.h"
 
 namespace gdax {
 
     struct Fill {
         std::string product_id;
         std::string order_id;
-        std::string created_at;
-        double price;
-        double size;
-        double fee;
+        Decimal price;
+        Decimal size;
+        Decimal fee;
+        int64_t created_at = 0;     // nanoseconds since epoch
         uint32_t fill_id;
         OrderSide side;
         bool settled;
@@ -24,15 +26,20 @@ namespace gdax {
 
         template <typename T>
         std::pair<int, std::string> fromJSON(const T& parser) {
-            parser.get<std::string>("product_id", product_id);
-            parser.get<std::string>("order_id", order_id);
-            parser.get<std::string>("created_at", created_at);
-            parser.get<double>("price", price);
-            parser.get<double>("size", size);
-            parser.get<double>("fee", fee);
-            parser.get<bool>("settled", settled);
-            parser.get<uint32_t>("fill_id", fill_id);
-            side = to_orderSide(parser.get<std::string>("side"));
+            side = OrderSide::Sell;
+            parser.forEach([this](uint64_t field, const auto& value) {
+                switch (field) {
+                case "product_id"_field: readJson(value, product_id); break;
+                case "order_id"_field: readJson(value, order_id); break;
+                case "created_at"_field: readTimestamp(value, created_at); break;
+                case "price"_field: readJson(value, price); break;
+                case "size"_field: readJson(value, size); break;
+                case "fee"_field: readJson(value, fee); break;
+                case "settled"_field: readJson(value, settled); break;
+                case "fill_id"_field: readJson(value, fill_id); break;
+                case "side"_field: readJson(value, side); break;
+                }
+            });
             return std::make_pair(0, "OK");
         }
     };
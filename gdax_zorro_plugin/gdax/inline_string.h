@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace gdax {
+
+    /**
+     * @brief A string which stores up to N characters inline, longer strings fall back to the heap.
+     *
+     * Used by the domain structs for short fields such as ids, product ids and timestamps, so parsing
+     * them does not allocate.
+     */
+    template<size_t N>
+    class InlineString {
+    public:
+        InlineString() noexcept { inline_[0] = 0; }
+        InlineString(const char* s) { inline_[0] = 0; assign(s, strlen(s)); }
+        InlineString(const std::string& s) { inline_[0] = 0; assign(s.c_str(), s.size()); }
+        InlineString(const InlineString& rhs) { inline_[0] = 0; assign(rhs.c_str(), rhs.size_); }
+        InlineString(InlineString&& rhs) noexcept { inline_[0] = 0; swap(rhs); }
+        ~InlineString() { delete[] heap_; }
+
+        InlineString& operator=(const InlineString& rhs) {
+            if (this != &rhs) {
+                assign(rhs.c_str(), rhs.size_);
+            }
+            return *this;
+        }
+
+        InlineString& operator=(InlineString&& rhs) noexcept {
+            swap(rhs);
+            return *this;
+        }
+
+        InlineString& operator=(const char* s) { return assign(s, strlen(s)); }
+        InlineString& operator=(const std::string& s) { return assign(s.c_str(), s.size()); }
+
+        InlineString& assign(const char* s, size_t len) {
+            char* dest = inline_;
+            if (len > N) {
+                if (!heap_ || len > capacity_) {
+                    delete[] heap_;
+                    heap_ = new char[len + 1];
+                    capacity_ = len;
+                }
+                dest = heap_;
+            }
+            memmove(dest, s, len);
+            dest[len] = 0;
+            size_ = (uint32_t)len;
+            return *this;
+        }
+
+        const char* c_str() const noexcept { return size_ > N ? heap_ : inline_; }
+        size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+        std::string str() const { return std::string(c_str(), size_); }
+
+        bool equals(const char* s, size_t len) const noexcept {
+            return len == size_ && memcmp(c_str(), s, len) == 0;
+        }
+
+        bool operator==(const char* s) const noexcept { return equals(s, strlen(s)); }
+        bool operator!=(const char* s) const noexcept { return !(*this == s); }
+        bool operator==(const std::string& s) const noexcept { return equals(s.c_str(), s.size()); }
+        bool operator!=(const std::string& s) const noexcept { return !(*this == s); }
+        bool operator==(const InlineString& s) const noexcept { return equals(s.c_str(), s.size_); }
+        bool operator!=(const InlineString& s) const noexcept { return !(*this == s); }
+
+        friend std::string operator+(const std::string& lhs, const InlineString& rhs) {
+            std::string s;
+            s.reserve(lhs.size() + rhs.size_);
+            return s.append(lhs).append(rhs.c_str(), rhs.size_);
+        }
+
+        friend std::string operator+(const char* lhs, const InlineString& rhs) {
+            return std::string(lhs) + rhs;
+        }
+
+        friend std::string operator+(const InlineString& lhs, const std::string& rhs) {
+            std::string s;
+            s.reserve(lhs.size_ + rhs.size());
+            return s.append(lhs.c_str(), lhs.size_).append(rhs);
+        }
+
+    private:
+        void swap(InlineString& rhs) noexcept {
+            char tmp[N + 1];
+            memcpy(tmp, inline_, N + 1);
+            memcpy(inline_, rhs.inline_, N + 1);
+            memcpy(rhs.inline_, tmp, N + 1);
+            std::swap(size_, rhs.size_);
+            std::swap(capacity_, rhs.capacity_);
+            std::swap(heap_, rhs.heap_);
+        }
+
+    private:
+        char inline_[N + 1];
+        uint32_t size_ = 0;
+        size_t capacity_ = 0;
+        char* heap_ = nullptr;
+    };
+
+} // namespace gdax
@@ -1,186 +1,295 @@
+#pragma once
+
 #include "rapidjson/document.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 #include <vector>
+#include "gdax/inline_string.h"
+#include "gdax/decimal.h"
 
 namespace gdax {
-    
-    template<typename T>
-    struct Parser {
-        const T& json;
 
-        Parser(const T& j) : json(j) {}
+    using JsonAllocator = rapidjson::MemoryPoolAllocator<>;
+    using JsonDocument = rapidjson::GenericDocument<rapidjson::UTF8<>, JsonAllocator, JsonAllocator>;
 
-        template<typename U>
-        bool get(const char* name, U& value) const;
+    /**
+     * @brief Per-thread memory of the parsing DOM.
+     *
+     * The values and the parse stack are allocated from thread local buffers which are reused by every
+     * document. Only payloads outgrowing the buffers allocate extra chunks, released on the next reset.
+     */
+    class JsonArena {
+    public:
+        static constexpr size_t s_initialStackCapacity = 4 * 1024;
 
-        template<>
-        bool get<std::string>(const char* name, std::string& value) const {
-            if (json.HasMember(name) && json[name].IsString()) {
-                value = json[name].GetString();
-                return true;
-            }
-            return false;
+        static JsonArena& get() {
+            static thread_local JsonArena s_arena;
+            return s_arena;
         }
 
-        template<>
-        bool get<int32_t>(const char* name, int32_t& value) const {
-            if (json.HasMember(name)) {
-                if (json[name].IsInt()) {
-                    value = json[name].GetInt();
-                    return true;
-                }
-                if (json[name].IsUint()) {
-                    value = json[name].GetUint();
-                    return true;
-                }
-                if (json[name].IsString()) {
-                    value = atoi(json[name].GetString());
-                    return true;
-                }
-            }
-            return false;
+        /**
+         * @brief Release the memory of the previous document.
+         */
+        JsonArena& reset() {
+            values_.Clear();
+            stack_.Clear();
+            return *this;
         }
 
-        template<>
-        bool get<uint32_t>(const char* name, uint32_t& value) const {
-            if (json.HasMember(name)) {
-                if (json[name].IsUint()) {
-                    value = json[name].GetUint();
-                    return true;
-                }
-                if (json[name].IsInt()) {
-                    value = json[name].GetInt();
-                    return true;
-                }
-                if (json[name].IsString()) {
-                    value = atoi(json[name].GetString());
-                }
-            }
-            return false;
+        JsonAllocator& values() noexcept { return values_; }
+        JsonAllocator& stack() noexcept { return stack_; }
+
+    private:
+        JsonArena() : values_(valuesBuffer_, sizeof(valuesBuffer_)), stack_(stackBuffer_, sizeof(stackBuffer_)) {}
+
+        alignas(16) char valuesBuffer_[64 * 1024];
+        alignas(16) char stackBuffer_[16 * 1024];
+        JsonAllocator values_;
+        JsonAllocator stack_;
+    };
+
+    /**
+     * @brief A document allocated from the arena of the calling thread. Only one can be alive per thread.
+     */
+    class PooledDocument : public JsonDocument {
+    public:
+        PooledDocument() : PooledDocument(JsonArena::get().reset()) {}
+
+    private:
+        explicit PooledDocument(JsonArena& arena) : JsonDocument(&arena.values(), JsonArena::s_initialStackCapacity, &arena.stack()) {}
+    };
+
+    /**
+     * @brief 64 bits FNV-1a hash of a JSON key. Evaluated at compile time for the field tables.
+     */
+    constexpr uint64_t fieldHash(const char* s, size_t len) {
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < len; ++i) {
+            h = (h ^ (uint8_t)s[i]) * 1099511628211ull;
         }
+        return h;
+    }
 
-        template<>
-        bool get<int64_t>(const char* name, int64_t& value) const {
-            if (json.HasMember(name)) {
-                if (json[name].IsInt64()) {
-                    value = json[name].GetInt64();
-                    return true;
-                }
-                if (json[name].IsUint64()) {
-                    value = json[name].GetUint64();
-                    return true;
-                }
-                if (json[name].IsString()) {
-                    value = _atoi64(json[name].GetString());
-                    return true;
-                }
-            }
-            return false;
+    constexpr uint64_t operator"" _field(const char* s, size_t len) {
+        return fieldHash(s, len);
+    }
+
+    // Conversions of a JSON value. Numbers may be sent as strings.
+    template<typename V>
+    bool readJson(const V& v, std::string& value) {
+        if (v.IsString()) {
+            value.assign(v.GetString(), v.GetStringLength());
+            return true;
         }
+        return false;
+    }
 
-        template<>
-        bool get<uint64_t>(const char* name, uint64_t& value) const {
-            if (json.HasMember(name)) {
-                if (json[name].IsUint64()) {
-                    value = json[name].GetUint64();
-                    return true;
-                }
-                if (json[name].IsInt64()) {
-                    value = json[name].GetInt64();
-                    return true;
-                }
-                if (json[name].IsString()) {
-                    value = _atoi64(json[name].GetString());
-                    return true;
-                }
-            }
-            return false;
+    template<typename V, size_t N>
+    bool readJson(const V& v, InlineString<N>& value) {
+        if (v.IsString()) {
+            value.assign(v.GetString(), v.GetStringLength());
+            return true;
         }
+        return false;
+    }
 
-        template<>
-        bool get<bool>(const char* name, bool& value) const {
-            if (json.HasMember(name) && json[name].IsBool()) {
-                value = json[name].GetBool();
-                return true;
+    template<typename V>
+    bool readJson(const V& v, Decimal& value) {
+        if (v.IsString()) {
+            return Decimal::parse(v.GetString(), v.GetStringLength(), value);
+        }
+        if (v.IsInt64()) {
+            // same range as Decimal::parse, out of range values are not scaled
+            constexpr int64_t s_maxIntegral = INT64_MAX / Decimal::s_unit - 1;
+            auto i = v.GetInt64();
+            if (i > s_maxIntegral || i < -s_maxIntegral) {
+                return false;
             }
-            return false;
+            value = Decimal::fromRaw(i * Decimal::s_unit);
+            return true;
         }
-
-        template<>
-        bool get<double>(const char* name, double& value) const {
-            if (json.HasMember(name)) {
-                auto type = json[name].GetType();
-                if (json[name].IsNumber()) {
-                    value = json[name].GetDouble();
-                    return true;
-                }
-                if (json[name].IsString()) {
-                    value = atof(json[name].GetString());
-                    return true;
-                }
+        if (v.IsNumber()) {
+            auto d = Decimal::fromDouble(v.GetDouble());
+            if (!d.isValid()) {
+                return false;
             }
-            return false;
+            value = d;
+            return true;
         }
+        return false;
+    }
 
-        template<>
-        bool get<float>(const char* name, float& value) const {
-            if (json.HasMember(name)) {
-                if (json[name].IsNumber()) {
-                    value = json[name].GetFloat();
-                    return true;
-                }
-                if (json[name].IsString()) {
-                    value = (float)atof(json[name].GetString());
-                    return true;
-                }
-            }
-            return false;
+    template<typename V>
+    bool readJson(const V& v, int32_t& value) {
+        if (v.IsInt()) {
+            value = v.GetInt();
+            return true;
+        }
+        if (v.IsUint()) {
+            value = v.GetUint();
+            return true;
         }
+        if (v.IsString()) {
+            value = atoi(v.GetString());
+            return true;
+        }
+        return false;
+    }
 
-        template<>
-        bool get<std::vector<double>>(const char* name, std::vector<double>& value) const {
-            if (json.HasMember(name) && json[name].IsArray()) {
-                for (auto& item : json[name].GetArray()) {
-                    if (item.IsNumber()) {
-                        value.push_back(item.GetDouble());
-                    }
-                }
-                return true;
-            }
+    template<typename V>
+    bool readJson(const V& v, uint32_t& value) {
+        if (v.IsUint()) {
+            value = v.GetUint();
+            return true;
+        }
+        if (v.IsInt()) {
+            value = v.GetInt();
+            return true;
+        }
+        if (v.IsString()) {
+            value = atoi(v.GetString());
+            return true;
+        }
+        return false;
+    }
+
+    template<typename V>
+    bool readJson(const V& v, int64_t& value) {
+        if (v.IsInt64()) {
+            value = v.GetInt64();
+            return true;
+        }
+        if (v.IsUint64()) {
+            value = v.GetUint64();
+            return true;
+        }
+        if (v.IsString()) {
+            value = strtoll(v.GetString(), nullptr, 10);
+            return true;
+        }
+        return false;
+    }
+
+    template<typename V>
+    bool readJson(const V& v, uint64_t& value) {
+        if (v.IsUint64()) {
+            value = v.GetUint64();
+            return true;
+        }
+        if (v.IsInt64()) {
+            value = v.GetInt64();
+            return true;
+        }
+        if (v.IsString()) {
+            value = strtoull(v.GetString(), nullptr, 10);
+            return true;
+        }
+        return false;
+    }
+
+    template<typename V>
+    bool readJson(const V& v, bool& value) {
+        if (v.IsBool()) {
+            value = v.GetBool();
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Parse a number which is not null-terminated.
+     *
+     * @return false if s is not entirely a number.
+     */
+    inline bool parseDouble(const char* s, size_t len, double& value) noexcept {
+        char buf[64];
+        if (!len || len >= sizeof(buf)) {
+            return false;
+        }
+        memcpy(buf, s, len);
+        buf[len] = 0;
+        char* end;
+        auto d = strtod(buf, &end);
+        if (end != buf + len) {
             return false;
         }
+        value = d;
+        return true;
+    }
 
-        template<>
-        bool get<std::vector<float>>(const char* name, std::vector<float>& value) const {
-            if (json.HasMember(name) && json[name].IsArray()) {
+    template<typename V>
+    bool readJson(const V& v, double& value) {
+        if (v.IsNumber()) {
+            value = v.GetDouble();
+            return true;
+        }
+        if (v.IsString()) {
+            value = atof(v.GetString());
+            return true;
+        }
+        return false;
+    }
 
-                for (auto& item : json[name].GetArray()) {
-                    if (item.IsNumber()) {
-                        value.push_back(item.GetFloat());
-                    }
-                }
-                return true;
-            }
+    template<typename V>
+    bool readJson(const V& v, float& value) {
+        if (v.IsNumber()) {
+            value = v.GetFloat();
+            return true;
+        }
+        if (v.IsString()) {
+            value = (float)atof(v.GetString());
+            return true;
+        }
+        return false;
+    }
+
+    template<typename V, typename U>
+    bool readJson(const V& v, std::vector<U>& value) {
+        if (!v.IsArray()) {
             return false;
         }
+        for (auto& item : v.GetArray()) {
+            U u;
+            if (item.IsNumber() && readJson(item, u)) {
+                value.push_back(u);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reads the fields of a JSON object.
+     *
+     * Structs parse themselves with a field table: forEach() walks the members once and hands the
+     * key hash to a switch over "name"_field constants, so every member is looked at exactly once and
+     * a duplicated field is a compile error. get() looks up a single member.
+     */
+    template<typename T>
+    struct Parser {
+        const T& json;
 
-        template<>
-        bool get<std::vector<uint64_t>>(const char* name, std::vector<uint64_t>& value) const {
-            if (json.HasMember(name) && json[name].IsArray()) {
+        Parser(const T& j) : json(j) {}
 
-                for (auto& item : json[name].GetArray()) {
-                    if (item.IsNumber()) {
-                        value.push_back(item.GetUint64());
-                    }
-                }
-                return true;
+        template<typename F>
+        void forEach(F&& f) const {
+            for (auto it = json.MemberBegin(); it != json.MemberEnd(); ++it) {
+                f(fieldHash(it->name.GetString(), it->name.GetStringLength()), it->value);
             }
-            return false;
+        }
+
+        template<typename U>
+        bool get(const char* name, U& value) const {
+            auto it = json.FindMember(name);
+            return it != json.MemberEnd() && readJson(it->value, value);
         }
 
         template<typename U>
         U get(const char* name) const {
-            if (json.HasMember(name) && json[name].IsString()) {
-                return json[name].GetString();
+            auto it = json.FindMember(name);
+            if (it != json.MemberEnd() && it->value.IsString()) {
+                return it->value.GetString();
             }
             return "";
         }
@@ -2,8 +2,12 @@
 
 #include <string>
 #include <cassert>
-#include <unordered_map>
+#include <cstring>
 #include "rapidjson/document.h"
+#include "gdax/json.h"
+#include "gdax/inline_string.h"
+#include "gdax/timestamp.h"
+#include "gdax/uuid.h"
 
 namespace gdax {
 
@@ -24,8 +28,8 @@ namespace gdax {
         return sOrderSide[side];
     }
 
-    inline OrderSide to_orderSide(const std::string& side) {
-        return side == "buy" ? OrderSide::Buy : OrderSide::Sell;
+    inline OrderSide to_orderSide(const char* side, size_t len) {
+        return len == 3 && side[0] == 'b' ? OrderSide::Buy : OrderSide::Sell;
     }
 
     /**
@@ -49,13 +53,19 @@ namespace gdax {
         return sOrderType[type];
     }
 
-    inline OrderType to_orderType(const std::string& type) {
-        static std::unordered_map<std::string, OrderType> orderTypes = {
-            {"market", OrderType::Market},
-            {"limit", OrderType::Limit},
-        };
-        assert(orderTypes.find(type) != orderTypes.end());
-        return orderTypes[type];
+    /**
+     * @return false if the type is neither "market" nor "limit", value is not changed.
+     */
+    inline bool to_orderType(const char* type, size_t len, OrderType& value) {
+        if (len == 6 && memcmp(type, "market", 6) == 0) {
+            value = OrderType::Market;
+            return true;
+        }
+        if (len == 5 && memcmp(type, "limit", 5) == 0) {
+            value = OrderType::Limit;
+            return true;
+        }
+        return false;
     }
 
     /**
@@ -80,15 +90,20 @@ namespace gdax {
         return sTIF[tif];
     }
 
-    inline TimeInForce to_timeInForce(const std::string& tif) {
-        static std::unordered_map<std::string, TimeInForce> tifs = {
-            {"GTC", TimeInForce::GTC},
-            {"GTT", TimeInForce::GTT},
-            {"IOC", TimeInForce::IOC},
-            {"FOK", TimeInForce::FOK},
-        };
-        assert(tifs.find(tif) != tifs.end());
-        return tifs[tif];
+    /**
+     * @return false if tif is not one of to_string(TimeInForce), value is not changed.
+     */
+    inline bool to_timeInForce(const char* tif, size_t len, TimeInForce& value) {
+        if (len != 3) {
+            return false;
+        }
+        for (auto t : { TimeInForce::GTC, TimeInForce::GTT, TimeInForce::IOC, TimeInForce::FOK }) {
+            if (memcmp(tif, to_string(t), 3) == 0) {
+                value = t;
+                return true;
+            }
+        }
+        return false;
     }
 
     enum StopType : uint8_t {
@@ -102,13 +117,93 @@ namespace gdax {
         return sStopType[stopType];
     }
 
-    inline StopType to_stopType(const std::string& type) {
-        static std::unordered_map<std::string, StopType> stopTypes = {
-            {"loss", StopType::Loss},
-            {"entry", StopType::Entry},
-        };
-        assert(stopTypes.find(type) != stopTypes.end());
-        return stopTypes[type];
+    /**
+     * @brief Lifecycle of an order. Canceled is set locally, Coinbase removes canceled orders.
+     */
+    enum class OrderStatus : uint8_t {
+        Unknown,
+        Pending,
+        Open,
+        Active,
+        Done,
+        Canceled,
+        Rejected,
+    };
+
+    inline constexpr const char* to_string(OrderStatus status) {
+        constexpr const char* sOrderStatus[] = { "unknown", "pending", "open", "active", "done", "canceled", "rejected" };
+        return sOrderStatus[(uint8_t)status];
+    }
+
+    inline OrderStatus to_orderStatus(const char* status, size_t len) {
+        switch (len) {
+        case 4:
+            switch (status[0]) {
+            case 'o':
+                return OrderStatus::Open;
+            case 'd':
+                return OrderStatus::Done;
+            }
+            break;
+        case 6:
+            if (status[0] == 'a') {
+                return OrderStatus::Active;
+            }
+            break;
+        case 7:
+            if (status[0] == 'p') {
+                return OrderStatus::Pending;
+            }
+            break;
+        case 8:
+            switch (status[0]) {
+            case 'c':
+                return OrderStatus::Canceled;
+            case 'r':
+                return OrderStatus::Rejected;
+            }
+            break;
+        }
+        return OrderStatus::Unknown;
+    }
+
+    // Enum fields of the field tables. Unknown values keep the current value.
+    template<typename V>
+    bool readJson(const V& v, OrderSide& value) {
+        if (!v.IsString()) {
+            return false;
+        }
+        value = to_orderSide(v.GetString(), v.GetStringLength());
+        return true;
+    }
+
+    template<typename V>
+    bool readJson(const V& v, OrderType& value) {
+        if (!v.IsString()) {
+            return false;
+        }
+        return to_orderType(v.GetString(), v.GetStringLength(), value);
+    }
+
+    template<typename V>
+    bool readJson(const V& v, TimeInForce& value) {
+        if (!v.IsString()) {
+            return false;
+        }
+        return to_timeInForce(v.GetString(), v.GetStringLength(), value);
+    }
+
+    template<typename V>
+    bool readJson(const V& v, OrderStatus& value) {
+        if (!v.IsString()) {
+            return false;
+        }
+        auto status = to_orderStatus(v.GetString(), v.GetStringLength());
+        if (status == OrderStatus::Unknown) {
+            return false;
+        }
+        value = status;
+        return true;
     }
 
 
@@ -116,50 +211,72 @@ namespace gdax {
      * @brief A type representing an Alpaca order.
      */
     struct Order {
-        double price = NAN;
-        double size = 0.;
-        double fill_fees;
-        double filled_size;
-        double filled_price;
-        double executed_value;
+        Decimal price = Decimal::invalid();
+        Decimal size;
+        Decimal fill_fees;
+        Decimal filled_size;
+        double filled_price = 0.;
+        Decimal executed_value;
+        int64_t created_at = 0;     // nanoseconds since epoch
         OrderSide side;
         TimeInForce tif = TimeInForce::GTC;
         OrderType type;
         bool post_only = false;
         bool settled = false;
 
-        std::string product_id;
-        std::string created_at;
-        std::string id;
-        std::string stp;
-        std::string status;
+        InlineString<15> product_id;
+        Uuid id;
+        InlineString<3> stp;
+        OrderStatus status = OrderStatus::Unknown;
+
+        // the order which closed this one, nil if none
+        Uuid close_order_id;
+        // trade id of the last match applied from the user channel, 0 if none
+        uint64_t last_trade_id = 0;
+        // local time of the last resync of the order, nanoseconds since epoch. Older matches are in its state.
+        int64_t synced_at = 0;
 
-        Order* closeOrder = nullptr;
+        /**
+         * @brief Replace the order with a REST snapshot, keeping the state which is only known locally.
+         */
+        void update(const Order& snapshot) {
+            auto closeOrderId = close_order_id;
+            auto lastTradeId = last_trade_id;
+            auto syncedAt = synced_at;
+            *this = snapshot;
+            close_order_id = closeOrderId;
+            last_trade_id = lastTradeId;
+            synced_at = syncedAt;
+        }
 
     private:
         template<typename> friend class Response;
 
         template<typename T>
         std::pair<int, std::string> fromJSON(const T& parser) {
-            parser.get<std::string>("id", id);
-            parser.get<std::string>("created_at", created_at);
-            parser.get<std::string>("product_id", product_id);
-            parser.get<std::string>("stp", stp);
-            parser.get<double>("price", price);
-            parser.get<double>("size", size);
-            type = to_orderType(parser.get<std::string>("type"));
-            side = to_orderSide(parser.get<std::string>("side"));
-            if (parser.json.HasMember("time_in_force")) {
-                tif = to_timeInForce(parser.get<std::string>("time_in_force"));
-            }
-            parser.get<double>("filled_size", filled_size);
-            parser.get<double>("fill_fees", fill_fees);
-            parser.get<double>("executed_value", executed_value);
-            parser.get<std::string>("status", status);
-            parser.get<bool>("post_only", post_only);
-            parser.get<bool>("settled", settled);
-            if (filled_size) {
-                filled_price = executed_value / filled_size;
+            type = OrderType::Market;
+            side = OrderSide::Sell;
+            parser.forEach([this](uint64_t field, const auto& value) {
+                switch (field) {
+                case "id"_field: readJson(value, id); break;
+                case "created_at"_field: readTimestamp(value, created_at); break;
+                case "product_id"_field: readJson(value, product_id); break;
+                case "stp"_field: readJson(value, stp); break;
+                case "price"_field: readJson(value, price); break;
+                case "size"_field: readJson(value, size); break;
+                case "type"_field: readJson(value, type); break;
+                case "side"_field: readJson(value, side); break;
+                case "time_in_force"_field: readJson(value, tif); break;
+                case "filled_size"_field: readJson(value, filled_size); break;
+                case "fill_fees"_field: readJson(value, fill_fees); break;
+                case "executed_value"_field: readJson(value, executed_value); break;
+                case "status"_field: readJson(value, status); break;
+                case "post_only"_field: readJson(value, post_only); break;
+                case "settled"_field: readJson(value, settled); break;
+                }
+            });
+            if (!filled_size.isZero()) {
+                filled_price = executed_value.toDouble() / filled_size.toDouble();
             }
             return std::make_pair(0, "OK");
         }
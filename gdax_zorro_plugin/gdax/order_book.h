@@ -0,0 +1,74 @@
+#pragma once
+
+#include <functional>
+#include <map>
+
+#include "gdax/decimal.h"
+#include "gdax/order.h"
+
+namespace gdax {
+
+    /**
+     * @brief Aggregated price levels of a product, as sent by the level2 channel. Websocket thread only.
+     *
+     * The book is built from a snapshot and kept up to date by the l2update messages. Only the best bid
+     * and ask are read from it.
+     */
+    class OrderBook {
+    public:
+        /**
+         * @brief Drop all levels. The book is out of sync until the next snapshot.
+         */
+        void clear() noexcept {
+            bids_.clear();
+            asks_.clear();
+            synced_ = false;
+        }
+
+        /**
+         * @brief Start over from a snapshot, the levels are set with update().
+         */
+        void reset() noexcept {
+            clear();
+            synced_ = true;
+        }
+
+        /**
+         * @brief Set the size of a price level, a size of 0 removes the level.
+         */
+        void update(OrderSide side, Decimal price, Decimal size) {
+            if (!price.isValid() || !size.isValid()) {
+                return;
+            }
+            if (side == OrderSide::Buy) {
+                set(bids_, price, size);
+            }
+            else {
+                set(asks_, price, size);
+            }
+        }
+
+        bool synced() const noexcept { return synced_; }
+
+        Decimal bestBid() const noexcept { return bids_.empty() ? Decimal::invalid() : bids_.begin()->first; }
+        Decimal bestAsk() const noexcept { return asks_.empty() ? Decimal::invalid() : asks_.begin()->first; }
+
+    private:
+        template<typename M>
+        static void set(M& levels, Decimal price, Decimal size) {
+            if (size.isZero()) {
+                levels.erase(price);
+            }
+            else {
+                levels[price] = size;
+            }
+        }
+
+    private:
+        // best level first
+        std::map<Decimal, Decimal, std::greater<Decimal>> bids_;
+        std::map<Decimal, Decimal> asks_;
+        bool synced_ = false;
+    };
+
+} // namespace gdax
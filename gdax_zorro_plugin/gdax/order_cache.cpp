@@ -0,0 +1,165 @@
+#include "stdafx.h"
+#include "gdax/order_cache.h"
+
+#include "logger.h"
+
+namespace {
+    constexpr size_t s_initialBuckets = 64;
+
+    bool isTerminal(gdax::OrderStatus status) noexcept {
+        return status == gdax::OrderStatus::Done || status == gdax::OrderStatus::Canceled || status == gdax::OrderStatus::Rejected;
+    }
+}
+
+namespace gdax {
+
+    OrderCache::OrderCache()
+        : index_(s_initialBuckets) {
+        archive_.reserve(s_archiveSize);
+    }
+
+    size_t OrderCache::bucketOf(const Uuid& id) const noexcept {
+        auto mask = index_.size() - 1;
+        for (auto i = id.hash() & mask;; i = (i + 1) & mask) {
+            auto& bucket = index_[i];
+            if (bucket.record == s_empty || bucket.key == id) {
+                return i;
+            }
+        }
+    }
+
+    Order* OrderCache::find(const Uuid& id) noexcept {
+        auto& bucket = index_[bucketOf(id)];
+        if (bucket.record != s_empty) {
+            return &records_[bucket.record].order;
+        }
+        for (auto& order : archive_) {
+            if (order.id == id) {
+                return &order;
+            }
+        }
+        return nullptr;
+    }
+
+    Order* OrderCache::insert(const Order& order) {
+        auto i = bucketOf(order.id);
+        if (index_[i].record != s_empty) {
+            auto& record = records_[index_[i].record];
+            record.order.update(order);
+            return &record.order;
+        }
+
+        if ((count_ + 1) * 2 > index_.size()) {
+            grow();
+            i = bucketOf(order.id);
+        }
+
+        uint32_t n;
+        if (!freeRecords_.empty()) {
+            n = freeRecords_.back();
+            freeRecords_.pop_back();
+        }
+        else {
+            n = (uint32_t)records_.size();
+            records_.emplace_back();
+        }
+
+        auto& record = records_[n];
+        record.order = order;
+        record.used = true;
+        record.retained = false;
+        index_[i].key = order.id;
+        index_[i].record = n;
+        ++count_;
+        return &record.order;
+    }
+
+    bool OrderCache::retain(const Uuid& id) noexcept {
+        auto& bucket = index_[bucketOf(id)];
+        if (bucket.record == s_empty) {
+            return false;
+        }
+        records_[bucket.record].retained = true;
+        return true;
+    }
+
+    void OrderCache::release(const Uuid& id) noexcept {
+        auto& bucket = index_[bucketOf(id)];
+        if (bucket.record != s_empty) {
+            records_[bucket.record].retained = false;
+        }
+    }
+
+    size_t OrderCache::trim() {
+        if (count_ < s_trimThreshold) {
+            return 0;
+        }
+
+        // walk the records, not the index: erase shifts buckets backwards, across the end of the table too
+        size_t archived = 0;
+        for (uint32_t n = 0; n < (uint32_t)records_.size(); ++n) {
+            auto& record = records_[n];
+            if (!record.used || record.retained || !isTerminal(record.order.status)) {
+                continue;
+            }
+
+            if (archive_.size() < s_archiveSize) {
+                archive_.push_back(record.order);
+            }
+            else {
+                archive_[archiveNext_] = record.order;
+                archiveNext_ = (archiveNext_ + 1) % s_archiveSize;
+            }
+            erase(bucketOf(record.order.id));
+            record.used = false;
+            freeRecords_.push_back(n);
+            ++archived;
+        }
+
+        LOG_DEBUG("OrderCache: archived %d orders, %d live\n", (int)archived, (int)count_);
+        return archived;
+    }
+
+    void OrderCache::erase(size_t i) noexcept {
+        // backward shift deletion, keeps every probe sequence unbroken without tombstones
+        auto mask = index_.size() - 1;
+        index_[i].record = s_empty;
+        --count_;
+        for (auto j = (i + 1) & mask; index_[j].record != s_empty; j = (j + 1) & mask) {
+            auto home = index_[j].key.hash() & mask;
+            // move j to the hole if its home is not cyclically in (i, j]
+            bool inRange = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if (!inRange) {
+                index_[i] = index_[j];
+                index_[j].record = s_empty;
+                i = j;
+            }
+        }
+    }
+
+    void OrderCache::grow() {
+        std::vector<Bucket> old(index_.size() * 2);
+        old.swap(index_);
+        auto mask = index_.size() - 1;
+        for (auto& bucket : old) {
+            if (bucket.record == s_empty) {
+                continue;
+            }
+            auto i = bucket.key.hash() & mask;
+            while (index_[i].record != s_empty) {
+                i = (i + 1) & mask;
+            }
+            index_[i] = bucket;
+        }
+    }
+
+    void OrderCache::clear() {
+        records_.clear();
+        freeRecords_.clear();
+        index_.assign(s_initialBuckets, Bucket());
+        count_ = 0;
+        archive_.clear();
+        archiveNext_ = 0;
+    }
+
+} // namespace gdax
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "gdax/order.h"
+#include "gdax/uuid.h"
+
+namespace gdax {
+
+    /**
+     * @brief The orders of the session, keyed by their binary id.
+     *
+     * Orders live in fixed-size records which keep their address until the order is archived. The index is
+     * an open-addressing hash table with linear probing from the id to the record.
+     *
+     * The cache is bounded: once it holds s_trimThreshold orders, trim() moves the terminal orders Zorro
+     * does not reference anymore to a small archive ring, where the oldest ones are dropped.
+     */
+    class OrderCache {
+    public:
+        static constexpr size_t s_trimThreshold = 1024;
+        static constexpr size_t s_archiveSize = 256;
+
+        OrderCache();
+
+        OrderCache(const OrderCache&) = delete;
+        OrderCache& operator=(const OrderCache&) = delete;
+
+        /**
+         * @brief Look up a live order, then the archive.
+         */
+        Order* find(const Uuid& id) noexcept;
+
+        /**
+         * @brief Insert the order, or update the cached order with the same id, see Order::update().
+         *
+         * @return the cached order.
+         */
+        Order* insert(const Order& order);
+
+        /**
+         * @brief A retained order is never archived. Zorro retains the orders of its open trades.
+         *
+         * @return false if the order is not cached or archived already.
+         */
+        bool retain(const Uuid& id) noexcept;
+        void release(const Uuid& id) noexcept;
+
+        /**
+         * @brief Archive terminal orders which are not retained, once the cache is over the threshold.
+         *
+         * Pointers to archived orders are invalidated, so this must only be called between requests of Zorro.
+         *
+         * @return number of archived orders.
+         */
+        size_t trim();
+
+        /**
+         * @brief Call f for every live order.
+         */
+        template<typename F>
+        void forEach(F&& f) {
+            for (auto& record : records_) {
+                if (record.used) {
+                    f(record.order);
+                }
+            }
+        }
+
+        size_t size() const noexcept { return count_; }
+
+        void clear();
+
+    private:
+        struct Record {
+            Order order;
+            bool used = false;
+            bool retained = false;
+        };
+
+        struct Bucket {
+            Uuid key;
+            uint32_t record = s_empty;
+        };
+
+        static constexpr uint32_t s_empty = UINT32_MAX;
+
+        size_t bucketOf(const Uuid& id) const noexcept;
+        void erase(size_t bucket) noexcept;
+        void grow();
+
+    private:
+        // a deque keeps the records in place when it grows
+        std::deque<Record> records_;
+        std::vector<uint32_t> freeRecords_;
+        // power of two size, at most half full
+        std::vector<Bucket> index_;
+        size_t count_ = 0;
+
+        std::vector<Order> archive_;
+        size_t archiveNext_ = 0;
+    };
+
+} // namespace gdax
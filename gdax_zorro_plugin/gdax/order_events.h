@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gdax/decimal.h"
+#include "gdax/feed.h"
+#include "gdax/order.h"
+#include "gdax/uuid.h"
+
+namespace gdax {
+
+    /**
+     * @brief A change of one of the account's orders, as pushed by the user channel of the websocket feed.
+     */
+    struct OrderEvent {
+        FeedType type = FeedType::Unknown;
+        Uuid order_id;
+        // match only, order_id is the maker order. One of them, or both, are ours.
+        Uuid taker_order_id;
+        // match only, increasing per product
+        uint64_t trade_id = 0;
+        Decimal price = Decimal::invalid();
+        // matched size of a match, new size of a change
+        Decimal size = Decimal::invalid();
+        Decimal maker_fee_rate = Decimal::invalid();
+        Decimal taker_fee_rate = Decimal::invalid();
+        // done with reason "canceled"
+        bool canceled = false;
+        int64_t time = 0;
+
+        static OrderEvent fromFeed(const FeedOrder& msg) {
+            OrderEvent event;
+            event.type = msg.type;
+            event.order_id = msg.order_id;
+            event.price = msg.price;
+            event.size = msg.new_size;
+            event.canceled = msg.reason == "canceled";
+            event.time = msg.time;
+            return event;
+        }
+
+        static OrderEvent fromFeed(const FeedMatch& msg) {
+            OrderEvent event;
+            event.type = FeedType::Match;
+            event.order_id = msg.maker_order_id;
+            event.taker_order_id = msg.taker_order_id;
+            event.trade_id = msg.trade_id;
+            event.price = msg.price;
+            event.size = msg.size;
+            event.maker_fee_rate = msg.maker_fee_rate;
+            event.taker_fee_rate = msg.taker_fee_rate;
+            event.time = msg.time;
+            return event;
+        }
+    };
+
+    /**
+     * @brief Apply an event to the cached state of the order. A terminal order is not reopened, nor changed.
+     *
+     * A match is applied once: matches up to the last applied trade id, or older than the last resync of the
+     * order, are skipped. So is a match which would fill more than the order's size, its fill is in a REST
+     * snapshot of the order already.
+     */
+    inline void applyOrderEvent(Order& order, const OrderEvent& event) {
+        bool terminal = order.status == OrderStatus::Done || order.status == OrderStatus::Canceled || order.status == OrderStatus::Rejected;
+        switch (event.type) {
+        case FeedType::Received:
+            if (order.status == OrderStatus::Unknown) {
+                order.status = OrderStatus::Pending;
+            }
+            break;
+        case FeedType::Open:
+            if (!terminal) {
+                order.status = OrderStatus::Open;
+            }
+            break;
+        case FeedType::Activate:
+            if (!terminal) {
+                order.status = OrderStatus::Active;
+            }
+            break;
+        case FeedType::Change:
+            if (!terminal && event.size.isValid()) {
+                order.size = event.size;
+            }
+            break;
+        case FeedType::Match: {
+            if (terminal || !event.size.isValid() || !event.price.isValid()) {
+                break;
+            }
+            if (event.time && event.time <= order.synced_at) {
+                break;
+            }
+            if (event.trade_id && event.trade_id <= order.last_trade_id) {
+                break;
+            }
+            if (!order.size.isZero() && order.filled_size + event.size > order.size) {
+                break;
+            }
+            if (event.trade_id) {
+                order.last_trade_id = event.trade_id;
+            }
+            auto value = event.price.toDouble() * event.size.toDouble();
+            auto& feeRate = order.id == event.taker_order_id ? event.taker_fee_rate : event.maker_fee_rate;
+            order.filled_size += event.size;
+            order.executed_value += Decimal::fromDouble(value);
+            if (feeRate.isValid()) {
+                order.fill_fees += Decimal::fromDouble(value * feeRate.toDouble());
+            }
+            order.filled_price = order.executed_value.toDouble() / order.filled_size.toDouble();
+            break;
+        }
+        case FeedType::Done:
+            order.status = event.canceled ? OrderStatus::Canceled : OrderStatus::Done;
+            break;
+        default:
+            break;
+        }
+    }
+
+    /**
+     * @brief Order events handed from the websocket thread to the Zorro thread.
+     *
+     * The queue is live for the products the user channel is subscribed to, the orders of other products are
+     * polled. Every time a product becomes live, and when events had to be dropped, the generation changes:
+     * events may have been missed and the consumer resyncs its orders over REST.
+     */
+    class OrderEventQueue {
+    public:
+        static constexpr size_t s_capacity = 4096;
+
+        OrderEventQueue() {
+            events_.reserve(s_capacity);
+            draining_.reserve(s_capacity);
+        }
+
+        OrderEventQueue(const OrderEventQueue&) = delete;
+        OrderEventQueue& operator=(const OrderEventQueue&) = delete;
+
+        void push(const OrderEvent& event) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (events_.size() == s_capacity) {
+                    events_.clear();
+                    ++generation_;
+                }
+                events_.push_back(event);
+            }
+            cv_.notify_all();
+        }
+
+        /**
+         * @brief Call f for every queued event, in order. f runs outside of the lock.
+         *
+         * @return number of events.
+         */
+        template<typename F>
+        size_t drain(F&& f) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                draining_.swap(events_);
+            }
+            for (auto& event : draining_) {
+                f(event);
+            }
+            auto n = draining_.size();
+            draining_.clear();
+            return n;
+        }
+
+        /**
+         * @brief Wait for an event, or the timeout.
+         *
+         * @return true if there are events to drain.
+         */
+        bool wait(uint32_t timeout_ms) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return !events_.empty() || products_.empty(); }) && !events_.empty();
+        }
+
+        /**
+         * @brief Set the products the user channel is subscribed to, none once the feed is down.
+         */
+        void setProducts(std::vector<std::string> products) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (auto& product : products) {
+                    if (std::find(products_.begin(), products_.end(), product) == products_.end()) {
+                        ++generation_;
+                        break;
+                    }
+                }
+                products_.swap(products);
+            }
+            cv_.notify_all();
+        }
+
+        /**
+         * @return true if the user channel is subscribed to any product.
+         */
+        bool live() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return !products_.empty();
+        }
+
+        bool live(const InlineString<15>& product_id) const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return std::find_if(products_.begin(), products_.end(), [&product_id](const std::string& product) { return product_id == product; }) != products_.end();
+        }
+
+        uint32_t generation() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return generation_;
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            events_.clear();
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::vector<OrderEvent> events_;
+        // only used by the consumer
+        std::vector<OrderEvent> draining_;
+        std::vector<std::string> products_;
+        uint32_t generation_ = 0;
+    };
+
+} // namespace gdax
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "gdax/decimal.h"
+#include "gdax/order.h"
+#include "gdax/product.h"
+
+namespace gdax {
+
+    /**
+     * @brief Precompiled JSON body of the orders of one product.
+     *
+     * The product id and stp parts of the body are serialized once. The per order fields are fixed
+     * fragments picked by enum, prices and sizes are formatted from Decimal at the product increments.
+     */
+    class OrderTemplate {
+    public:
+        static constexpr size_t s_maxBodySize = 512;
+
+        OrderTemplate(const Product& product, const std::string& stp)
+            : quoteIncrement_(product.quote_increment)
+            , baseIncrement_(product.base_increment)
+            , priceDecimals_(product.quote_increment.decimals())
+            , sizeDecimals_(product.base_increment.decimals())
+        {
+            // {"product_id":"BTC-USD"  with escaping done by the writer
+            rapidjson::StringBuffer s;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+            writer.StartObject();
+            writer.Key("product_id");
+            writer.String(product.id.c_str(), (rapidjson::SizeType)product.id.size());
+            writer.EndObject();
+            head_.assign(s.GetString(), s.GetSize() - 1);
+
+            if (!stp.empty()) {
+                s.Clear();
+                rapidjson::Writer<rapidjson::StringBuffer> stpWriter(s);
+                stpWriter.String(stp.c_str(), (rapidjson::SizeType)stp.size());
+                stp_.assign(",\"stp\":").append(s.GetString(), s.GetSize());
+            }
+        }
+
+        /**
+         * @brief Write the order body into the buffer of the calling thread.
+         *
+         * @return the null-terminated body, valid until the next call on the thread.
+         */
+        const char* build(OrderSide side, OrderType type, TimeInForce tif, double lots, double limit_price, double stop_price, bool post_only, size_t& length) const {
+            static thread_local char s_body[s_maxBodySize];
+            char* p = s_body;
+
+            p = append(p, head_.c_str(), head_.size());
+            p = side == OrderSide::Buy ? append(p, ",\"side\":\"buy\"") : append(p, ",\"side\":\"sell\"");
+            p = type == OrderType::Limit ? append(p, ",\"type\":\"limit\"") : append(p, ",\"type\":\"market\"");
+            p = append(p, stp_.c_str(), stp_.size());
+
+            if (type == OrderType::Limit) {
+                p = append(p, ",\"time_in_force\":\"");
+                p = append(p, to_string(tif), 3);
+
+                // buy at or below the limit, sell at or above it
+                auto price = Decimal::fromDouble(limit_price);
+                price = side == OrderSide::Buy ? price.floorToTick(quoteIncrement_) : price.ceilToTick(quoteIncrement_);
+                p = append(p, "\",\"price\":\"");
+                p += price.format(p, priceDecimals_);
+
+                if (stop_price) {
+                    auto stop = Decimal::fromDouble(stop_price).roundToTick(quoteIncrement_);
+                    p = append(p, "\",\"stop_price\":\"");
+                    p += stop.format(p, priceDecimals_);
+                    p = append(p, "\",\"stop\":\"loss");
+                }
+                p = append(p, "\"");
+
+                if (tif != TimeInForce::FOK && tif != TimeInForce::IOC) {
+                    p = post_only ? append(p, ",\"post_only\":true") : append(p, ",\"post_only\":false");
+                }
+            }
+
+            auto size = Decimal::fromDouble(lots).roundToTick(baseIncrement_);
+            p = append(p, ",\"size\":\"");
+            p += size.format(p, sizeDecimals_);
+            p = append(p, "\"}");
+            *p = 0;
+
+            length = p - s_body;
+            return s_body;
+        }
+
+    private:
+        template<size_t N>
+        static char* append(char* p, const char(&s)[N]) {
+            memcpy(p, s, N - 1);
+            return p + N - 1;
+        }
+
+        static char* append(char* p, const char* s, size_t len) {
+            memcpy(p, s, len);
+            return p + len;
+        }
+
+    private:
+        std::string head_;
+        std::string stp_;
+        Decimal quoteIncrement_;
+        Decimal baseIncrement_;
+        int32_t priceDecimals_;
+        int32_t sizeDecimals_;
+    };
+
+} // namespace gdax
@@ -3,22 +3,25 @@
 #include <string>
 #include <cassert>
 #include <unordered_map>
+#include "gdax/json.h"
+#include "gdax/inline_string.h"
 
 namespace gdax {
 
 	struct Product {
-		std::string id;
-		std::string display_name;
-		std::string status;
-		std::string status_message;
-		std::string base_currency;
-		std::string quote_currency;
-		double base_increment;
-		double quote_increment;
-		double base_min_size;
-		double base_max_size;
-		double min_market_funds;
-		double max_market_funds;
+		InlineString<15> id;
+		InlineString<15> display_name;
+		InlineString<15> status;
+		InlineString<15> status_message;
+		InlineString<15> base_currency;
+		InlineString<15> quote_currency;
+		Decimal base_increment;
+		Decimal quote_increment;
+		Decimal base_min_size;
+		// the max sizes may exceed the range of Decimal
+		double base_max_size = 0.;
+		Decimal min_market_funds;
+		double max_market_funds = 0.;
 		bool cancel_only;
 		bool limit_only;
 		bool post_only;
@@ -29,22 +32,26 @@ namespace gdax {
 
 		template<typename T>
 		std::pair<int, std::string> fromJSON(const T& parser) {
-			parser.get<std::string>("id", id);
-			parser.get<std::string>("display_name", display_name);
-			parser.get<std::string>("status", status);
-			parser.get<std::string>("status_message", status_message);
-			parser.get<std::string>("base_currency", base_currency);
-			parser.get<std::string>("quote_currency", quote_currency);
-			parser.get<double>("base_increment", base_increment);
-			parser.get<double>("quote_increment", quote_increment);
-            parser.get<double>("base_min_size", base_min_size);
-            parser.get<double>("base_max_size", base_max_size);
-            parser.get<double>("min_market_funds", min_market_funds);
-            parser.get<double>("max_market_funds", max_market_funds);
-			parser.get<bool>("cancel_only", cancel_only);
-			parser.get<bool>("limit_only", limit_only);
-			parser.get<bool>("post_only", post_only);
-			parser.get<bool>("trading_disabled", trading_disabled);
+			parser.forEach([this](uint64_t field, const auto& value) {
+				switch (field) {
+				case "id"_field: readJson(value, id); break;
+				case "display_name"_field: readJson(value, display_name); break;
+				case "status"_field: readJson(value, status); break;
+				case "status_message"_field: readJson(value, status_message); break;
+				case "base_currency"_field: readJson(value, base_currency); break;
+				case "quote_currency"_field: readJson(value, quote_currency); break;
+				case "base_increment"_field: readJson(value, base_increment); break;
+				case "quote_increment"_field: readJson(value, quote_increment); break;
+				case "base_min_size"_field: readJson(value, base_min_size); break;
+				case "base_max_size"_field: readJson(value, base_max_size); break;
+				case "min_market_funds"_field: readJson(value, min_market_funds); break;
+				case "max_market_funds"_field: readJson(value, max_market_funds); break;
+				case "cancel_only"_field: readJson(value, cancel_only); break;
+				case "limit_only"_field: readJson(value, limit_only); break;
+				case "post_only"_field: readJson(value, post_only); break;
+				case "trading_disabled"_field: readJson(value, trading_disabled); break;
+				}
+			});
 			return std::make_pair(0, "OK");
 		}
 	};
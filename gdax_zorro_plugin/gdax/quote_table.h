@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+namespace gdax {
+
+    /**
+     * @brief Best bid/ask and last trade of a product, as seen on the websocket feed.
+     */
+    struct Quote {
+        double bid = NAN;
+        double ask = NAN;
+        double price = NAN;
+        double volume = 0.;
+    };
+
+    /**
+     * @brief Fixed capacity quote table shared by one writer (websocket thread) and readers (Zorro thread).
+     *
+     * Every product owns a dense slot. A slot is guarded by a seqlock, writer never blocks and
+     * a read is a handful of atomic loads, retried only if it overlapped with an update.
+     */
+    class QuoteTable {
+    public:
+        static constexpr uint32_t capacity = 256;
+        static constexpr uint32_t invalid_slot = UINT32_MAX;
+        static constexpr size_t max_symbol_len = 31;
+
+        QuoteTable() = default;
+        QuoteTable(const QuoteTable&) = delete;
+        QuoteTable& operator=(const QuoteTable&) = delete;
+
+        /**
+         * @brief Allocate a slot for a product. Called by the reader thread only.
+         *
+         * @return the slot, or invalid_slot if the table is full.
+         */
+        uint32_t add(const char* symbol) noexcept {
+            auto len = strlen(symbol);
+            auto n = size_.load(std::memory_order_relaxed);
+            if (n == capacity || len > max_symbol_len) {
+                return invalid_slot;
+            }
+            auto& name = names_[n];
+            memcpy(name.symbol, symbol, len + 1);
+            name.len = (uint32_t)len;
+            // publish the symbol to the writer
+            size_.store(n + 1, std::memory_order_release);
+            return n;
+        }
+
+        /**
+         * @brief Find the slot of a product. Called by the writer thread.
+         */
+        uint32_t find(const char* symbol, size_t len) const noexcept {
+            auto n = size_.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < n; ++i) {
+                auto& name = names_[i];
+                if (name.len == len && memcmp(name.symbol, symbol, len) == 0) {
+                    return i;
+                }
+            }
+            return invalid_slot;
+        }
+
+        uint32_t size() const noexcept {
+            return size_.load(std::memory_order_acquire);
+        }
+
+        const char* symbol(uint32_t slot) const noexcept {
+            return names_[slot].symbol;
+        }
+
+        /**
+         * @brief Update a slot. NAN fields keep their previous value. Writer thread only.
+         */
+        void update(uint32_t slot, double bid, double ask, double price, double volume) noexcept {
+            auto& entry = entries_[slot];
+            auto seq = entry.seq.load(std::memory_order_relaxed);
+            entry.seq.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            if (!std::isnan(bid)) {
+                entry.bid.store(bid, std::memory_order_relaxed);
+            }
+            if (!std::isnan(ask)) {
+                entry.ask.store(ask, std::memory_order_relaxed);
+            }
+            if (!std::isnan(price)) {
+                entry.price.store(price, std::memory_order_relaxed);
+            }
+            if (!std::isnan(volume)) {
+                entry.volume.store(volume, std::memory_order_relaxed);
+            }
+            entry.seq.store(seq + 2, std::memory_order_release);
+        }
+
+        /**
+         * @brief Invalidate all slots, i.e. the feed is down. Writer thread only.
+         */
+        void invalidate() noexcept {
+            auto n = size_.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < n; ++i) {
+                auto& entry = entries_[i];
+                auto seq = entry.seq.load(std::memory_order_relaxed);
+                entry.seq.store(seq + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                entry.bid.store(NAN, std::memory_order_relaxed);
+                entry.ask.store(NAN, std::memory_order_relaxed);
+                entry.price.store(NAN, std::memory_order_relaxed);
+                entry.volume.store(0., std::memory_order_relaxed);
+                entry.seq.store(seq + 2, std::memory_order_release);
+            }
+        }
+
+        /**
+         * @brief Remove all products. Must not be called while the writer is running.
+         */
+        void clear() noexcept {
+            invalidate();
+            size_.store(0, std::memory_order_release);
+        }
+
+        /**
+         * @brief Read a consistent snapshot of a slot.
+         *
+         * @return false if no quote has been received for the slot.
+         */
+        bool read(uint32_t slot, Quote& quote) const noexcept {
+            auto& entry = entries_[slot];
+            uint32_t seq0, seq1;
+            do {
+                seq0 = entry.seq.load(std::memory_order_acquire);
+                while (seq0 & 1) {
+                    seq0 = entry.seq.load(std::memory_order_acquire);
+                }
+                quote.bid = entry.bid.load(std::memory_order_relaxed);
+                quote.ask = entry.ask.load(std::memory_order_relaxed);
+                quote.price = entry.price.load(std::memory_order_relaxed);
+                quote.volume = entry.volume.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                seq1 = entry.seq.load(std::memory_order_relaxed);
+            } while (seq0 != seq1);
+            return !std::isnan(quote.bid) || !std::isnan(quote.ask) || !std::isnan(quote.price);
+        }
+
+    private:
+        struct alignas(64) Entry {
+            std::atomic<uint32_t> seq{ 0 };
+            std::atomic<double> bid{ NAN };
+            std::atomic<double> ask{ NAN };
+            std::atomic<double> price{ NAN };
+            std::atomic<double> volume{ 0. };
+        };
+
+        struct Name {
+            char symbol[max_symbol_len + 1];
+            uint32_t len;
+        };
+
+        Entry entries_[capacity];
+        Name names_[capacity];
+        alignas(64) std::atomic<uint32_t> size_{ 0 };
+    };
+
+} // namespace gdax
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "cryptopp/sha.h"
+#include "cryptopp/base64.h"
+#include "cryptopp/filters.h"
+
+namespace gdax {
+
+    /**
+     * @brief HMAC-SHA256 keyed once.
+     *
+     * setKey() absorbs the inner and outer key pads into two SHA256 states. Every message starts from
+     * copies of these states, so signing does not re-key and does not allocate.
+     */
+    class HmacSigner {
+    public:
+        static constexpr size_t s_digestSize = CryptoPP::SHA256::DIGESTSIZE;
+        static constexpr size_t s_blockSize = CryptoPP::SHA256::BLOCKSIZE;
+        // base64 of the digest, without the terminating null
+        static constexpr size_t s_base64Size = (s_digestSize + 2) / 3 * 4;
+
+        void setKey(const uint8_t* key, size_t len) {
+            uint8_t block[s_blockSize] = { 0 };
+            if (len > s_blockSize) {
+                CryptoPP::SHA256().CalculateDigest(block, key, len);
+            }
+            else {
+                memcpy(block, key, len);
+            }
+
+            uint8_t pad[s_blockSize];
+            for (size_t i = 0; i < s_blockSize; ++i) {
+                pad[i] = block[i] ^ 0x36;
+            }
+            inner_.Restart();
+            inner_.Update(pad, s_blockSize);
+
+            for (size_t i = 0; i < s_blockSize; ++i) {
+                pad[i] = block[i] ^ 0x5c;
+            }
+            outer_.Restart();
+            outer_.Update(pad, s_blockSize);
+
+            memset(block, 0, sizeof(block));
+            memset(pad, 0, sizeof(pad));
+        }
+
+        /**
+         * @brief Key with a base64 encoded secret, as issued by Coinbase.
+         *
+         * @throw CryptoPP::Exception if the secret can not be decoded.
+         */
+        void setBase64Key(const std::string& secret) {
+            std::string decoded;
+            CryptoPP::StringSource(secret, true, new CryptoPP::Base64Decoder(new CryptoPP::StringSink(decoded)));
+            setKey((const uint8_t*)decoded.data(), decoded.size());
+            std::fill(decoded.begin(), decoded.end(), '\0');
+        }
+
+        /**
+         * @brief The MAC of one message, fed in parts.
+         */
+        class Message {
+        public:
+            explicit Message(const HmacSigner& signer) : inner_(signer.inner_), outer_(signer.outer_) {}
+
+            Message& update(const char* data, size_t len) {
+                inner_.Update((const CryptoPP::byte*)data, len);
+                return *this;
+            }
+
+            /**
+             * @brief Finish the MAC and write it base64 encoded.
+             *
+             * @param out at least s_base64Size + 1 chars, null-terminated on return.
+             */
+            void finalBase64(char* out) {
+                uint8_t digest[s_digestSize];
+                inner_.Final(digest);
+                outer_.Update(digest, s_digestSize);
+                outer_.Final(digest);
+                encodeBase64(digest, s_digestSize, out);
+            }
+
+        private:
+            CryptoPP::SHA256 inner_;
+            CryptoPP::SHA256 outer_;
+        };
+
+    private:
+        static void encodeBase64(const uint8_t* data, size_t len, char* out) {
+            static const char s_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            size_t i = 0;
+            for (; i + 3 <= len; i += 3) {
+                uint32_t v = (uint32_t)data[i] << 16 | (uint32_t)data[i + 1] << 8 | data[i + 2];
+                *out++ = s_alphabet[v >> 18];
+                *out++ = s_alphabet[(v >> 12) & 0x3f];
+                *out++ = s_alphabet[(v >> 6) & 0x3f];
+                *out++ = s_alphabet[v & 0x3f];
+            }
+            if (i < len) {
+                uint32_t v = (uint32_t)data[i] << 16;
+                if (i + 1 < len) {
+                    v |= (uint32_t)data[i + 1] << 8;
+                }
+                *out++ = s_alphabet[v >> 18];
+                *out++ = s_alphabet[(v >> 12) & 0x3f];
+                *out++ = i + 1 < len ? s_alphabet[(v >> 6) & 0x3f] : '=';
+                *out++ = '=';
+            }
+            *out = 0;
+        }
+
+    private:
+        CryptoPP::SHA256 inner_;
+        CryptoPP::SHA256 outer_;
+    };
+
+} // namespace gdax
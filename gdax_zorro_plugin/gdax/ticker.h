@@ -2,17 +2,20 @@
 
 #include <string>
 #include "rapidjson/document.h"
+#include "gdax/json.h"
+#include "gdax/timestamp.h"
 
 namespace gdax {
 
     struct Ticker {
         uint64_t trade_id = 0;
-        double price = NAN;
-        double size = 0;
-        double bid = NAN;
-        double ask = NAN;
-        double volume = 0;
-        std::string time;
+        Decimal price = Decimal::invalid();
+        Decimal size;
+        Decimal bid = Decimal::invalid();
+        Decimal ask = Decimal::invalid();
+        // may exceed the range of Decimal
+        double volume = 0.;
+        int64_t time = 0;           // nanoseconds since epoch
 
     private:
         template <typename>
@@ -20,13 +23,17 @@ namespace gdax {
 
         template <typename T>
         std::pair<int, std::string> fromJSON(const T& parser) {
-            parser.get<uint64_t>("trade_id", trade_id);
-            parser.get<double>("price", price);
-            parser.get<double>("size", size);
-            parser.get<double>("ask", ask);
-            parser.get<double>("bid", bid);
-            parser.get<double>("volume", volume);
-            parser.get<std::string>("time", time);
+            parser.forEach([this](uint64_t field, const auto& value) {
+                switch (field) {
+                case "trade_id"_field: readJson(value, trade_id); break;
+                case "price"_field: readJson(value, price); break;
+                case "size"_field: readJson(value, size); break;
+                case "ask"_field: readJson(value, ask); break;
+                case "bid"_field: readJson(value, bid); break;
+                case "volume"_field: readJson(value, volume); break;
+                case "time"_field: readTimestamp(value, time); break;
+                }
+            });
             return std::make_pair(0, "OK");
         }
     };
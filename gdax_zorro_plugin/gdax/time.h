@@ -2,6 +2,7 @@
 
 #include <string>
 #include <cstdint>
+#include "gdax/json.h"
 
 namespace gdax {
 
@@ -14,9 +15,13 @@ namespace gdax {
 
 		template<typename T>
 		std::pair<int, std::string> fromJSON(const T& parser) {
-			parser.get<std::string>("iso", iso);
-			double epoch_time;
-			parser.get<double>("epoch", epoch_time);
+			double epoch_time = 0;
+			parser.forEach([this, &epoch_time](uint64_t field, const auto& value) {
+				switch (field) {
+				case "iso"_field: readJson(value, iso); break;
+				case "epoch"_field: readJson(value, epoch_time); break;
+				}
+			});
 			epoch = (uint64_t)(epoch_time * 1000);
 			return std::make_pair(0, "OK");
 		}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace gdax {
+
+    constexpr int64_t s_nanosPerSecond = 1000000000;
+    constexpr int64_t s_secondsPerDay = 86400;
+
+    namespace timestamp {
+        // Days since 1970-01-01 of a proleptic Gregorian date, and back. H. Hinnant's days_from_civil.
+        constexpr int64_t daysFromCivil(int64_t y, uint32_t m, uint32_t d) noexcept {
+            y -= m <= 2;
+            const int64_t era = (y >= 0 ? y : y - 399) / 400;
+            const uint32_t yoe = (uint32_t)(y - era * 400);
+            const uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+            const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + (int64_t)doe - 719468;
+        }
+
+        inline void civilFromDays(int64_t z, int64_t& y, uint32_t& m, uint32_t& d) noexcept {
+            z += 719468;
+            const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+            const uint32_t doe = (uint32_t)(z - era * 146097);
+            const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const uint32_t mp = (5 * doy + 2) / 153;
+            d = doy - (153 * mp + 2) / 5 + 1;
+            m = mp < 10 ? mp + 3 : mp - 9;
+            y = (int64_t)yoe + era * 400 + (m <= 2);
+        }
+
+        inline uint32_t digit(char c) noexcept { return (uint32_t)(uint8_t)(c - '0'); }
+        inline bool isDigit(char c) noexcept { return digit(c) < 10; }
+
+        inline char* write2(char* p, uint32_t v) noexcept {
+            p[0] = (char)('0' + v / 10);
+            p[1] = (char)('0' + v % 10);
+            return p + 2;
+        }
+    }
+
+    /**
+     * @brief Parse an ISO-8601 UTC timestamp such as "2019-08-14T20:42:27.265123Z" to nanoseconds since epoch.
+     *
+     * The date and time have fixed positions, so the digits are read without a loop and validated at once.
+     * A space is accepted instead of 'T', up to 9 fraction digits are kept and the suffix can be 'Z', an
+     * offset such as "+00:00" or missing.
+     *
+     * @return false if the string is not such a timestamp.
+     */
+    inline bool parseTimestamp(const char* s, size_t len, int64_t& nanos) noexcept {
+        using timestamp::digit;
+        if (len < 19) {
+            return false;
+        }
+
+        using timestamp::isDigit;
+        bool digits = isDigit(s[0]) & isDigit(s[1]) & isDigit(s[2]) & isDigit(s[3]) & isDigit(s[5]) & isDigit(s[6]) & isDigit(s[8]) &
+            isDigit(s[9]) & isDigit(s[11]) & isDigit(s[12]) & isDigit(s[14]) & isDigit(s[15]) & isDigit(s[17]) & isDigit(s[18]);
+        if (!digits || s[4] != '-' || s[7] != '-' || (s[10] != 'T' && s[10] != ' ') || s[13] != ':' || s[16] != ':') {
+            return false;
+        }
+
+        const int64_t year = digit(s[0]) * 1000 + digit(s[1]) * 100 + digit(s[2]) * 10 + digit(s[3]);
+        const uint32_t month = digit(s[5]) * 10 + digit(s[6]);
+        const uint32_t day = digit(s[8]) * 10 + digit(s[9]);
+        const uint32_t hour = digit(s[11]) * 10 + digit(s[12]);
+        const uint32_t minute = digit(s[14]) * 10 + digit(s[15]);
+        const uint32_t second = digit(s[17]) * 10 + digit(s[18]);
+        if (month - 1 > 11 || day - 1 > 30 || hour > 23 || minute > 59 || second > 60) {
+            return false;
+        }
+
+        size_t i = 19;
+        int64_t fraction = 0;
+        if (i < len && s[i] == '.') {
+            static const int64_t s_scale[] = { 1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1 };
+            int32_t n = 0;
+            for (++i; i < len && isDigit(s[i]); ++i) {
+                if (n < 9) {
+                    fraction = fraction * 10 + digit(s[i]);
+                    ++n;
+                }
+            }
+            fraction *= s_scale[n];
+        }
+
+        int64_t offset = 0;
+        if (i < len) {
+            if (s[i] == 'Z' && i + 1 == len) {
+                ++i;
+            }
+            else if ((s[i] == '+' || s[i] == '-') && i + 6 == len && s[i + 3] == ':' &&
+                (isDigit(s[i + 1]) & isDigit(s[i + 2]) & isDigit(s[i + 4]) & isDigit(s[i + 5]))) {
+                offset = ((digit(s[i + 1]) * 10 + digit(s[i + 2])) * 3600 + (digit(s[i + 4]) * 10 + digit(s[i + 5])) * 60);
+                offset = s[i] == '+' ? -offset : offset;
+                i += 6;
+            }
+            else {
+                return false;
+            }
+        }
+
+        const int64_t seconds = timestamp::daysFromCivil(year, month, day) * s_secondsPerDay + hour * 3600 + minute * 60 + second + offset;
+        nanos = seconds * s_nanosPerSecond + fraction;
+        return true;
+    }
+
+    /**
+     * @brief Write a timestamp as "YYYY-MM-DDTHH:MM:SS[.fraction]Z".
+     *
+     * @param buf at least 32 bytes.
+     * @param decimals number of fraction digits, 0 to 9.
+     * @return length of the null-terminated string.
+     */
+    inline size_t formatTimestamp(int64_t nanos, char* buf, int32_t decimals = 6) noexcept {
+        using timestamp::write2;
+        // floor division, so times before 1970 have a positive fraction
+        int64_t seconds = nanos / s_nanosPerSecond;
+        int64_t fraction = nanos % s_nanosPerSecond;
+        if (fraction < 0) {
+            fraction += s_nanosPerSecond;
+            --seconds;
+        }
+        int64_t days = seconds / s_secondsPerDay;
+        int64_t secondOfDay = seconds % s_secondsPerDay;
+        if (secondOfDay < 0) {
+            secondOfDay += s_secondsPerDay;
+            --days;
+        }
+
+        int64_t year;
+        uint32_t month, day;
+        timestamp::civilFromDays(days, year, month, day);
+
+        char* p = buf;
+        const uint32_t y = (uint32_t)(year < 0 ? 0 : year > 9999 ? 9999 : year);
+        p = write2(p, y / 100);
+        p = write2(p, y % 100);
+        *p++ = '-';
+        p = write2(p, month);
+        *p++ = '-';
+        p = write2(p, day);
+        *p++ = 'T';
+        p = write2(p, (uint32_t)(secondOfDay / 3600));
+        *p++ = ':';
+        p = write2(p, (uint32_t)(secondOfDay / 60 % 60));
+        *p++ = ':';
+        p = write2(p, (uint32_t)(secondOfDay % 60));
+
+        if (decimals > 0) {
+            if (decimals > 9) {
+                decimals = 9;
+            }
+            *p++ = '.';
+            for (int32_t i = 9; i > decimals; --i) {
+                fraction /= 10;
+            }
+            for (int32_t i = decimals - 1; i >= 0; --i) {
+                p[i] = (char)('0' + fraction % 10);
+                fraction /= 10;
+            }
+            p += decimals;
+        }
+        *p++ = 'Z';
+        *p = 0;
+        return p - buf;
+    }
+
+    /**
+     * @brief JSON string member to nanoseconds since epoch, see parseTimestamp().
+     */
+    template<typename V>
+    bool readTimestamp(const V& v, int64_t& nanos) {
+        return v.IsString() && parseTimestamp(v.GetString(), v.GetStringLength(), nanos);
+    }
+
+} // namespace gdax
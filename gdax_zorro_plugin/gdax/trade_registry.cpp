@@ -0,0 +1,185 @@
+#include "stdafx.h"
+#include "gdax/trade_registry.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "logger.h"
+
+namespace {
+    // keeps the ids positive
+    constexpr uint32_t s_maxSequence = (1u << (31 - gdax::TradeRegistry::s_slotBits)) - 1;
+
+    // lines appended before the file is compacted
+    constexpr uint32_t s_maxJournalLines = 4 * gdax::TradeRegistry::s_maxTrades;
+}
+
+namespace gdax {
+
+    TradeRegistry::TradeRegistry(std::string path)
+        : path_(std::move(path)) {
+        slots_.reserve(s_maxTrades);
+    }
+
+    TradeRegistry::~TradeRegistry() {
+        compact();
+    }
+
+    size_t TradeRegistry::load() {
+        FILE* f;
+        if (fopen_s(&f, path_.c_str(), "r")) {
+            return 0;
+        }
+
+        // "<trade id> <order uuid>" for an open trade, "-<trade id>" once it is closed. Later lines win.
+        char line[128];
+        while (fgets(line, sizeof(line), f)) {
+            char* end;
+            auto id = strtol(line, &end, 10);
+            if (end == line || !id) {
+                continue;
+            }
+
+            auto slot = (uint32_t)std::labs(id) & (s_maxTrades - 1);
+            if (id < 0) {
+                if (slot < slots_.size() && slots_[slot].id == -id) {
+                    slots_[slot] = Trade();
+                    --count_;
+                }
+                continue;
+            }
+
+            auto* uuid = end + strspn(end, " ");
+            Uuid order_id;
+            if (!Uuid::parse(uuid, strcspn(uuid, "\r\n"), order_id)) {
+                continue;
+            }
+            if (slot >= slots_.size()) {
+                slots_.resize(slot + 1);
+            }
+            if (slots_[slot].id && slots_[slot].id != id) {
+                LOG_WARNING("Duplicate trade slot %d in %s\n", (int)id, path_.c_str());
+                continue;
+            }
+            if (!slots_[slot].id) {
+                ++count_;
+            }
+            slots_[slot].id = (int32_t)id;
+            slots_[slot].order_id = order_id;
+            sequence_ = std::max(sequence_, (uint32_t)id >> s_slotBits);
+        }
+        fclose(f);
+
+        for (uint32_t slot = (uint32_t)slots_.size(); slot-- > 0;) {
+            if (!slots_[slot].id) {
+                freeSlots_.push_back(slot);
+            }
+        }
+        LOG_INFO("Loaded %d open trades from %s\n", (int)count_, path_.c_str());
+        rewrite();
+        return count_;
+    }
+
+    int32_t TradeRegistry::add(const Uuid& order_id, Order* order) {
+        uint32_t slot;
+        if (!freeSlots_.empty()) {
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        else if (slots_.size() < s_maxTrades) {
+            slot = (uint32_t)slots_.size();
+            slots_.emplace_back();
+        }
+        else {
+            return 0;
+        }
+
+        sequence_ = sequence_ == s_maxSequence ? 1 : sequence_ + 1;
+        auto& trade = slots_[slot];
+        trade.id = (int32_t)(sequence_ << s_slotBits | slot);
+        trade.order_id = order_id;
+        trade.order = order;
+        ++count_;
+        if (!order_id.isNil()) {
+            append(trade.id, &order_id);
+        }
+        return trade.id;
+    }
+
+    void TradeRegistry::setOrder(int32_t id, const Uuid& order_id, Order* order) {
+        auto* trade = find(id);
+        if (!trade) {
+            return;
+        }
+        trade->order_id = order_id;
+        trade->order = order;
+        append(id, &order_id);
+    }
+
+    void TradeRegistry::remove(int32_t id) {
+        auto* trade = find(id);
+        if (!trade) {
+            return;
+        }
+        bool saved = !trade->order_id.isNil();
+        *trade = Trade();
+        freeSlots_.push_back((uint32_t)id & (s_maxTrades - 1));
+        --count_;
+        if (saved) {
+            append(id, nullptr);
+        }
+    }
+
+    void TradeRegistry::append(int32_t id, const Uuid* order_id) {
+        if (journalLines_ >= s_maxJournalLines) {
+            rewrite();
+        }
+        if (!journal_ && fopen_s(&journal_, path_.c_str(), "a")) {
+            journal_ = nullptr;
+            LOG_ERROR("Failed to save open trades to %s\n", path_.c_str());
+            return;
+        }
+        if (order_id) {
+            char uuid[Uuid::s_length + 1];
+            order_id->format(uuid);
+            fprintf(journal_, "%d %s\n", id, uuid);
+        }
+        else {
+            fprintf(journal_, "-%d\n", id);
+        }
+        // a line per change, kept if Zorro is killed
+        fflush(journal_);
+        ++journalLines_;
+    }
+
+    void TradeRegistry::compact() {
+        if (journalLines_) {
+            rewrite();
+        }
+    }
+
+    void TradeRegistry::rewrite() {
+        if (journal_) {
+            fclose(journal_);
+            journal_ = nullptr;
+        }
+        journalLines_ = 0;
+
+        FILE* f;
+        if (fopen_s(&f, path_.c_str(), "w")) {
+            LOG_ERROR("Failed to save open trades to %s\n", path_.c_str());
+            return;
+        }
+        char uuid[Uuid::s_length + 1];
+        for (auto& trade : slots_) {
+            if (trade.id && !trade.order_id.isNil()) {
+                trade.order_id.format(uuid);
+                fprintf(f, "%d %s\n", trade.id, uuid);
+            }
+        }
+        fclose(f);
+    }
+
+} // namespace gdax
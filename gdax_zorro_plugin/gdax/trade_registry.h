@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "gdax/order.h"
+#include "gdax/uuid.h"
+
+namespace gdax {
+
+    /**
+     * @brief An open trade of Zorro.
+     */
+    struct Trade {
+        int32_t id = 0;             // 0 if the slot is free
+        Uuid order_id;              // nil while the order request is in flight
+        // the cached order, retained in the order cache while the trade is open. nullptr until looked up.
+        Order* order = nullptr;
+    };
+
+    /**
+     * @brief Numeric Zorro trade ids of the open trades, mapped to their orders.
+     *
+     * Trades live in a dense array. The low bits of a trade id are the slot in the array and the high bits
+     * a sequence number, so a reused slot gets a new id and a lookup is an index plus a compare.
+     *
+     * The open trades are saved to a small file, Zorro asks for trades opened in an earlier session
+     * after a restart. Trades whose order is not acknowledged yet are not saved. Every change appends a
+     * line to the file, which is rewritten with the open trades only by compact(), on load, on logout and
+     * once it has grown large.
+     */
+    class TradeRegistry {
+    public:
+        static constexpr uint32_t s_slotBits = 10;
+        static constexpr size_t s_maxTrades = 1 << s_slotBits;
+
+        explicit TradeRegistry(std::string path);
+        ~TradeRegistry();
+
+        TradeRegistry(const TradeRegistry&) = delete;
+        TradeRegistry& operator=(const TradeRegistry&) = delete;
+
+        /**
+         * @brief Load the trades saved by an earlier session. Their orders are not looked up yet.
+         *
+         * @return number of trades.
+         */
+        size_t load();
+
+        /**
+         * @brief Rewrite the file with one line per open trade, if it has changed since it was last rewritten.
+         */
+        void compact();
+
+        /**
+         * @return the trade id, 0 if there are s_maxTrades open trades.
+         */
+        int32_t add(const Uuid& order_id, Order* order);
+
+        Trade* find(int32_t id) noexcept {
+            auto slot = (uint32_t)id & (s_maxTrades - 1);
+            if (id <= 0 || slot >= slots_.size() || slots_[slot].id != id) {
+                return nullptr;
+            }
+            return &slots_[slot];
+        }
+
+        /**
+         * @brief Set the order of a trade added before its order request was acknowledged.
+         */
+        void setOrder(int32_t id, const Uuid& order_id, Order* order);
+
+        void remove(int32_t id);
+
+        size_t size() const noexcept { return count_; }
+
+        /**
+         * @brief Call f for every open trade.
+         */
+        template<typename F>
+        void forEach(F&& f) {
+            for (auto& trade : slots_) {
+                if (trade.id) {
+                    f(trade);
+                }
+            }
+        }
+
+    private:
+        /**
+         * @brief Append "<trade id> <order uuid>" for a trade with an order, "-<trade id>" for a removed trade.
+         */
+        void append(int32_t id, const Uuid* order_id);
+        void rewrite();
+
+    private:
+        const std::string path_;
+        FILE* journal_ = nullptr;
+        uint32_t journalLines_ = 0;
+        std::vector<Trade> slots_;
+        std::vector<uint32_t> freeSlots_;
+        uint32_t sequence_ = 0;
+        size_t count_ = 0;
+    };
+
+} // namespace gdax
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace gdax {
+
+    /**
+     * @brief A UUID such as "d50ec984-77a8-460a-b958-66f114b0de9b", stored as 16 bytes.
+     *
+     * Coinbase identifies orders by UUID. Keeping them binary makes the order cache keys a fixed 16
+     * bytes compared with two integer compares.
+     */
+    struct Uuid {
+        static constexpr size_t s_length = 36;
+
+        uint64_t hi = 0;
+        uint64_t lo = 0;
+
+        /**
+         * @return false if the string is not a UUID in the canonical 8-4-4-4-12 form.
+         */
+        static bool parse(const char* s, size_t len, Uuid& out) noexcept {
+            if (len != s_length || s[8] != '-' || s[13] != '-' || s[18] != '-' || s[23] != '-') {
+                return false;
+            }
+
+            uint64_t half[2] = { 0, 0 };
+            uint32_t bad = 0;
+            uint32_t n = 0;
+            for (size_t i = 0; i < len; ++i) {
+                if (i == 8 || i == 13 || i == 18 || i == 23) {
+                    continue;
+                }
+                auto v = hexValue(s[i]);
+                bad |= v;
+                half[n >> 4] = (half[n >> 4] << 4) | (v & 0xf);
+                ++n;
+            }
+            if (bad & 0x10) {
+                return false;
+            }
+            out.hi = half[0];
+            out.lo = half[1];
+            return true;
+        }
+
+        /**
+         * @param buf at least s_length + 1 chars.
+         * @return length of the null-terminated string.
+         */
+        size_t format(char* buf) const noexcept {
+            static const char s_hex[] = "0123456789abcdef";
+            char* p = buf;
+            for (int32_t i = 0; i < 32; ++i) {
+                if (i == 8 || i == 12 || i == 16 || i == 20) {
+                    *p++ = '-';
+                }
+                auto half = i < 16 ? hi : lo;
+                *p++ = s_hex[(half >> (60 - (i & 15) * 4)) & 0xf];
+            }
+            *p = 0;
+            return p - buf;
+        }
+
+        std::string str() const {
+            char buf[s_length + 1];
+            return std::string(buf, format(buf));
+        }
+
+        bool isNil() const noexcept { return !hi && !lo; }
+
+        size_t hash() const noexcept {
+            // the bits of a random UUID are uniform already, fold them and spread the result
+            return (size_t)(((hi ^ lo) * 0x9E3779B97F4A7C15ull) >> 16);
+        }
+
+        bool operator==(const Uuid& rhs) const noexcept { return hi == rhs.hi && lo == rhs.lo; }
+        bool operator!=(const Uuid& rhs) const noexcept { return !(*this == rhs); }
+
+    private:
+        // 0-15, or a value with bit 4 set if c is not a hex digit
+        static uint32_t hexValue(char c) noexcept {
+            if (c >= '0' && c <= '9') {
+                return (uint32_t)(c - '0');
+            }
+            c |= 0x20;
+            if (c >= 'a' && c <= 'f') {
+                return (uint32_t)(c - 'a' + 10);
+            }
+            return 0x10;
+        }
+    };
+
+    template<typename V>
+    bool readJson(const V& v, Uuid& value) {
+        return v.IsString() && Uuid::parse(v.GetString(), v.GetStringLength(), value);
+    }
+
+} // namespace gdax
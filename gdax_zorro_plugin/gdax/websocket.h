@@ -1,24 +1,61 @@
 #pragma once
 
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
 #include "zorro_websocket_proxy_client.h"
+#include "gdax/feed.h"
+#include "gdax/order_book.h"
+#include "gdax/order_events.h"
+#include "gdax/quote_table.h"
+#include "gdax/signer.h"
+#include "logger.h"
 
 namespace gdax {
 
-    class GdaxWebsocket : public zorro::websocket::ZorroWebsocketProxyClient, public zorro::websocket::WebsocketProxyCallback {
-        
+    extern int(__cdecl* BrokerError)(const char* txt);
+    extern int(__cdecl* BrokerProgress)(const int percent);
+
+    class GdaxWebsocket : public zorro::websocket::ZorroWebsocketProxyClient, public zorro::websocket::WebsocketProxyCallback, public FeedListener {
+
         std::string key_;
         std::string phrase_;
-        std::string secret_;
+        HmacSigner signer_;
+        // the user channel is subscribed along with the products if the secret could be decoded
+        bool authenticated_ = false;
         std::string url_;
+        uint32_t id_ = 0;
+        std::atomic_bool opened_{ false };
+        // serializes the subscriptions of the Zorro thread and the resubscriptions of the websocket thread,
+        // so a product is subscribed once. Also guards signer_ and id_ while sending.
+        std::mutex subscribeMutex_;
 
-        struct Subscription {
-            uint64_t tradeIndex{ 0 };
-            uint64_t quoteIndex{ 0 };
-        };
+        // updates of the account's orders from the user channel, consumed by the Zorro thread
+        OrderEventQueue orderEvents_;
 
-        std::shared_ptr<Subscription> subscribed_;
-        std::unordered_map<std::string, std::shared_ptr<Subscription>> subscriptions_populator_;
-        std::unordered_map<std::string, std::shared_ptr<Subscription>> subscriptions_reader_;
+        // quotes_ is populated by the websocket thread and read by the Zorro thread without locking.
+        // slots_ maps a product to its quote slot, only used by the Zorro thread.
+        QuoteTable quotes_;
+        std::unordered_map<std::string, uint32_t> slots_;
+        // level2 book of every quote slot, only used by the websocket thread
+        std::vector<OrderBook> books_{ QuoteTable::capacity };
+
+        // a message can be delivered in multiple chunks, accumulate until remaining is 0
+        std::string buffer_;
+
+        friend class FeedDecoder<GdaxWebsocket>;
+        FeedDecoder<GdaxWebsocket> decoder_{ *this };
 
     public:
         GdaxWebsocket() : ZorroWebsocketProxyClient(this, "Gdax", BrokerError, BrokerProgress) {}
@@ -27,33 +64,327 @@ namespace gdax {
         bool login(const std::string& key, const std::string& phrase, const std::string& secret, bool isPractice) {
             key_ = key;
             phrase_ = phrase;
-            secret_ = secret;
-            //openWs();
-            return true;
+            try {
+                signer_.setBase64Key(secret);
+                authenticated_ = true;
+            }
+            catch (const CryptoPP::Exception& e) {
+                LOG_WARNING("Failed to decode API secret, order updates are polled. err=%s\n", e.what());
+                authenticated_ = false;
+            }
+            orderEvents_.setProducts({});
+            orderEvents_.clear();
+            url_ = isPractice ? "wss://ws-feed-public.sandbox.pro.coinbase.com" : "wss://ws-feed.pro.coinbase.com";
+            return openWs();
         }
 
+        /**
+         * @brief Close the websocket. The subscribed products are kept and subscribed again on the next login,
+         * their quotes and books are dropped by onWebsocketClosed() on the websocket thread.
+         */
         void logout() {
+            uint32_t id;
+            {
+                std::lock_guard<std::mutex> lock(subscribeMutex_);
+                id = id_;
+                id_ = 0;
+                opened_ = false;
+            }
+            if (id) {
+                closeWebSocket(id);
+            }
+            orderEvents_.setProducts({});
+        }
+
+        bool isOpened() const noexcept { return opened_; }
+
+        OrderEventQueue& orderEvents() noexcept { return orderEvents_; }
 
+        bool subscribe(const std::string& product_id) {
+            if (slots_.find(product_id) != slots_.end()) {
+                return true;
+            }
+
+            auto slot = quotes_.add(product_id.c_str());
+            if (slot == QuoteTable::invalid_slot) {
+                BrokerError(("Failed to subscribe " + product_id + ", too many subscriptions.").c_str());
+                return false;
+            }
+            slots_.emplace(product_id, slot);
+
+            std::lock_guard<std::mutex> lock(subscribeMutex_);
+            if (!opened_) {
+                // will be subscribed once the websocket is opened
+                return false;
+            }
+            return sendSubscribe(product_id.c_str());
         }
 
-        void onWebsocketProxyServerDisconnected() override {
+        /**
+         * @brief Returns the latest quote of a subscribed product.
+         *
+         * @return false if the product is not subscribed or no quote has been received yet.
+         */
+        bool getQuote(const std::string& product_id, Quote& quote) const {
+            if (!opened_) {
+                return false;
+            }
 
+            auto it = slots_.find(product_id);
+            if (it == slots_.end()) {
+                return false;
+            }
+            return quotes_.read(it->second, quote);
+        }
+
+        /**
+         * @brief Process one complete feed message.
+         *
+         * Called by onWebsocketData, also used to replay a recorded feed.
+         */
+        void onMessage(const char* data, size_t len) {
+            if (!decoder_.decode(data, len)) {
+                LOG_WARNING("Invalid websocket message. %.*s\n", (int)len, data);
+            }
+        }
+
+    private:
+        bool openWs() {
+            if (!connect()) {
+                LOG_WARNING("Failed to connect to websocket proxy.\n");
+                return false;
+            }
+
+            auto id = openWebSocket(url_);
+            std::lock_guard<std::mutex> lock(subscribeMutex_);
+            id_ = id;
+            if (!id_) {
+                LOG_WARNING("Failed to open websocket %s\n", url_.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        bool sendSubscribe(const char* product_id) {
+            rapidjson::StringBuffer s;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+            writer.StartObject();
+            writer.Key("type");
+            writer.String("subscribe");
+            writer.Key("product_ids");
+            writer.StartArray();
+            writer.String(product_id);
+            writer.EndArray();
+            writer.Key("channels");
+            writer.StartArray();
+            writer.String("ticker");
+            writer.String("level2");
+            if (authenticated_) {
+                writer.String("user");
+            }
+            writer.EndArray();
+            if (authenticated_) {
+                // signature of the user channel, same scheme as the REST requests
+                char timestamp[24];
+                char signature[HmacSigner::s_base64Size + 1];
+                auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+                auto n = snprintf(timestamp, sizeof(timestamp), "%llu", (unsigned long long)now);
+                HmacSigner::Message(signer_).update(timestamp, n).update("GET/users/self/verify", 21).finalBase64(signature);
+                writer.Key("signature");
+                writer.String(signature);
+                writer.Key("key");
+                writer.String(key_.c_str());
+                writer.Key("passphrase");
+                writer.String(phrase_.c_str());
+                writer.Key("timestamp");
+                writer.String(timestamp);
+            }
+            writer.EndObject();
+            LOG_DEBUG("Websocket subscribe: %s\n", product_id);
+            return send(id_, s.GetString(), s.GetSize());
+        }
+
+        /**
+         * @brief The products of the user channel in a subscriptions message.
+         */
+        static std::vector<std::string> userProducts(const char* data, size_t len) {
+            std::vector<std::string> products;
+            rapidjson::Document d;
+            if (d.Parse(data, len).HasParseError() || !d.HasMember("channels") || !d["channels"].IsArray()) {
+                return products;
+            }
+            for (auto& channel : d["channels"].GetArray()) {
+                if (!channel.IsObject() || !channel.HasMember("name") || !channel["name"].IsString() ||
+                    strcmp(channel["name"].GetString(), "user") != 0 || !channel.HasMember("product_ids") || !channel["product_ids"].IsArray()) {
+                    continue;
+                }
+                for (auto& product : channel["product_ids"].GetArray()) {
+                    if (product.IsString()) {
+                        products.emplace_back(product.GetString(), product.GetStringLength());
+                    }
+                }
+            }
+            return products;
+        }
+
+        void onFeedTicker(const FeedTicker& ticker) {
+            auto slot = quotes_.find(ticker.product_id.c_str(), ticker.product_id.size());
+            if (slot == QuoteTable::invalid_slot) {
+                return;
+            }
+            // the book has the best bid/ask between trades
+            if (books_[slot].synced()) {
+                quotes_.update(slot, NAN, NAN, ticker.price.toDouble(), ticker.volume_24h);
+                return;
+            }
+            quotes_.update(slot, ticker.best_bid.toDouble(), ticker.best_ask.toDouble(), ticker.price.toDouble(), ticker.volume_24h);
+        }
+
+        void onFeedL2Update(const FeedL2Update& update) {
+            auto slot = quotes_.find(update.product_id.c_str(), update.product_id.size());
+            if (slot == QuoteTable::invalid_slot || !books_[slot].synced()) {
+                return;
+            }
+            auto& book = books_[slot];
+            if (update.truncated) {
+                // changes were dropped, fall back to the ticker until the product is subscribed again
+                LOG_WARNING("Too many level2 changes of %s, book dropped\n", update.product_id.c_str());
+                book.clear();
+                return;
+            }
+            for (uint32_t i = 0; i < update.count; ++i) {
+                auto& change = update.changes[i];
+                book.update(change.side, change.price, change.size);
+            }
+            updateQuote(slot);
+        }
+
+        /**
+         * @brief Build the book of a product from a level2 snapshot {"product_id": "", "bids": [["price", "size"], ...], "asks": [...]}.
+         */
+        void onSnapshot(const char* data, size_t len) {
+            rapidjson::Document d;
+            if (d.Parse(data, len).HasParseError() || !d.HasMember("product_id") || !d["product_id"].IsString()) {
+                LOG_WARNING("Invalid level2 snapshot\n");
+                return;
+            }
+            auto& product = d["product_id"];
+            auto slot = quotes_.find(product.GetString(), product.GetStringLength());
+            if (slot == QuoteTable::invalid_slot) {
+                return;
+            }
+
+            auto& book = books_[slot];
+            book.reset();
+            auto addLevels = [&d, &book](const char* name, OrderSide side) {
+                if (!d.HasMember(name) || !d[name].IsArray()) {
+                    return;
+                }
+                for (auto& level : d[name].GetArray()) {
+                    if (!level.IsArray() || level.Size() < 2 || !level[0].IsString() || !level[1].IsString()) {
+                        continue;
+                    }
+                    Decimal price;
+                    Decimal size;
+                    if (Decimal::parse(level[0].GetString(), level[0].GetStringLength(), price) &&
+                        Decimal::parse(level[1].GetString(), level[1].GetStringLength(), size)) {
+                        book.update(side, price, size);
+                    }
+                }
+            };
+            addLevels("bids", OrderSide::Buy);
+            addLevels("asks", OrderSide::Sell);
+            updateQuote(slot);
+        }
+
+        void updateQuote(uint32_t slot) {
+            auto& book = books_[slot];
+            quotes_.update(slot, book.bestBid().toDouble(), book.bestAsk().toDouble(), NAN, NAN);
+        }
+
+        void onFeedError(const FeedError& error) {
+            std::string err = "Websocket error: ";
+            err.append(error.message.c_str(), error.message.size());
+            if (!error.reason.empty()) {
+                err.append(" ").append(error.reason.c_str(), error.reason.size());
+            }
+            BrokerError(err.c_str());
+        }
+
+        void onFeedOrder(const FeedOrder& order) {
+            orderEvents_.push(OrderEvent::fromFeed(order));
+        }
+
+        void onFeedMatch(const FeedMatch& match) {
+            if (match.type == FeedType::Match) {
+                orderEvents_.push(OrderEvent::fromFeed(match));
+            }
+        }
+
+        void onFeedMessage(FeedType type, const char* data, size_t len) {
+            if (type == FeedType::Snapshot) {
+                onSnapshot(data, len);
+            }
+            else if (type == FeedType::Subscriptions) {
+                LOG_DEBUG("Websocket subscriptions: %.*s\n", (int)len, data);
+                if (authenticated_) {
+                    orderEvents_.setProducts(userProducts(data, len));
+                }
+            }
+        }
+
+    public:
+        void onWebsocketProxyServerDisconnected() override {
+            BrokerError("Websocket proxy server disconnected.");
+            opened_ = false;
+            orderEvents_.setProducts({});
         }
 
         void onWebsocketOpened(uint32_t id) override {
+            LOG_INFO("Websocket %d opened\n", id);
+            std::lock_guard<std::mutex> lock(subscribeMutex_);
+            // openWebSocket() may not have returned the id yet
+            id_ = id;
+            opened_ = true;
 
+            // (re)subscribe products requested before the websocket was opened
+            auto n = quotes_.size();
+            for (uint32_t i = 0; i < n; ++i) {
+                sendSubscribe(quotes_.symbol(i));
+            }
         }
 
         void onWebsocketClosed(uint32_t id) override {
+            LOG_INFO("Websocket %d closed\n", id);
+            {
+                std::lock_guard<std::mutex> lock(subscribeMutex_);
+                opened_ = false;
+            }
+            orderEvents_.setProducts({});
+            buffer_.clear();
 
+            // quotes are stale once the feed is down, the books are sent again on subscribe
+            quotes_.invalidate();
+            for (auto& book : books_) {
+                book.clear();
+            }
         }
 
         void onWebsocketError(uint32_t id, const char* err, size_t len) override {
-
+            BrokerError(("Websocket error: " + std::string(err, len)).c_str());
         }
 
-        void onWebsocketData(uint32_t id, const char* data, size_t len, size_t remaining) {
-
+        void onWebsocketData(uint32_t id, const char* data, size_t len, size_t remaining) override {
+            if (remaining || !buffer_.empty()) {
+                buffer_.append(data, len);
+                if (remaining) {
+                    return;
+                }
+                onMessage(buffer_.c_str(), buffer_.size());
+                buffer_.clear();
+                return;
+            }
+            onMessage(data, len);
         }
 
     };
@@ -14,11 +14,18 @@
 #include <sstream>
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 
 #include "gdax/client.h"
+#include "gdax/candle_cache.h"
+#include "gdax/trade_registry.h"
+#include "gdax/async_orders.h"
+#include "http_transport.h"
 #include "logger.h"
 #include "include/functions.h"
-//#include "gdax/websocket.h"
+#include "gdax/websocket.h"
 
 #define PLUGIN_VERSION	2
 
@@ -29,17 +36,25 @@ namespace {
     std::string s_asset;
     int s_multiplier = 1;
     int s_priceType = 0;
-    //std::unique_ptr<GdaxWebsocket> wsClient;
+    std::unique_ptr<GdaxWebsocket> wsClient;
     bool s_postOnly = true;
     std::string s_uuid;
+    std::unique_ptr<TradeRegistry> s_trades;
+    // asynchronous BrokerBuy2, see brokerCommand 2005
+    bool s_asyncBuy = false;
+    std::unique_ptr<AsyncOrderTracker> s_asyncOrders;
+    std::atomic<HWND> s_hwnd{ nullptr };
     double s_limitPrice = 0.;
     double s_amount = 1;
+    uint32_t s_sweepInterval = 1000;
 }
 
 namespace gdax
 {
     std::unique_ptr<Client> client = nullptr;
 
+    bool waitOrderAcks();
+
     ////////////////////////////////////////////////////////////////
     DLLFUNC_C int BrokerOpen(char* Name, FARPROC fpError, FARPROC fpProgress)
     {
@@ -56,7 +71,16 @@ namespace gdax
         (FARPROC&)http_result = fpResult;
         (FARPROC&)http_free = fpFree;
 
-        //wsClient = std::make_unique<GdaxWebsocket>();
+        // prefer the builtin HTTP client, Zorro's HTTP functions are the fallback
+        auto winHttp = WinHttpTransport::create();
+        if (winHttp) {
+            setTransport(std::move(winHttp));
+        }
+        else {
+            setTransport(std::make_unique<ZorroHttpTransport>());
+        }
+
+        wsClient = std::make_unique<GdaxWebsocket>();
         return;
     }
 
@@ -64,7 +88,17 @@ namespace gdax
     {
         if (!User) // log out
         {
-            //wsClient->logout();
+            if (wsClient) {
+                wsClient->logout();
+            }
+            // the trades of the orders in flight would be left without an order
+            if (!waitOrderAcks()) {
+                LOG_WARNING("%d asynchronous orders not acknowledged at logout, their trades are dropped\n", (int)s_asyncOrders->pending());
+            }
+            s_asyncOrders.reset();
+            if (s_trades) {
+                s_trades->compact();
+            }
             return 0;
         }
 
@@ -73,6 +107,7 @@ namespace gdax
         s_uuid = "";
         s_limitPrice = 0.;
         s_postOnly = true;
+        s_asyncBuy = false;
         s_amount = 1.;
         s_tif = TimeInForce::FOK;
 
@@ -89,11 +124,21 @@ namespace gdax
             return 0;
         }
 
+        client->setSweepInterval(s_sweepInterval);
         Logger::instance().init("Gdax");
 
-        //if (!wsClient->login(apiKey, passphrase, secret, isPaperTrading)) {
-        //    return 0;
-        //}
+        // the open trades are kept across sessions, Zorro asks for them after a restart
+        s_trades = std::make_unique<TradeRegistry>(isPaperTrading ? "./Data/GdaxTradesDemo.txt" : "./Data/GdaxTrades.txt");
+        s_trades->load();
+
+        if (wsClient) {
+            // order updates are pushed by the websocket while its user channel is live, polled otherwise
+            client->setOrderEvents(&wsClient->orderEvents());
+            if (!wsClient->login(apiKey, passphrase, secret, isPaperTrading)) {
+                // not fatal, market data falls back to REST
+                BrokerError("Failed to open websocket, use REST ticker for market data.");
+            }
+        }
         
         //attempt login
         auto response = client->getAccounts();
@@ -108,6 +153,9 @@ namespace gdax
             BrokerError(("Account " + accounts[0].profile_id).c_str());
             sprintf_s(Account, 1024, accounts[0].profile_id.c_str());
         }
+
+        // the login request has opened the private connection, open a public one as well
+        client->warmUp();
         return 1;
     }
 
@@ -139,18 +187,29 @@ namespace gdax
 
         if (!pPrice) {
             // this is subscribe
+            if (wsClient) {
+                wsClient->subscribe(Asset);
+            }
             return 1;
         }
 
-        auto response = client->getTicker(Asset);
-        if (!response) {
-            BrokerError(("Failed to get ticker " + std::string(Asset) + " error: " + response.what()).c_str());
-            return 0;
+        Quote quote;
+        if (!wsClient || !wsClient->getQuote(Asset, quote)) {
+            // websocket is not available or no quote received yet
+            auto response = client->getTicker(Asset);
+            if (!response) {
+                BrokerError(("Failed to get ticker " + std::string(Asset) + " error: " + response.what()).c_str());
+                return 0;
+            }
+            auto& ticker = response.content();
+            quote.bid = ticker.bid.toDouble();
+            quote.ask = ticker.ask.toDouble();
+            quote.price = ticker.price.toDouble();
         }
 
         if (s_priceType == 2) {
             if (pPrice) {
-                *pPrice = response.content().price;
+                *pPrice = quote.price;
             }
 
             if (pSpread) {
@@ -159,16 +218,16 @@ namespace gdax
         }
         else {
             if (pPrice) {
-                *pPrice = response.content().ask;
+                *pPrice = quote.ask;
             }
 
             if (pSpread) {
-                *pSpread = response.content().ask - response.content().bid;
+                *pSpread = quote.ask - quote.bid;
             }
         }
 
         if (pLotAmount) {
-            *pLotAmount = product->base_increment;
+            *pLotAmount = product->base_increment.toDouble();
         }
 
         if (pRollLong) {
@@ -196,44 +255,126 @@ namespace gdax
 
        LOG_DEBUG("BorkerHisotry %s start: %d end: %d nTickMinutes: %d nTicks: %d\n", Asset, start, end, nTickMinutes, nTicks);
 
+        // bar close time (candle time + granularity) cannot exceed tEnd
+        int granularity = nTickMinutes * 60;
+        end -= granularity;
+        if (end < start) {
+            return 0;
+        }
+
         int barsDownloaded = 0;
-        long firstCandelTime = 0;
-        do {
-            auto response = client->getCandles(Asset, start, end, nTickMinutes * 60, nTicks);
+        auto writeTick = [&](const CandleRecord& candle) {
+            auto& tick = ticks[barsDownloaded++];
+            // change time to bar close time
+            tick.time = convertTime(__time32_t(candle.time + granularity));
+            tick.fOpen = candle.open;
+            tick.fHigh = candle.high;
+            tick.fLow = candle.low;
+            tick.fClose = candle.close;
+            tick.fVol = candle.volume;
+            return barsDownloaded < nTicks;
+        };
+
+        // download candles of [s, e], newest first. returns false on error.
+        // exhausted is set if all candles of [s, e] have been downloaded.
+        auto download = [&](uint32_t s, uint32_t e, uint32_t n, std::vector<CandleRecord>& records, bool& exhausted) {
+            auto response = client->getCandles(Asset, s, e, granularity, n, [&records](const Candle& candle) {
+                records.push_back({ candle.time, (float)candle.low, (float)candle.high, (float)candle.open, (float)candle.close, (float)candle.volume });
+                return true;
+            });
             if (!response) {
                 BrokerError(response.what().c_str());
-                break;
+                return false;
             }
+            exhausted = response.content() < n;
+            return true;
+        };
 
-            if (response.content().candles.empty()) {
-                break;
+        CandleCache cache(Asset, granularity);
+        if (!cache.isOpen() || (!cache.empty() && (uint32_t)end + (uint32_t)nTicks * granularity < cache.coveredStart())) {
+            // the request is far before the cached range, stream the candles straight into ticks
+            auto response = client->getCandles(Asset, start, end, granularity, nTicks, [&writeTick](const Candle& candle) {
+                return writeTick({ candle.time, (float)candle.low, (float)candle.high, (float)candle.open, (float)candle.close, (float)candle.volume });
+            });
+            if (!response) {
+                BrokerError(response.what().c_str());
+            }
+            LOG_DEBUG("%d candles returned\n", barsDownloaded);
+            return barsDownloaded;
+        }
+
+        // only completed bars are cached, the others are returned but not stored
+        uint32_t lastCompleted = (uint32_t)std::time(nullptr) / granularity * granularity - granularity;
+        std::vector<CandleRecord> uncached;
+        auto splitCompleted = [lastCompleted, &uncached](std::vector<CandleRecord>& records) {
+            // records are newest first
+            auto it = std::find_if(records.begin(), records.end(), [lastCompleted](const CandleRecord& r) { return r.time <= lastCompleted; });
+            uncached.insert(uncached.end(), records.begin(), it);
+            records.erase(records.begin(), it);
+            std::reverse(records.begin(), records.end());
+        };
+        // Coinbase may publish the last completed bar late, and a bar without trades is never published. The
+        // range up to the newest returned candle is covered, the bars after it only if they are a bar older
+        // than lastCompleted.
+        auto coveredTo = [end, lastCompleted, granularity](const std::vector<CandleRecord>& records) {
+            uint32_t covered = std::min<uint32_t>(end, lastCompleted - granularity);
+            if (!records.empty()) {
+                // records are oldest first
+                covered = std::max<uint32_t>(covered, records.back().time);
             }
+            return covered;
+        };
 
-            auto& candles = response.content().candles;
-            LOG_DEBUG("%d candles downloaded\n", candles.size());
-            for (auto& candle : candles) {
-                __time32_t barCloseTime = candle.time + nTickMinutes * 60;
-                if (barCloseTime > end) {
-                    // end time cannot exceeds tEnd
-                    continue;
+        if (cache.empty() || ((uint32_t)end > cache.coveredEnd() && ((uint32_t)end - cache.coveredEnd()) / granularity > (uint32_t)nTicks)) {
+            // nothing cached or the cache is too old to be topped up
+            std::vector<CandleRecord> records;
+            bool exhausted;
+            if (download(start, end, nTicks, records, exhausted)) {
+                uint32_t coveredStart = (exhausted || records.empty()) ? start : records.back().time;
+                splitCompleted(records);
+                auto coveredEnd = coveredTo(records);
+                if (coveredEnd >= coveredStart) {
+                    cache.reset(records, coveredStart, coveredEnd);
                 }
+            }
+        }
+        else {
+            // top up the tail
+            if ((uint32_t)end > cache.coveredEnd()) {
+                std::vector<CandleRecord> records;
+                bool exhausted;
+                if (download(cache.coveredEnd() + 1, end, UINT32_MAX, records, exhausted)) {
+                    splitCompleted(records);
+                    cache.append(records, std::max<uint32_t>(cache.coveredEnd(), coveredTo(records)));
+                }
+            }
 
-                auto& tick = ticks[barsDownloaded++];
-                // change time to bar close time
-                tick.time = convertTime(barCloseTime);
-                tick.fOpen = (float)candle.open;
-                tick.fHigh = (float)candle.high;
-                tick.fLow = (float)candle.low;
-                tick.fClose = (float)candle.close;
-                tick.fVol = (float)candle.volume;
-
-                if (barsDownloaded == nTicks) {
-                    break;
+            // fill the head if the cached range does not have enough candles
+            if ((uint32_t)start < cache.coveredStart()) {
+                auto range = cache.find(start, end);
+                auto available = (int)(range.second - range.first + uncached.size());
+                if (available < nTicks) {
+                    std::vector<CandleRecord> records;
+                    bool exhausted;
+                    if (download(start, cache.coveredStart() - 1, nTicks - available, records, exhausted)) {
+                        uint32_t coveredStart = (exhausted || records.empty()) ? start : records.back().time;
+                        std::reverse(records.begin(), records.end());
+                        cache.prepend(records, coveredStart);
+                    }
                 }
             }
-            firstCandelTime = candles[candles.size() - 1].time;
-            end = firstCandelTime - 30;
-        } while (firstCandelTime > start && barsDownloaded < nTicks);
+        }
+
+        for (auto& record : uncached) {
+            if (record.time <= (uint32_t)end && record.time >= (uint32_t)start && !writeTick(record)) {
+                break;
+            }
+        }
+
+        if (barsDownloaded < nTicks) {
+            auto range = cache.find(start, end);
+            for (auto it = range.second; it != range.first && writeTick(*(--it));) {}
+        }
         LOG_DEBUG("%d candles returned\n", barsDownloaded);
         return barsDownloaded;
     }
@@ -260,33 +401,59 @@ namespace gdax
         return 1;
     }
 
-    DLLFUNC_C int BrokerBuy2(char* Asset, int nAmount, double dStopDist, double dLimit, double* pPrice, int* pFill) 
+    /**
+     * @brief Subscribe the product, so the user channel pushes the updates of its orders. They are polled until then.
+     */
+    void watchProduct(const char* Asset) {
+        if (wsClient) {
+            wsClient->subscribe(Asset);
+        }
+    }
+
+    /**
+     * @brief The product and size of an order of BrokerBuy2.
+     *
+     * @return nullptr, with the error reported, if the order is not valid.
+     */
+    const Product* prepareOrder(const char* Asset, int nAmount, double dStopDist, double dLimit, double& lot)
     {
         const auto* product = client->getProduct(Asset);
         if (!product) {
             BrokerError(("Invalid product " + std::string(Asset)).c_str());
-            return 0;
-        }
-
-        OrderSide side = nAmount > 0 ? OrderSide::Buy : OrderSide::Sell;
-        OrderType type = OrderType::Market;
-        if (dLimit) {
-            type = OrderType::Limit;
+            return nullptr;
         }
 
         LOG_DEBUG("BrokerBuy2 %s nAmount=%d dStopDist=%f limit=%f\n", Asset, nAmount, dStopDist, dLimit);
 
-        double lot = std::abs(nAmount) * s_amount;
+        lot = std::abs(nAmount) * s_amount;
         
         // reset s_amount, next asset might have lotAmount = 1, in that case SET_AMOUNT will not be called in advance
         s_amount = 1.;
 
-        if (lot < product->base_min_size)
+        if (lot < product->base_min_size.toDouble())
         {
-            BrokerError((std::string(Asset) + " order size must be greater than " + std::to_string(product->base_min_size) + ", lotAmount=" + std::to_string(lot)).c_str());
+            BrokerError((std::string(Asset) + " order size must be greater than " + std::to_string(product->base_min_size.toDouble()) + ", lotAmount=" + std::to_string(lot)).c_str());
+            return nullptr;
+        }
+        watchProduct(Asset);
+        return product;
+    }
+
+    /**
+     * @brief Submit an order for BrokerBuy2, or the close order of a trade.
+     *
+     * @return -1 and the cached order in ppOrder if the order was placed, -2 on timeout, 0 on failure.
+     */
+    int placeOrder(const char* Asset, int nAmount, double dStopDist, double dLimit, double* pPrice, int* pFill, Order** ppOrder)
+    {
+        double lot;
+        const auto* product = prepareOrder(Asset, nAmount, dStopDist, dLimit, lot);
+        if (!product) {
             return 0;
         }
 
+        OrderSide side = nAmount > 0 ? OrderSide::Buy : OrderSide::Sell;
+        OrderType type = dLimit ? OrderType::Limit : OrderType::Market;
         auto response = client->submitOrder(product, lot, side, type, s_tif, dLimit, dStopDist, s_postOnly);
         if (!response || !response.content()) {
             if (response.getCode() == -2) {
@@ -299,14 +466,14 @@ namespace gdax
         }
 
         auto& order = *response.content();
-        s_uuid = order.id;
+        *ppOrder = &order;
 
-        if (order.filled_size) {
+        if (!order.filled_size.isZero()) {
             if (pPrice) {
                 *pPrice = order.filled_price;
             }
             if (pFill) {
-                *pFill = int(order.filled_size / product->base_increment);
+                *pFill = (int)order.filled_size.ticks(product->base_increment);
             }
         }
         else {
@@ -317,13 +484,200 @@ namespace gdax
         return -1;
     }
 
+    /**
+     * @brief Send the order of a new trade and return without waiting for the response.
+     *
+     * @return the trade id, 0 on failure.
+     */
+    int placeOrderAsync(const char* Asset, int nAmount, double dStopDist, double dLimit, int* pFill)
+    {
+        double lot;
+        const auto* product = prepareOrder(Asset, nAmount, dStopDist, dLimit, lot);
+        if (!product) {
+            return 0;
+        }
+
+        auto tradeId = s_trades->add(Uuid(), nullptr);
+        if (!tradeId) {
+            BrokerError("Too many open trades");
+            return 0;
+        }
+
+        OrderSide side = nAmount > 0 ? OrderSide::Buy : OrderSide::Sell;
+        OrderType type = dLimit ? OrderType::Limit : OrderType::Market;
+        auto response = client->sendOrder(product, lot, side, type, s_tif, dLimit, dStopDist, s_postOnly);
+        if (!response) {
+            s_trades->remove(tradeId);
+            BrokerError(response.what().c_str());
+            return 0;
+        }
+
+        s_asyncOrders->track(tradeId, response.content());
+        if (pFill) {
+            *pFill = 0;
+        }
+        return tradeId;
+    }
+
+    /**
+     * @brief Apply the acknowledged asynchronous orders to their trades.
+     */
+    void applyOrderAcks() {
+        if (!s_asyncOrders) {
+            return;
+        }
+        s_asyncOrders->drain([](OrderAck& ack) {
+            if (!ack.response) {
+                BrokerError(("Order of trade " + std::to_string(ack.trade_id) + " failed. " + ack.response.what()).c_str());
+                s_trades->remove(ack.trade_id);
+                return;
+            }
+            auto* order = client->addOrder(ack.response.content());
+            if (s_trades->find(ack.trade_id)) {
+                client->retainOrder(order->id);
+                s_trades->setOrder(ack.trade_id, order->id, order);
+            }
+        });
+    }
+
+    /**
+     * @brief GET_CALLBACK, called by Zorro on its thread when the worker has posted WM_APP+2 to SET_HWND.
+     */
+    void __cdecl onOrderAcks(void*) {
+        applyOrderAcks();
+    }
+
+    /**
+     * @brief Wait up to 30 seconds until the order of a trade is acknowledged.
+     *
+     * @return false on timeout. true if the trade has its order, or is gone since its order failed.
+     */
+    bool waitOrderAck(int nTradeID) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        applyOrderAcks();
+        Trade* trade;
+        while ((trade = s_trades ? s_trades->find(nTradeID) : nullptr) && trade->order_id.isNil()) {
+            if (!s_asyncOrders || std::chrono::steady_clock::now() >= deadline || !BrokerProgress(1)) {
+                return false;
+            }
+            s_asyncOrders->wait(100);
+            applyOrderAcks();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Wait up to 30 seconds until every asynchronous order is acknowledged, and apply them.
+     *
+     * @return false on timeout.
+     */
+    bool waitOrderAcks() {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        applyOrderAcks();
+        while (s_asyncOrders && s_asyncOrders->pending()) {
+            if (std::chrono::steady_clock::now() >= deadline || !BrokerProgress(1)) {
+                return false;
+            }
+            s_asyncOrders->wait(100);
+            applyOrderAcks();
+        }
+        return true;
+    }
+
+    DLLFUNC_C int BrokerBuy2(char* Asset, int nAmount, double dStopDist, double dLimit, double* pPrice, int* pFill) 
+    {
+        if (s_asyncBuy && s_asyncOrders && s_trades && s_tif == TimeInForce::GTC) {
+            return placeOrderAsync(Asset, nAmount, dStopDist, dLimit, pFill);
+        }
+
+        Order* order = nullptr;
+        auto rt = placeOrder(Asset, nAmount, dStopDist, dLimit, pPrice, pFill, &order);
+        if (rt != -1) {
+            return rt;
+        }
+
+        if (order->filled_size.isZero() && (s_tif == TimeInForce::IOC || s_tif == TimeInForce::FOK ||
+            order->status == OrderStatus::Done || order->status == OrderStatus::Canceled || order->status == OrderStatus::Rejected)) {
+            // not filled and never will be, there is no trade
+            return 0;
+        }
+
+        s_uuid = order->id.str();
+        client->retainOrder(order->id);
+        auto tradeId = s_trades ? s_trades->add(order->id, order) : 0;
+        // with -1 Zorro asks for the uuid of the trade by GET_UUID
+        return tradeId ? tradeId : -1;
+    }
+
+    /**
+     * @brief The order of a trade. nTradeID -1 is the trade of the uuid set by SET_UUID.
+     *
+     * @param sweep false to request the order itself instead of answering from the last order sweep.
+     */
+    Response<Order*> getTradeOrder(int nTradeID, bool sweep) {
+        Trade* trade = nullptr;
+        Uuid id;
+        if (nTradeID == -1) {
+            if (!Uuid::parse(s_uuid.c_str(), s_uuid.size(), id)) {
+                return Response<Order*>(1, "Invalid uuid " + s_uuid);
+            }
+        }
+        else {
+            trade = s_trades ? s_trades->find(nTradeID) : nullptr;
+            if (!trade) {
+                return Response<Order*>(1, "Unknown trade id " + std::to_string(nTradeID));
+            }
+            if (trade->order) {
+                return client->refreshOrder(trade->order, sweep);
+            }
+            if (trade->order_id.isNil()) {
+                return Response<Order*>(1, "Order of trade " + std::to_string(nTradeID) + " is not acknowledged yet");
+            }
+            id = trade->order_id;
+        }
+
+        Response<Order*> response;
+        auto* order = client->findOrder(id);
+        if (order) {
+            response = client->refreshOrder(order, sweep);
+        }
+        else {
+            // not cached, e.g. a trade of an earlier session
+            response = client->getOrder(id);
+            if (!response) {
+                return response;
+            }
+            order = response.content();
+            watchProduct(order->product_id.c_str());
+        }
+        if (client->retainOrder(id) && trade) {
+            trade->order = order;
+        }
+        return response;
+    }
+
+    /**
+     * @brief Forget a trade Zorro has closed.
+     */
+    void closeTrade(int nTradeID, const Order& order) {
+        client->releaseOrder(order.id);
+        if (nTradeID != -1 && s_trades) {
+            s_trades->remove(nTradeID);
+        }
+    }
+
     DLLFUNC_C int BrokerTrade(int nTradeID, double* pOpen, double* pClose, double* pCost, double *pProfit) {
-        if (nTradeID != -1) {
-            BrokerError(("nTradeID " + std::to_string(nTradeID) + " not valid. Need to be an UUID").c_str());
-            return NAY;
+        // no Order pointer is held between Zorro calls
+        client->trimOrders();
+
+        applyOrderAcks();
+        auto* trade = s_trades ? s_trades->find(nTradeID) : nullptr;
+        if (trade && trade->order_id.isNil()) {
+            // the order request is still in flight
+            return 0;
         }
-        
-        Response<Order*> response = client->getOrder(s_uuid);
+
+        Response<Order*> response = getTradeOrder(nTradeID, true);
         if (!response) {
             BrokerError(response.what().c_str());
             return NAY;
@@ -331,31 +685,58 @@ namespace gdax
 
         auto* order = response.content();
 
-        if (pOpen && order->filled_size) {
+        if (pOpen && !order->filled_size.isZero()) {
             *pOpen = order->filled_price;
         }
 
-        if (pCost && order->filled_size) {
-            *pCost = order->fill_fees;
+        if (pCost && !order->filled_size.isZero()) {
+            *pCost = order->fill_fees.toDouble();
 
-            if (order->closeOrder) {
-                *pClose += order->closeOrder->fill_fees;
+            auto* closeOrder = order->close_order_id.isNil() ? nullptr : client->findOrder(order->close_order_id);
+            if (closeOrder) {
+                *pClose += closeOrder->fill_fees.toDouble();
             }
         }
 
         const auto* product = client->getProduct(order->product_id.c_str());
-        return int(order->filled_size / product->base_increment);
+        return (int)order->filled_size.ticks(product->base_increment);
+    }
+
+    /**
+     * @brief Wait up to 10 seconds for the close order of a trade to be done, then report the cost and profit.
+     */
+    void waitCloseOrder(Order* order, Order* closeOrder, double* pCost, double* pProfit) {
+        client->waitOrder(closeOrder, [](const Order& o) { return o.status == OrderStatus::Done; }, 10000);
+        if (closeOrder->status != OrderStatus::Done) {
+            return;
+        }
+
+        order->close_order_id = closeOrder->id;
+        if (pCost) {
+            *pCost = (closeOrder->fill_fees + order->fill_fees).toDouble();
+        }
+        if (pProfit) {
+            if (order->side == OrderSide::Buy) {
+                *pProfit = (closeOrder->executed_value - order->executed_value).toDouble();
+            }
+            else {
+                *pProfit = (order->executed_value - closeOrder->executed_value).toDouble();
+            }
+        }
     }
 
     DLLFUNC_C int BrokerSell2(int nTradeID, int nAmount, double Limit, double* pClose, double* pCost, double* pProfit, int* pFill) {
-        if (nTradeID != -1) {
-            BrokerError(("nTradeID " + std::to_string(nTradeID) + " not valid. Need to be an UUID").c_str());
+        LOG_DEBUG("BrokerSell2 nTradeID=%d UUID=%s nAmount=%d limit=%f\n", nTradeID, s_uuid.c_str(), nAmount, Limit);
+
+        client->trimOrders();
+
+        if (!waitOrderAck(nTradeID)) {
+            BrokerError(("Order of trade " + std::to_string(nTradeID) + " is not acknowledged").c_str());
             return 0;
         }
 
-        LOG_DEBUG("BrokerSell2 UUID=%s nAmount=%d limit=%f\n", s_uuid.c_str(), nAmount, Limit);
-
-        Response<Order*> response = client->getOrder(s_uuid);
+        // the trade is closed by its current state
+        Response<Order*> response = getTradeOrder(nTradeID, false);
         if (!response) {
             BrokerError(response.what().c_str());
             return 0;
@@ -364,11 +745,13 @@ namespace gdax
         auto* order = response.content();
         if (!nAmount) {
             // cancel order
-            if (order->status == "canceled" || order->status == "done") {
+            if (order->status == OrderStatus::Canceled || order->status == OrderStatus::Done) {
+                closeTrade(nTradeID, *order);
                 return nTradeID;
             }
             auto response = client->cancelOrder(*order);
             if (response) {
+                closeTrade(nTradeID, *order);
                 return nTradeID;
             }
             BrokerError(response.what().c_str());
@@ -376,85 +759,79 @@ namespace gdax
         }
 
         auto size = std::abs(nAmount) * s_amount;
-        if (order->status == "done" || (order->filled_size && order->filled_size >= size)) {
+        if (order->status == OrderStatus::Done || (!order->filled_size.isZero() && order->filled_size.toDouble() >= size)) {
             // order has been filled, close open position
-            auto closeTradeId = BrokerBuy2((char*)order->product_id.c_str(), -nAmount, 0, Limit, pClose, pFill);
-            if (closeTradeId == -1) {
-                Order* closeOrder = nullptr;
-                auto start = std::time(nullptr);
-                do {
-                    auto rsp = client->getOrder(s_uuid);
-                    if (rsp) {
-                        auto* closeOrder = rsp.content();
-                        if (closeOrder->status == "done") {
-                            order->closeOrder = closeOrder;
-                            if (pCost) {
-                                *pCost = closeOrder->fill_fees + order->fill_fees;
-                            }
-                            if (pProfit) {
-                                if (order->side == OrderSide::Buy) {
-                                    *pProfit = closeOrder->executed_value - order->executed_value;
-                                }
-                                else {
-                                    *pProfit = order->executed_value - closeOrder->executed_value;
-                                }
-                            }
-                        }
-                        return -1;
-                    }
-                    BrokerProgress(1);
-                }
-                while (closeOrder && closeOrder->status != "done" && (std::time(nullptr) - start) < 10);
+            Order* closeOrder = nullptr;
+            if (placeOrder(order->product_id.c_str(), -nAmount, 0, Limit, pClose, pFill, &closeOrder) == -1) {
+                waitCloseOrder(order, closeOrder, pCost, pProfit);
+                closeTrade(nTradeID, *order);
+                return nTradeID;
             }
             return 0;
         }
         else {
-            BrokerError(("Close working order uuid=" + s_uuid).c_str());
-            if (order->filled_size) {
-                auto closeTradeId = BrokerBuy2((char*)order->product_id.c_str(), order->side == OrderSide::Buy ? -order->filled_size / s_amount : order->filled_size / s_amount, 0, Limit, pClose, pFill);
-                if (closeTradeId == -1) {
-                    Order* closeOrder = nullptr;
-                    auto start = std::time(nullptr);
-                    do {
-                        auto rsp = client->getOrder(s_uuid);
-                        if (rsp) {
-                            closeOrder = rsp.content();
-                            if (closeOrder->status == "done") {
-                                order->closeOrder = closeOrder;
-                                if (pCost) {
-                                    *pCost = closeOrder->fill_fees + order->fill_fees;
-                                }
-                                if (pProfit) {
-                                    if (order->side == OrderSide::Buy) {
-                                        *pProfit = (closeOrder->executed_value - order->executed_value);
-                                    }
-                                    else {
-                                        *pProfit = (order->executed_value - closeOrder->executed_value);
-                                    }
-                                }
-                            }
-                        }
-                        BrokerProgress(1);
-                    }                    
-                    while (closeOrder && closeOrder->status != "done" && (std::time(nullptr) - start) < 10);
+            BrokerError(("Close working order uuid=" + order->id.str()).c_str());
+            if (!order->filled_size.isZero()) {
+                auto filled = order->filled_size.toDouble();
+                Order* closeOrder = nullptr;
+                if (placeOrder(order->product_id.c_str(), order->side == OrderSide::Buy ? -filled / s_amount : filled / s_amount, 0, Limit, pClose, pFill, &closeOrder) == -1) {
+                    waitCloseOrder(order, closeOrder, pCost, pProfit);
                 }
             }
-            auto diff = order->size - (size - order->filled_size);
+            auto diff = order->size.toDouble() - (size - order->filled_size.toDouble());
             assert(diff >= 0);
             auto response = client->cancelOrder(*order);
             if (!response) {
-                BrokerError(("Failed to close trade uuid=" + order->id + ". " + response.what()).c_str());
+                BrokerError(("Failed to close trade uuid=" + order->id.str() + ". " + response.what()).c_str());
                 return 0;
             }
+            closeTrade(nTradeID, *order);
 
             if (diff > 0) {
                 return BrokerBuy2((char*)order->product_id.c_str(), order->side == OrderSide::Buy ? diff / s_amount : -diff / s_amount, 0, Limit, nullptr, nullptr);
             }
-            return -1;
+            return nTradeID;
         }
         return 0;
     }
 
+    /**
+     * @brief GET_TRADES, the open trades with fills. Answered from one order sweep.
+     *
+     * @param trades nullptr to only count them for GET_NTRADES.
+     */
+    int getTrades(TRADE* trades) {
+        if (!s_trades) {
+            return 0;
+        }
+
+        applyOrderAcks();
+        int n = 0;
+        s_trades->forEach([&n, trades](Trade& trade) {
+            auto response = getTradeOrder(trade.id, true);
+            if (!response) {
+                return;
+            }
+
+            const auto* order = response.content();
+            const auto* product = client->getProduct(order->product_id.c_str());
+            if (!product || order->filled_size.isZero()) {
+                return;
+            }
+            if (!trades) {
+                ++n;
+                return;
+            }
+            auto& t = trades[n++];
+            t = TRADE();
+            t.nID = trade.id;
+            t.nLots = (int)order->filled_size.ticks(product->base_increment);
+            t.fEntryPrice = (float)order->filled_price;
+            t.flags = TR_OPEN | (order->side == OrderSide::Sell ? TR_SHORT : TR_LONG);
+        });
+        return n;
+    }
+
     int32_t getPosition(const std::string& currency) {
         if (currency.find("-") != std::string::npos) {
             BrokerError("Invalid currenty. GET_POSITON command take a currency not an Asset");
@@ -495,27 +872,29 @@ namespace gdax
         auto writeProduct = [f](const Product& prod) {
             BrokerError(("Asset " + prod.display_name).c_str());
             BrokerProgress(1);
-            auto rspTiker = client->getTicker(prod.id);
+            auto rspTiker = client->getTicker(prod.id.str());
             if (!rspTiker) {
               BrokerError(rspTiker.what().c_str());
               return;
             }
             
             auto& ticker = rspTiker.content();
-            if (!isnan(ticker.ask) && !isnan(ticker.bid)) {
+            auto quoteIncrement = prod.quote_increment.toDouble();
+            auto baseIncrement = prod.base_increment.toDouble();
+            if (ticker.ask.isValid() && ticker.bid.isValid()) {
                 fprintf(f, "%s,%.8f,%.8f,0.0,0.0,%.8f,%.8f,0.0,1,%.8f,0.000,%s\n",
-                    prod.display_name.c_str(), ticker.ask, (ticker.ask - ticker.bid), prod.quote_increment,
-                    prod.quote_increment, prod.base_increment, prod.id.c_str());
+                    prod.display_name.c_str(), ticker.ask.toDouble(), (ticker.ask - ticker.bid).toDouble(), quoteIncrement,
+                    quoteIncrement, baseIncrement, prod.id.c_str());
             }
-            else if (!isnan(ticker.ask)) {
+            else if (ticker.ask.isValid()) {
                 fprintf(f, "%s,%.8f,NAN,0.0,0.0,%.8f,%.8f,0.0,1,%.8f,0.000,%s\n",
-                    prod.display_name.c_str(), ticker.ask, prod.quote_increment,
-                    prod.quote_increment, prod.base_increment, prod.id.c_str());
+                    prod.display_name.c_str(), ticker.ask.toDouble(), quoteIncrement,
+                    quoteIncrement, baseIncrement, prod.id.c_str());
             }
             else {
                 fprintf(f, "%s,NAN,NAN,0.0,0.0,%.8f,%.8f,0.0,1,%.8f,0.000,%s\n",
-                    prod.display_name.c_str(), prod.quote_increment,
-                    prod.quote_increment, prod.base_increment, prod.id.c_str());
+                    prod.display_name.c_str(), quoteIncrement,
+                    quoteIncrement, baseIncrement, prod.id.c_str());
             }
         };
 
@@ -571,13 +950,24 @@ namespace gdax
             s_uuid = (char*)dwParameter;
             return dwParameter;
 
+        case GET_IDTYPE:
+            // numeric trade ids, BrokerBuy2 returns -1 for a uuid only if the trade registry is full
+            return 0;
+
+        case GET_NTRADES:
+            return getTrades(nullptr);
+
+        case GET_TRADES:
+            return getTrades((TRADE*)dwParameter);
+
         case SET_AMOUNT:
             s_amount = *(double*)dwParameter;
             LOG_DIAG("SET_AMOUNT: %.8f\n", s_amount);
             break;
 
         case GET_MAXTICKS:
-            return 300;
+            // Coinbase returns 300 candles per request, BrokerHistory2 downloads several windows in parallel
+            return 300 * 100;
 
         case GET_MAXREQUESTS:
             // private api rate limit is 5/sec, public api rate limit is 3/sec
@@ -643,9 +1033,14 @@ namespace gdax
             }
             break;
 
-        case GET_BROKERZONE:
         case SET_HWND:
+            s_hwnd = (HWND)dwParameter;
+            break;
+
         case GET_CALLBACK:
+            return (double)(uintptr_t)&onOrderAcks;
+
+        case GET_BROKERZONE:
         case SET_ORDERTEXT:
         case SET_CCY:
             break;
@@ -660,6 +1055,56 @@ namespace gdax
             break;
         }
 
+        case 2003: {
+            // 1 - Zorro's HTTP functions, 0 - builtin HTTP client
+            // the asynchronous order worker waits on the requests of the current transport
+            applyOrderAcks();
+            if (s_asyncOrders && s_asyncOrders->pending()) {
+                BrokerError("Orders are in flight, the HTTP client can not be switched.");
+                return 0;
+            }
+            if ((int)dwParameter == 1) {
+                // Zorro's HTTP functions are only used from the Zorro thread
+                s_asyncBuy = false;
+                s_asyncOrders.reset();
+                setTransport(std::make_unique<ZorroHttpTransport>());
+                return 1;
+            }
+            auto winHttp = WinHttpTransport::create();
+            if (winHttp) {
+                setTransport(std::move(winHttp));
+                return 1;
+            }
+            BrokerError("Builtin HTTP client is not available.");
+            break;
+        }
+
+        case 2004:
+            // milliseconds a sweep of the open orders answers BrokerTrade, 0 - one request per trade
+            s_sweepInterval = (uint32_t)dwParameter;
+            if (client) {
+                client->setSweepInterval(s_sweepInterval);
+            }
+            return dwParameter;
+
+        case 2005:
+            // 1 - BrokerBuy2 returns as soon as a GTC order is sent, 0 - once the order is acknowledged
+            if ((int)dwParameter == 1 && strcmp(transport().name(), "Zorro") == 0) {
+                BrokerError("Asynchronous orders need the builtin HTTP client.");
+                return 0;
+            }
+            s_asyncBuy = (int)dwParameter == 1;
+            if (s_asyncBuy && !s_asyncOrders) {
+                s_asyncOrders = std::make_unique<AsyncOrderTracker>([]() {
+                    // have Zorro call onOrderAcks on its thread
+                    HWND hwnd = s_hwnd;
+                    if (hwnd) {
+                        PostMessage(hwnd, WM_APP + 2, 0, 0);
+                    }
+                });
+            }
+            return s_asyncBuy ? 1 : 0;
+
         default:
             LOG_DEBUG("Unhandled command: %d %lu\n", Command, dwParameter);
             break;
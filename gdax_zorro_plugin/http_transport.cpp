@@ -0,0 +1,479 @@
+#include "stdafx.h"
+#include "http_transport.h"
+
+#include <winhttp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "logger.h"
+
+namespace gdax {
+
+    extern int(__cdecl* http_send)(char* url, char* data, char* header);
+    extern long(__cdecl* http_status)(int id);
+    extern long(__cdecl* http_result)(int id, char* content, long size);
+    extern void(__cdecl* http_free)(int id);
+
+    namespace {
+        std::unique_ptr<HttpTransport> s_transport = std::make_unique<ZorroHttpTransport>();
+
+        // converts into out, which keeps its capacity across calls
+        void widen(const char* s, size_t len, std::wstring& out) {
+            if (!len) {
+                out.clear();
+                return;
+            }
+            int n = MultiByteToWideChar(CP_UTF8, 0, s, (int)len, nullptr, 0);
+            out.resize(n);
+            MultiByteToWideChar(CP_UTF8, 0, s, (int)len, &out[0], n);
+        }
+    }
+
+    HttpTransport& transport() {
+        return *s_transport;
+    }
+
+    void setTransport(std::unique_ptr<HttpTransport> transport) {
+        assert(transport);
+        LOG_INFO("Use %s HTTP transport\n", transport->name());
+        s_transport = std::move(transport);
+    }
+
+    ////////////////////////////////////////////////////////////////
+    int ZorroHttpTransport::send(Lane lane, const char* url, const char* data, const char* headers) {
+        Slot* slot = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& s : slots_) {
+                if (!s.id) {
+                    slot = &s;
+                    break;
+                }
+            }
+            if (!slot) {
+                slots_.emplace_back();
+                slot = &slots_.back();
+            }
+            slot->id = -1;
+        }
+
+        size_t urlLength = strlen(url);
+        size_t dataLength = data ? strlen(data) : 0;
+        auto& buffer = slot->buffer;
+        buffer.assign(url, urlLength + 1);
+        buffer.append(data ? data : "", dataLength + 1);
+        buffer.append(headers ? headers : "");
+        buffer.push_back(0);
+
+        char* pUrl = &buffer[0];
+        char* pData = pUrl + urlLength + 1;
+        char* pHeaders = pData + dataLength + 1;
+        int id = http_send(pUrl, data ? pData : nullptr, headers ? pHeaders : nullptr);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot->id = id;
+        return id;
+    }
+
+    long ZorroHttpTransport::wait(int id, uint32_t timeout_ms) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        long n;
+        while (!(n = http_status(id)) && std::chrono::steady_clock::now() < deadline) {
+            Sleep(5);
+        }
+        return n;
+    }
+
+    long ZorroHttpTransport::result(int id, char* content, long size) {
+        return http_result(id, content, size);
+    }
+
+    void ZorroHttpTransport::free(int id) {
+        http_free(id);
+        if (id <= 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& slot : slots_) {
+            if (slot.id == id) {
+                slot.id = 0;
+                break;
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////
+    struct WinHttpTransport::Impl {
+        struct Request {
+            // request id, 0 once released
+            int id = 0;
+            HINTERNET request = nullptr;
+            HANDLE event = nullptr;
+            std::string body;
+            std::vector<char> response;
+            // 0 pending, > 0 completed, < 0 error. Written by WinHTTP thread, read by waiter.
+            std::atomic<long> status{ 0 };
+            // keeps the request alive while WinHTTP owns its handle, reset on WINHTTP_CALLBACK_STATUS_HANDLE_CLOSING
+            std::shared_ptr<Request> self;
+
+            ~Request() {
+                if (event) {
+                    CloseHandle(event);
+                }
+            }
+
+            void complete(long s) {
+                status = s;
+                SetEvent(event);
+            }
+        };
+
+        // max connections per server of each lane
+        static constexpr DWORD s_maxConnections[] = { 4, 4 };
+
+        HINTERNET sessions[2] = { nullptr, nullptr };
+        std::mutex mutex;
+        // requests in flight and idle ones, as many as ever were in flight at once
+        std::vector<std::shared_ptr<Request>> requests;
+        // connection handles by lane and host:port
+        std::unordered_map<std::wstring, HINTERNET> connections[2];
+        int next_id = 0;
+
+        ~Impl() {
+            std::vector<int> ids;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto& req : requests) {
+                    if (req->id) {
+                        ids.push_back(req->id);
+                    }
+                }
+            }
+            for (auto id : ids) {
+                release(id);
+            }
+            for (auto& lane : connections) {
+                for (auto& kvp : lane) {
+                    WinHttpCloseHandle(kvp.second);
+                }
+            }
+            for (auto session : sessions) {
+                if (session) {
+                    WinHttpCloseHandle(session);
+                }
+            }
+        }
+
+        HINTERNET connect(Lane lane, const std::wstring& host, INTERNET_PORT port) {
+            static thread_local std::wstring s_key;
+            wchar_t portText[8];
+            swprintf(portText, 8, L":%u", (unsigned)port);
+            s_key.assign(host).append(portText);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& laneConnections = connections[lane];
+            auto it = laneConnections.find(s_key);
+            if (it != laneConnections.end()) {
+                return it->second;
+            }
+            auto connection = WinHttpConnect(sessions[lane], host.c_str(), port, 0);
+            if (connection) {
+                laneConnections.emplace(s_key, connection);
+            }
+            return connection;
+        }
+
+        /**
+         * @brief An idle request, with its buffers cleared but not shrunk. A request is idle once nobody but
+         * the pool holds it, i.e. it has been released and WinHTTP has closed its handle.
+         */
+        std::shared_ptr<Request> acquire() {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& req : requests) {
+                if (req.use_count() == 1) {
+                    req->request = nullptr;
+                    req->status = 0;
+                    req->body.clear();
+                    req->response.clear();
+                    ResetEvent(req->event);
+                    return req;
+                }
+            }
+
+            auto req = std::make_shared<Request>();
+            req->event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            if (!req->event) {
+                return nullptr;
+            }
+            requests.push_back(req);
+            return req;
+        }
+
+        std::shared_ptr<Request> find(int id) {
+            if (id <= 0) {
+                return nullptr;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& req : requests) {
+                if (req->id == id) {
+                    return req;
+                }
+            }
+            return nullptr;
+        }
+
+        void release(int id) {
+            if (id <= 0) {
+                return;
+            }
+            std::shared_ptr<Request> req;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto& r : requests) {
+                    if (r->id == id) {
+                        r->id = 0;
+                        req = r;
+                        break;
+                    }
+                }
+            }
+            // the request is idle after WINHTTP_CALLBACK_STATUS_HANDLE_CLOSING, the connection is kept alive for the next request
+            if (req && req->request) {
+                WinHttpCloseHandle(req->request);
+            }
+        }
+
+        static long toStatus(DWORD err) {
+            switch (err) {
+            case ERROR_WINHTTP_NAME_NOT_RESOLVED:
+                return -4;
+            case ERROR_WINHTTP_TIMEOUT:
+            case ERROR_WINHTTP_CANNOT_CONNECT:
+            case ERROR_WINHTTP_CONNECTION_ERROR:
+                return -3;
+            default:
+                return -1;
+            }
+        }
+
+        static void readNext(Request* req) {
+            if (!WinHttpQueryDataAvailable(req->request, nullptr)) {
+                req->complete(toStatus(GetLastError()));
+            }
+        }
+
+        static void CALLBACK callback(HINTERNET handle, DWORD_PTR context, DWORD code, LPVOID info, DWORD length) {
+            auto* req = (Request*)context;
+            if (!req) {
+                return;
+            }
+
+            switch (code) {
+            case WINHTTP_CALLBACK_STATUS_SENDREQUEST_COMPLETE:
+                if (!WinHttpReceiveResponse(req->request, nullptr)) {
+                    req->complete(toStatus(GetLastError()));
+                }
+                break;
+
+            case WINHTTP_CALLBACK_STATUS_HEADERS_AVAILABLE:
+                readNext(req);
+                break;
+
+            case WINHTTP_CALLBACK_STATUS_DATA_AVAILABLE: {
+                auto available = *(DWORD*)info;
+                if (!available) {
+                    // the whole response has been read
+                    req->complete(std::max<long>((long)req->response.size(), 1));
+                    break;
+                }
+                auto offset = req->response.size();
+                req->response.resize(offset + available);
+                if (!WinHttpReadData(req->request, req->response.data() + offset, available, nullptr)) {
+                    req->complete(toStatus(GetLastError()));
+                }
+                break;
+            }
+
+            case WINHTTP_CALLBACK_STATUS_READ_COMPLETE: {
+                // the buffer was sized for the available data, drop what has not been filled
+                auto* end = (char*)info + length;
+                req->response.resize(end - req->response.data());
+                readNext(req);
+                break;
+            }
+
+            case WINHTTP_CALLBACK_STATUS_REQUEST_ERROR: {
+                auto* result = (WINHTTP_ASYNC_RESULT*)info;
+                req->complete(toStatus(result->dwError));
+                break;
+            }
+
+            case WINHTTP_CALLBACK_STATUS_HANDLE_CLOSING:
+                if (handle == req->request) {
+                    // last access to req, it may be reused from here on
+                    req->self.reset();
+                }
+                break;
+            }
+        }
+    };
+
+    constexpr DWORD WinHttpTransport::Impl::s_maxConnections[];
+
+    std::unique_ptr<WinHttpTransport> WinHttpTransport::create() {
+        auto impl = std::make_unique<Impl>();
+        for (uint8_t lane = Lane::Public; lane <= Lane::Private; ++lane) {
+            auto session = WinHttpOpen(L"Zorro", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, WINHTTP_FLAG_ASYNC);
+            if (!session) {
+                LOG_ERROR("WinHttpOpen failed. err=%d\n", GetLastError());
+                return nullptr;
+            }
+            impl->sessions[lane] = session;
+
+            if (WinHttpSetStatusCallback(session, &Impl::callback, WINHTTP_CALLBACK_FLAG_ALL_COMPLETIONS | WINHTTP_CALLBACK_FLAG_HANDLES, 0) == WINHTTP_INVALID_STATUS_CALLBACK) {
+                LOG_ERROR("WinHttpSetStatusCallback failed. err=%d\n", GetLastError());
+                return nullptr;
+            }
+
+            DWORD maxConnections = Impl::s_maxConnections[lane];
+            WinHttpSetOption(session, WINHTTP_OPTION_MAX_CONNS_PER_SERVER, &maxConnections, sizeof(maxConnections));
+        }
+        return std::unique_ptr<WinHttpTransport>(new WinHttpTransport(std::move(impl)));
+    }
+
+    WinHttpTransport::WinHttpTransport(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {}
+
+    WinHttpTransport::~WinHttpTransport() = default;
+
+    int WinHttpTransport::send(Lane lane, const char* url, const char* data, const char* headers) {
+        // conversion buffers of the calling thread, WinHTTP copies what it keeps
+        static thread_local std::wstring s_url;
+        static thread_local std::wstring s_host;
+        static thread_local std::wstring s_path;
+        static thread_local std::wstring s_method;
+        static thread_local std::wstring s_headers;
+
+        widen(url, strlen(url), s_url);
+
+        URL_COMPONENTS components;
+        memset(&components, 0, sizeof(components));
+        components.dwStructSize = sizeof(components);
+        components.dwHostNameLength = (DWORD)-1;
+        components.dwUrlPathLength = (DWORD)-1;
+        components.dwExtraInfoLength = (DWORD)-1;
+        if (!WinHttpCrackUrl(s_url.c_str(), (DWORD)s_url.size(), 0, &components)) {
+            LOG_ERROR("Invalid url %s. err=%d\n", url, GetLastError());
+            return 0;
+        }
+
+        s_host.assign(components.lpszHostName, components.dwHostNameLength);
+        // path and query
+        s_path.assign(components.lpszUrlPath, components.dwUrlPathLength + components.dwExtraInfoLength);
+
+        auto req = impl_->acquire();
+        if (!req) {
+            LOG_ERROR("Failed to create request event. err=%d\n", GetLastError());
+            return 0;
+        }
+
+        const wchar_t* method = L"GET";
+        if (data) {
+            if (data[0] == '#') {
+                widen(data + 1, strlen(data + 1), s_method);
+                method = s_method.c_str();
+            }
+            else {
+                method = L"POST";
+                req->body.assign(data);
+            }
+        }
+
+        auto connection = impl_->connect(lane, s_host, components.nPort);
+        if (connection) {
+            req->request = WinHttpOpenRequest(connection, method, s_path.c_str(), nullptr, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES,
+                components.nScheme == INTERNET_SCHEME_HTTPS ? WINHTTP_FLAG_SECURE : 0);
+        }
+
+        if (!req->request) {
+            // req is idle again once it goes out of scope
+            LOG_ERROR("Failed to open request %s. err=%d\n", url, GetLastError());
+            return 0;
+        }
+
+        // every callback of the handle, up to its closing, gets the request as context
+        auto* context = req.get();
+        req->self = req;
+        WinHttpSetOption(req->request, WINHTTP_OPTION_CONTEXT_VALUE, &context, sizeof(context));
+
+        // Zorro headers are '\n' separated, WinHTTP expects "\r\n"
+        s_headers.clear();
+        if (headers) {
+            for (auto* p = headers; *p; ++p) {
+                if (*p == '\n') {
+                    s_headers.append(L"\r\n");
+                }
+                else {
+                    s_headers.push_back((wchar_t)(unsigned char)*p);
+                }
+            }
+        }
+
+        int id;
+        {
+            std::lock_guard<std::mutex> lock(impl_->mutex);
+            id = ++impl_->next_id;
+            if (id <= 0) {
+                id = impl_->next_id = 1;
+            }
+            req->id = id;
+        }
+
+        if (!WinHttpSendRequest(req->request,
+            s_headers.empty() ? WINHTTP_NO_ADDITIONAL_HEADERS : s_headers.c_str(), (DWORD)s_headers.size(),
+            req->body.empty() ? WINHTTP_NO_REQUEST_DATA : (LPVOID)req->body.data(), (DWORD)req->body.size(), (DWORD)req->body.size(),
+            (DWORD_PTR)context)) {
+            auto err = GetLastError();
+            LOG_ERROR("Failed to send request %s. err=%d\n", url, err);
+            req->complete(Impl::toStatus(err));
+        }
+        return id;
+    }
+
+    long WinHttpTransport::wait(int id, uint32_t timeout_ms) {
+        auto req = impl_->find(id);
+        if (!req) {
+            return -2;
+        }
+
+        long status = req->status;
+        if (!status && WaitForSingleObject(req->event, timeout_ms) == WAIT_OBJECT_0) {
+            status = req->status;
+        }
+        return status;
+    }
+
+    long WinHttpTransport::result(int id, char* content, long size) {
+        auto req = impl_->find(id);
+        if (!req || req->status <= 0) {
+            return 0;
+        }
+
+        long n = std::min<long>(size, (long)req->response.size());
+        memcpy(content, req->response.data(), n);
+        content[n] = 0;
+        return n;
+    }
+
+    void WinHttpTransport::free(int id) {
+        impl_->release(id);
+    }
+
+} // namespace gdax
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace gdax {
+
+    /**
+     * @brief Traffic class of a request. Each lane has its own rate limit and its own connections.
+     */
+    enum Lane : uint8_t {
+        Public,
+        Private,
+    };
+
+    /**
+     * @brief Interface of the HTTP client used by request().
+     *
+     * It follows Zorro's http_send/http_status/http_result/http_free semantics so both
+     * Zorro's HTTP functions and the builtin client can be used interchangeably.
+     */
+    class HttpTransport {
+    public:
+        virtual ~HttpTransport() = default;
+
+        virtual const char* name() const noexcept = 0;
+
+        /**
+         * @brief Start a request.
+         *
+         * @param lane the traffic class of the request.
+         * @param data nullptr for GET, "#DELETE" for DELETE, otherwise the POST body.
+         * @param headers '\n' separated request headers.
+         * @return request id, 0 if failed.
+         */
+        virtual int send(Lane lane, const char* url, const char* data, const char* headers) = 0;
+
+        /**
+         * @brief Wait at most timeout_ms for the request to complete.
+         *
+         * @return the size of the response once completed, 0 if still pending, negative on error:
+         *   -2 invalid id, -3 no response, -4 host could not be resolved, -1 other errors.
+         */
+        virtual long wait(int id, uint32_t timeout_ms) = 0;
+
+        /**
+         * @brief Copy the response of a completed request into content, null-terminated.
+         */
+        virtual long result(int id, char* content, long size) = 0;
+
+        /**
+         * @brief Release the request. Must be called for every id returned by send.
+         */
+        virtual void free(int id) = 0;
+    };
+
+    /**
+     * @brief Transport over Zorro's http_send functions. Zorro only supports polling for completion.
+     *
+     * The url, data and headers of a request are kept until free(id), so the caller's buffers can be
+     * reused while the request is in flight. They are copied into slots which are reused by the next
+     * requests, i.e. sending does not allocate once there are as many slots as requests in flight.
+     */
+    class ZorroHttpTransport final : public HttpTransport {
+    public:
+        const char* name() const noexcept override { return "Zorro"; }
+        int send(Lane lane, const char* url, const char* data, const char* headers) override;
+        long wait(int id, uint32_t timeout_ms) override;
+        long result(int id, char* content, long size) override;
+        void free(int id) override;
+
+    private:
+        struct Slot {
+            // request id, 0 if free, -1 while sending
+            int id = 0;
+            // "url\0data\0headers\0" of the request
+            std::string buffer;
+        };
+
+        std::mutex mutex_;
+        // references are kept when slots are added
+        std::deque<Slot> slots_;
+    };
+
+    /**
+     * @brief Builtin transport over asynchronous WinHTTP. A waiting request is woken up by the
+     * completion callback instead of polling.
+     *
+     * Every lane owns a WinHTTP session, i.e. a pool of keep-alive connections, so private requests
+     * never wait for a connection used by public requests. Connection handles are reused across requests,
+     * and so are the request objects with their event and buffers once WinHTTP has closed their handle.
+     */
+    class WinHttpTransport final : public HttpTransport {
+    public:
+        /**
+         * @return nullptr if WinHTTP is not available.
+         */
+        static std::unique_ptr<WinHttpTransport> create();
+        ~WinHttpTransport() override;
+
+        const char* name() const noexcept override { return "WinHTTP"; }
+
+        int send(Lane lane, const char* url, const char* data, const char* headers) override;
+        long wait(int id, uint32_t timeout_ms) override;
+        long result(int id, char* content, long size) override;
+        void free(int id) override;
+
+    private:
+        struct Impl;
+        explicit WinHttpTransport(std::unique_ptr<Impl> impl);
+        std::unique_ptr<Impl> impl_;
+    };
+
+    /**
+     * @brief The transport used by request().
+     */
+    HttpTransport& transport();
+    void setTransport(std::unique_ptr<HttpTransport> transport);
+
+} // namespace gdax
@@ -19,8 +19,8 @@ namespace gdax {
         L_TRACE2,
     };
 
-    static constexpr char* to_string(LogLevel level) {
-        constexpr char* s_levels[] = {
+    static constexpr const char* to_string(LogLevel level) {
+        constexpr const char* s_levels[] = {
             "OFF", "ERROR", "WARNING", "INFO", "DEBUG", "TRACE", "TRACE2"
         };
         return s_levels[level];
@@ -109,18 +109,18 @@ namespace gdax {
     auto& logger = Logger::instance();              \
     auto lvl = logger.getLevel();                 \
     if (lvl >= level) {   \
-        logger.log(level, format, __VA_ARGS__);      \
+        logger.log(level, format, ##__VA_ARGS__);    \
     }\
 }
 
-#define LOG_DEBUG(format, ...) _LOG(L_DEBUG, format, __VA_ARGS__);
-#define LOG_INFO(format, ...) _LOG(L_INFO, format, __VA_ARGS__);
-#define LOG_WARNING(format, ...) _LOG(L_WARNING, format, __VA_ARGS__);
-#define LOG_ERROR(format, ...) _LOG(L_ERROR, format, __VA_ARGS__);
-#define LOG_TRACE(format, ...) _LOG(L_TRACE, format, __VA_ARGS__);
-#define LOG_TRACE2(format, ...) _LOG(L_TRACE, format, __VA_ARGS__);
+#define LOG_DEBUG(format, ...) _LOG(L_DEBUG, format, ##__VA_ARGS__);
+#define LOG_INFO(format, ...) _LOG(L_INFO, format, ##__VA_ARGS__);
+#define LOG_WARNING(format, ...) _LOG(L_WARNING, format, ##__VA_ARGS__);
+#define LOG_ERROR(format, ...) _LOG(L_ERROR, format, ##__VA_ARGS__);
+#define LOG_TRACE(format, ...) _LOG(L_TRACE, format, ##__VA_ARGS__);
+#define LOG_TRACE2(format, ...) _LOG(L_TRACE, format, ##__VA_ARGS__);
 #ifdef _DEBUG
-#define LOG_DIAG(format, ...) _LOG(L_DEBUG, format, __VA_ARGS__);
+#define LOG_DIAG(format, ...) _LOG(L_DEBUG, format, ##__VA_ARGS__);
 #else
 #define LOG_DIAG(format, ...)
 #endif
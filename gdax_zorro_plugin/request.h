@@ -2,11 +2,16 @@
 
 #include <sstream>
 #include <string>
+#include <vector>
+#include <cstring>
 #include <cassert>
 #include <type_traits>
-#include "gdax/json.h"
+#include <thread>
+#include <chrono>
+#include "response.h"
 #include "logger.h"
 #include "throttler.h"
+#include "http_transport.h"
 
 namespace gdax {
 
@@ -17,12 +22,6 @@ namespace gdax {
     extern long(__cdecl* http_result)(int id, char* content, long size);
     extern void(__cdecl* http_free)(int id);
 
-    template<typename>
-    struct is_vector : std::false_type {};
-
-    template<typename T, typename A>
-    struct is_vector<std::vector<T, A>> : std::true_type {};
-
     /**
      * @brief The status of various Alpaca actions.
      */
@@ -38,197 +37,219 @@ namespace gdax {
         return sActionStatus[status];
     }
 
-    template<typename T>
-    class Response {
-    public:
-        explicit Response(int c = 0) noexcept : code_(c), message_("OK") {}
-        Response(int c, std::string m) noexcept : code_(c), message_(std::move(m)) {}
-        Response(int c, std::string m, const T& content) : code_(c), message_(std::move(m)), content_(content) {}
-
+    /**
+    * @brief Url and headers of a request, assembled in fixed buffers of the calling thread.
+    *
+    * A request is built with reset(lane), url() for the base url, path() for the path and query, and
+    * header() for the '\n' separated headers. The transport copies what it needs when sending, so the
+    * builder can be reused for the next request while the previous one is in flight.
+    */
+    class RequestBuilder {
     public:
-        void onError(int err_code, const std::string& msg) {
-            code_ = err_code;
-            message_ = msg;
-        }
-        int getCode() const noexcept {
-            return code_;
+        static RequestBuilder& get() {
+            static thread_local RequestBuilder s_builder;
+            return s_builder;
         }
 
-        std::string what() const noexcept {
-            return message_;
+        RequestBuilder& reset(Lane lane) noexcept {
+            lane_ = lane;
+            urlLength_ = pathOffset_ = headersLength_ = 0;
+            url_[0] = headers_[0] = 0;
+            overflow_ = false;
+            return *this;
         }
 
-        T& content() noexcept {
-            return content_;
+        RequestBuilder& url(const std::string& base) noexcept {
+            append(url_, sizeof(url_), urlLength_, base.c_str(), base.size());
+            pathOffset_ = urlLength_;
+            return *this;
         }
 
-        explicit operator bool() const noexcept {
-            return code_ == 0;
+        RequestBuilder& path(const char* s, size_t len) noexcept {
+            append(url_, sizeof(url_), urlLength_, s, len);
+            return *this;
         }
 
-    private:
-        template<typename T>
-        friend Response<T> request(const std::string&, const char*, const char*, T*, LogLevel logLevel);
-
-        void parseContent(const std::string& content, T* obj) {
-            rapidjson::Document d;
-            if (d.Parse(content.c_str()).HasParseError()) {
-                message_ = "Received parse error when deserializing asset JSON. err=" + std::to_string(d.GetParseError()) + "\n" + content;
-                code_ = 1;
-                return;
-            }
-
-            if (d.IsObject() && d.HasMember("message")) {
-                message_ = d["message"].GetString();
-                code_ = 1;
-                return;
-            }
-
-            try {
-                Parser<rapidjson::Document> parser(d);
-                std::pair<int, std::string> result;
+        RequestBuilder& path(const char* s) noexcept { return path(s, strlen(s)); }
 
-                if (obj) {
-                    result = parse<T>(parser, *obj);
-                }
-                else {
-                    result = parse<T>(parser, content_);
-                }
-                code_ = result.first;
-                message_ = result.second;
-            }
-            catch (std::exception& e) {
-                code_ = 1;
-                message_ = e.what();
-            }
+        RequestBuilder& header(const char* s, size_t len) noexcept {
+            append(headers_, sizeof(headers_), headersLength_, s, len);
+            return *this;
         }
 
-        template<typename U>
-        std::pair<int, std::string> parse(Parser<rapidjson::Document>& parser, U& content, typename std::enable_if<std::is_same<U, std::string>::value>::type* = 0) {
-            content = parser.json.GetString();
-            return std::make_pair(0, "OK");
-        }
+        RequestBuilder& header(const char* s) noexcept { return header(s, strlen(s)); }
+        RequestBuilder& header(const std::string& s) noexcept { return header(s.c_str(), s.size()); }
 
-        template<typename U>
-        std::pair<int, std::string> parse(Parser<rapidjson::Document>& parser, U& content, typename std::enable_if<!is_vector<U>::value && !std::is_same<U, std::string>::value>::type* = 0) {
-            return content.fromJSON(parser);
-        }
+        Lane lane() const noexcept { return lane_; }
+        const char* url() const noexcept { return url_; }
+        const char* headers() const noexcept { return headers_; }
+        /** @brief The path and query, i.e. the url without the base url. */
+        const char* path() const noexcept { return url_ + pathOffset_; }
+        size_t pathLength() const noexcept { return urlLength_ - pathOffset_; }
+        /** @brief False if the url or the headers did not fit. */
+        bool ok() const noexcept { return !overflow_; }
 
-        template<typename U>
-        std::pair<int, std::string> parse(Parser<rapidjson::Document>& parser, U& content, typename std::enable_if<is_vector<U>::value>::type* = 0) {
-            auto parseArray = [&](auto& arrayObj) -> std::pair<int, std::string> {
-                for (auto& item : arrayObj.GetArray()) {
-                    if (!item.IsObject()) {
-                        assert(false);
-                        continue;
-                    }
-                    else {
-                        auto objJson = item.GetObject();
-                        Parser<decltype(objJson)> itemParser(objJson);
-                        U::value_type obj;
-                        obj.fromJSON(itemParser);
-                        content.emplace_back(std::move(obj));
-                    }
-                }
-                return std::make_pair(0, "OK");
-            };
+    private:
+        RequestBuilder() { reset(Lane::Public); }
 
-            if (parser.json.IsArray()) {
-                return parseArray(parser.json);
-            }
-            else if (parser.json.IsObject()) {
-                auto& item = parser.json.MemberBegin()->value;
-                if (item.IsArray()) {
-                    return parseArray(item);
-                }
-                else {
-                    for (auto iter = parser.json.MemberBegin(); iter != parser.json.MemberEnd(); ++iter) {
-                        auto& item = iter->value;
-                        if (item.IsArray()) {
-                            return parseArray(item);
-                        }
-                    }
-                }
+        void append(char* buf, size_t capacity, size_t& length, const char* s, size_t len) noexcept {
+            if (length + len >= capacity) {
+                overflow_ = true;
+                return;
             }
-            return std::make_pair(0, "OK");
+            memcpy(buf + length, s, len);
+            length += len;
+            buf[length] = 0;
         }
 
     private:
-        int code_;
-        std::string message_;
-        T content_;
+        Lane lane_;
+        bool overflow_;
+        size_t urlLength_;
+        size_t pathOffset_;
+        size_t headersLength_;
+        char url_[2048];
+        char headers_[1024];
     };
 
+    inline Throttler& getThrottler(Lane lane) {
+        // Coinbase Pro rate limits: public 3/s with bursts up to 6, private 5/s with bursts up to 10
+        static Throttler publicApiThrottler(3, 6);
+        static Throttler privateApiThrotter(5, 10);
+        return lane == Lane::Public ? publicApiThrottler : privateApiThrotter;
+    }
+
     /**
-    * Helper function - Send requst
-    * 
-    * unfortunately need to make a copy of headers for every request. Otherwise only the first request has headers.
-    * 
+    * Helper function - Send request without waiting for the response
+    *
+    * url, headers and data only need to be valid during the call.
+    *
+    * @param lane the traffic class, each lane has its own rate limit.
+    * @param priority requests of higher priority get the rate limit tokens first.
+    * @param wait wait for the throttler if the rate limit is reached. Otherwise return 0 with an empty err.
+    * @return request id, 0 if the request can not be sent. err is set in that case.
     */
-    template<typename T>
-    inline Response<T> request(const std::string& url, const char* headers = nullptr, const char* data = nullptr, T* obj = nullptr, LogLevel logLevel = LogLevel::L_TRACE2) {
-        static Throttler publicApiThrottler(3);
-        static Throttler privateApiThrotter(5);
-
-        Throttler& throttler = (strlen(headers) == 16) ? publicApiThrottler : privateApiThrotter;
+    inline int send_request(Lane lane, const char* url, const char* headers, const char* data, Priority priority, std::string& err, bool wait = true) {
+        Throttler& throttler = getThrottler(lane);
 
-        LOG_DEBUG("--> %s\n", url.c_str());
-        if (data) {
-            LOG_DEBUG("Data: %s\n", data);
-        }
-
-        while (!throttler.canSent()) {
+        uint64_t waitTime = throttler.tryAcquire(priority);
+        if (waitTime) {
             // reached throttle limit
-            if (!BrokerProgress(1)) {
-                return Response<T>(1, "Brokerprogress returned zero. Aborting...");
+            if (!wait) {
+                return 0;
             }
-            using namespace std::chrono_literals;
-            std::this_thread::sleep_for(250ms);
+
+            Throttler::Waiting waiting(throttler, priority);
+            do {
+                if (!BrokerProgress(1)) {
+                    err = "Brokerprogress returned zero. Aborting...";
+                    return 0;
+                }
+                // sleep exactly until the next token is available
+                std::this_thread::sleep_for(std::chrono::microseconds(waitTime));
+            } while ((waitTime = throttler.tryAcquire(priority)));
         }
 
-        int id = http_send((char*)url.c_str(), (char*)data, (char*)headers);
+        LOG_DEBUG("--> %s\n", url);
+        if (data) {
+            LOG_DEBUG("Data: %s\n", data);
+        }
 
+        int id = transport().send(lane, url, data, headers);
         if (!id) {
-            return Response<T>(1, "Cannot connect to server");
+            err = "Cannot connect to server";
         }
+        return id;
+    }
 
-        long n = 0;
-        std::stringstream ss;
-        while (!(n = http_status(id))) {
-            Sleep(100); // wait for the server to reply
-            if (!BrokerProgress(1)) {
-                http_free(id);
-                return Response<T>(1, "Brokerprogress returned zero. Aborting...");
-            }
-            // print dots, abort if returns zero.
+    /**
+    * @brief Per-thread receive buffer. It only grows, so steady state responses are received without allocation.
+    */
+    inline std::vector<char>& receiveBuffer(size_t size) {
+        static thread_local std::vector<char> s_buffer;
+        if (s_buffer.size() < size) {
+            s_buffer.resize(size);
         }
+        return s_buffer;
+    }
 
-        if (n > 0) {
-            char* buffer = (char*)malloc(n + 1);
-            auto received = http_result(id, buffer, n);
-            ss << buffer;
-            free(buffer); //free up memory allocation
-            http_free(id); //always clean up the id!
-        }
-        else {
-            http_free(id); //always clean up the id!
+    /**
+    * Helper function - Read the body of a completed request
+    *
+    * The response is copied once into the receive buffer of the calling thread.
+    *
+    * @param n status of the request returned by HttpTransport::wait, must not be 0.
+    * @return the null-terminated body, valid until the next response is received on the thread.
+    */
+    inline Response<char*> receive_content(int id, long n, LogLevel logLevel = LogLevel::L_TRACE2) {
+        assert(n);
+        if (n < 0) {
+            transport().free(id); //always clean up the id!
             switch (n) {
             case -2:
-                return Response<T>(n, "Id is invalid");
+                return Response<char*>(n, "Id is invalid");
             case -3:
-                return Response<T>(n, "Website did not response");
+                return Response<char*>(n, "Website did not response");
             case -4:
-                return Response<T>(n, "Host could not be resolved");
+                return Response<char*>(n, "Host could not be resolved");
             default:
-                return Response<T>(n, "Transfer Failed");
+                return Response<char*>(n, "Transfer Failed");
             }
         }
 
-        _LOG(logLevel, "<-- %s\n", ss.str().c_str());
+        auto& buffer = receiveBuffer((size_t)n + 1);
+        char* content = buffer.data();
+        auto received = transport().result(id, content, n);
+        content[received > 0 ? received : 0] = 0;
+        transport().free(id); //always clean up the id!
+
+        _LOG(logLevel, "<-- %s\n", content);
+        return Response<char*>(0, "OK", content);
+    }
+
+    /**
+    * Helper function - Read and parse the response of a completed request
+    *
+    * The body is parsed in place from the receive buffer.
+    *
+    * @param n status of the request returned by HttpTransport::wait, must not be 0.
+    */
+    template<typename T>
+    inline Response<T> receive_response(int id, long n, T* obj = nullptr, LogLevel logLevel = LogLevel::L_TRACE2) {
+        auto body = receive_content(id, n, logLevel);
+        if (!body) {
+            return Response<T>(body.getCode(), body.what());
+        }
 
         Response<T> response;
-        response.parseContent(ss.str(), obj);
+        response.parseContent(body.content(), obj);
         return response;
     }
 
+    /**
+    * Helper function - Send requst and wait for the response
+    */
+    template<typename T>
+    inline Response<T> request(const RequestBuilder& builder, const char* data = nullptr, T* obj = nullptr, LogLevel logLevel = LogLevel::L_TRACE2, Priority priority = P_STATUS) {
+        if (!builder.ok()) {
+            return Response<T>(1, "Request too long");
+        }
+
+        std::string err;
+        int id = send_request(builder.lane(), builder.url(), builder.headers(), data, priority, err);
+        if (!id) {
+            return Response<T>(1, err);
+        }
+
+        long n = 0;
+        while (!(n = transport().wait(id, 100))) {
+            // still waiting for the server to reply, print dots, abort if returns zero.
+            if (!BrokerProgress(1)) {
+                transport().free(id);
+                return Response<T>(1, "Brokerprogress returned zero. Aborting...");
+            }
+        }
+        return receive_response<T>(id, n, obj, logLevel);
+    }
+
 } // namespace gdax
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cassert>
+#include <exception>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "gdax/json.h"
+
+namespace gdax {
+
+    template<typename>
+    struct is_vector : std::false_type {};
+
+    template<typename T, typename A>
+    struct is_vector<std::vector<T, A>> : std::true_type {};
+
+    template<typename T>
+    class Response {
+    public:
+        explicit Response(int c = 0) noexcept : code_(c), message_("OK") {}
+        Response(int c, std::string m) noexcept : code_(c), message_(std::move(m)) {}
+        Response(int c, std::string m, const T& content) : code_(c), message_(std::move(m)), content_(content) {}
+
+    public:
+        void onError(int err_code, const std::string& msg) {
+            code_ = err_code;
+            message_ = msg;
+        }
+        int getCode() const noexcept {
+            return code_;
+        }
+
+        std::string what() const noexcept {
+            return message_;
+        }
+
+        T& content() noexcept {
+            return content_;
+        }
+
+        explicit operator bool() const noexcept {
+            return code_ == 0;
+        }
+
+        /**
+         * @brief Parse the response in place. String values of the DOM point into content, which is modified.
+         *
+         * Used by receive_response(), and to replay recorded payloads without a transport.
+         *
+         * @param content null-terminated response body, must outlive the parsing.
+         */
+        void parseContent(char* content, T* obj) {
+            PooledDocument d;
+            if (d.ParseInsitu(content).HasParseError()) {
+                // the body has been logged before parsing, it is partially overwritten by now
+                message_ = "Received parse error when deserializing asset JSON. err=" + std::to_string(d.GetParseError()) + " offset=" + std::to_string(d.GetErrorOffset());
+                code_ = 1;
+                return;
+            }
+
+            if (d.IsObject() && d.HasMember("message")) {
+                message_ = d["message"].GetString();
+                code_ = 1;
+                return;
+            }
+
+            try {
+                Parser<JsonDocument> parser(d);
+                std::pair<int, std::string> result;
+
+                if (obj) {
+                    result = parse<T>(parser, *obj);
+                }
+                else {
+                    result = parse<T>(parser, content_);
+                }
+                code_ = result.first;
+                message_ = result.second;
+            }
+            catch (std::exception& e) {
+                code_ = 1;
+                message_ = e.what();
+            }
+        }
+
+    private:
+        template<typename U>
+        std::pair<int, std::string> parse(Parser<JsonDocument>& parser, U& content, typename std::enable_if<std::is_same<U, std::string>::value>::type* = 0) {
+            content = parser.json.GetString();
+            return std::make_pair(0, "OK");
+        }
+
+        template<typename U>
+        std::pair<int, std::string> parse(Parser<JsonDocument>& parser, U& content, typename std::enable_if<!is_vector<U>::value && !std::is_same<U, std::string>::value>::type* = 0) {
+            return content.fromJSON(parser);
+        }
+
+        template<typename U>
+        std::pair<int, std::string> parse(Parser<JsonDocument>& parser, U& content, typename std::enable_if<is_vector<U>::value>::type* = 0) {
+            auto parseArray = [&](auto& arrayObj) -> std::pair<int, std::string> {
+                for (auto& item : arrayObj.GetArray()) {
+                    if (!item.IsObject()) {
+                        assert(false);
+                        continue;
+                    }
+                    else {
+                        auto objJson = item.GetObject();
+                        Parser<decltype(objJson)> itemParser(objJson);
+                        typename U::value_type obj;
+                        obj.fromJSON(itemParser);
+                        content.emplace_back(std::move(obj));
+                    }
+                }
+                return std::make_pair(0, "OK");
+            };
+
+            if (parser.json.IsArray()) {
+                return parseArray(parser.json);
+            }
+            else if (parser.json.IsObject()) {
+                auto& item = parser.json.MemberBegin()->value;
+                if (item.IsArray()) {
+                    return parseArray(item);
+                }
+                else {
+                    for (auto iter = parser.json.MemberBegin(); iter != parser.json.MemberEnd(); ++iter) {
+                        auto& item = iter->value;
+                        if (item.IsArray()) {
+                            return parseArray(item);
+                        }
+                    }
+                }
+            }
+            return std::make_pair(0, "OK");
+        }
+
+    private:
+        int code_;
+        std::string message_;
+        T content_;
+    };
+
+} // namespace gdax
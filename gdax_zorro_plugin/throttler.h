@@ -2,48 +2,112 @@
 
 #include <cstdint>
 #include <chrono>
+#include <mutex>
+#include <algorithm>
 
 namespace gdax {
 
+    /**
+     * @brief Request priority classes, lower value is served first.
+     */
+    enum Priority : uint8_t {
+        P_TRADING,  // order entry and cancel
+        P_STATUS,   // account and order status
+        P_BULK,     // market data, history and product downloads
+    };
+
+    /**
+     * @brief Token bucket rate limiter.
+     *
+     * Refills `rate` tokens per second up to `burst` tokens. Implemented as a generic cell rate algorithm,
+     * only the theoretical arrival time of the next request is tracked, in microseconds.
+     * Safe to be shared across threads.
+     *
+     * Tokens are handed out by priority: a request yields while a higher priority request is waiting, and
+     * bulk requests never take the last token of the bucket so trading requests always find one.
+     */
     class Throttler {
-        uint64_t start_timestamp_ = 0;
-        uint64_t timestamp_ = 0;
-        uint32_t count_ = 0;
-        uint32_t limit_ = 0;
     public:
-        Throttler(uint32_t limit) : limit_(limit) {}
+        using Clock = uint64_t(*)();
+
+        Throttler(uint32_t rate, uint32_t burst, Clock clock = &Throttler::now)
+            : interval_(1000000 / rate)
+            , tolerance_((uint64_t)(std::max<uint32_t>(burst, 1) - 1) * interval_)
+            , bulkTolerance_(tolerance_ >= interval_ ? tolerance_ - interval_ : 0)
+            , clock_(clock) {}
         ~Throttler() = default;
 
-        bool canSent() noexcept {
-            timestamp_ = get_timestamp();
-            if ((timestamp_ - start_timestamp_) > 1000) {
-                count_ = 1;
-                start_timestamp_ = timestamp_;
-                return true;
+        Throttler(const Throttler&) = delete;
+        Throttler& operator=(const Throttler&) = delete;
+
+        /**
+         * @brief Registers a waiting request for the scope of the object, so lower priorities yield to it.
+         */
+        class Waiting {
+        public:
+            Waiting(Throttler& throttler, Priority priority) : throttler_(throttler), priority_(priority) {
+                std::lock_guard<std::mutex> lock(throttler_.mutex_);
+                ++throttler_.waiting_[priority_];
             }
-            else if (count_ < limit_) {
-                ++count_;
-                return true;
+            ~Waiting() {
+                std::lock_guard<std::mutex> lock(throttler_.mutex_);
+                --throttler_.waiting_[priority_];
             }
-            return false;
+        private:
+            Throttler& throttler_;
+            Priority priority_;
+        };
+
+        /**
+         * @brief Take a token if one is available for the priority.
+         *
+         * @return 0 if a token has been taken, otherwise the microseconds until the next token is available.
+         */
+        uint64_t tryAcquire(Priority priority = P_TRADING) noexcept {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto t = clock_();
+            auto tat = std::max(tat_, t);
+            for (uint8_t p = P_TRADING; p < priority; ++p) {
+                if (waiting_[p]) {
+                    // the next token goes to the higher priority request, retry after it
+                    return (tat - t > tolerance_ ? tat - t - tolerance_ : 0) + interval_;
+                }
+            }
+
+            auto tolerance = priority == P_BULK ? bulkTolerance_ : tolerance_;
+            if (tat - t > tolerance) {
+                return tat - t - tolerance;
+            }
+            tat_ = tat + interval_;
+            return 0;
         }
 
-        uint32_t getCount() const noexcept {
-            return count_;
+        bool canSent() noexcept {
+            return tryAcquire() == 0;
         }
 
-        uint64_t startTimestamp() const noexcept {
-            return start_timestamp_;
+        /**
+         * @brief Microseconds until the next token is available, 0 if available now.
+         */
+        uint64_t waitTime() const noexcept {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto t = clock_();
+            auto tat = std::max(tat_, t);
+            return tat - t > tolerance_ ? tat - t - tolerance_ : 0;
         }
 
-        uint64_t lastTimestamp() const noexcept {
-            return timestamp_;
+        static uint64_t now() noexcept {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
         }
 
     private:
-        static uint64_t get_timestamp() {
-            auto now = std::chrono::system_clock::now();
-            return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-        }
+        const uint64_t interval_;
+        const uint64_t tolerance_;
+        // bulk requests keep one token in reserve
+        const uint64_t bulkTolerance_;
+        const Clock clock_;
+        uint64_t tat_ = 0;
+        uint32_t waiting_[P_BULK + 1] = { 0, 0, 0 };
+        mutable std::mutex mutex_;
     };
-}
\ No newline at end of file
+}
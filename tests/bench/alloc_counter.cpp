@@ -0,0 +1,35 @@
+#include "bench/alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t> s_allocations{ 0 };
+}
+
+void* operator new(std::size_t size) {
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace gdax {
+    namespace bench {
+
+        uint64_t allocations() noexcept {
+            return s_allocations.load(std::memory_order_relaxed);
+        }
+
+    } // namespace bench
+} // namespace gdax
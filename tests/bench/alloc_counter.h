@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace gdax {
+    namespace bench {
+
+        /**
+         * @brief Number of operator new calls of the process so far. Linked into the benchmarks only.
+         */
+        uint64_t allocations() noexcept;
+
+    } // namespace bench
+} // namespace gdax
@@ -0,0 +1,104 @@
+// Time and allocations of decoding the recorded REST payloads, the way the Client decodes its responses:
+// Response<T>::parseContent for the products, orders, accounts, fills and the ticker, and the streaming
+// CandleHandler for a page of 300 candles.
+//
+//   bench_decode [messages]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "rapidjson/reader.h"
+#include "response.h"
+#include "gdax/account.h"
+#include "gdax/candle.h"
+#include "gdax/fill.h"
+#include "gdax/order.h"
+#include "gdax/product.h"
+#include "gdax/ticker.h"
+#include "bench/alloc_counter.h"
+#include "support/test_data.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    size_t count(const std::vector<gdax::Product>& v) { return v.size(); }
+    size_t count(const std::vector<gdax::Order>& v) { return v.size(); }
+    size_t count(const std::vector<gdax::Account>& v) { return v.size(); }
+    size_t count(const std::vector<gdax::Fill>& v) { return v.size(); }
+    size_t count(const gdax::Ticker&) { return 1; }
+
+    /**
+     * @brief Decode the payload n times with decode(buffer), which returns the number of decoded items, 0 on error.
+     */
+    template<typename F>
+    bool run(const char* file, uint64_t n, F&& decode) {
+        auto payload = gdax::test::readTestData(file);
+        if (payload.empty()) {
+            fprintf(stderr, "%s not found\n", file);
+            return false;
+        }
+
+        // in-situ parsing writes into the payload, it is copied into a reused buffer first
+        std::vector<char> buffer(payload.size() + 1);
+        size_t items = 0;
+        auto allocations = gdax::bench::allocations();
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < n; ++i) {
+            memcpy(buffer.data(), payload.c_str(), payload.size() + 1);
+            items = decode(buffer.data());
+            if (!items) {
+                fprintf(stderr, "%s: decode error\n", file);
+                return false;
+            }
+        }
+        auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        printf("%-14s %7zu bytes %4zu items %10.0f ns/message %8.1f MB/s %8.2f allocations/message\n", file, payload.size(), items,
+            seconds * 1e9 / (double)n, (double)payload.size() * (double)n / seconds / 1e6,
+            (double)(gdax::bench::allocations() - allocations) / (double)n);
+        return true;
+    }
+
+    template<typename T>
+    bool runResponse(const char* file, uint64_t n) {
+        return run(file, n, [](char* content) -> size_t {
+            gdax::Response<T> response;
+            response.parseContent(content, nullptr);
+            return response ? count(response.content()) : 0;
+        });
+    }
+
+    bool runCandles(const char* file, uint64_t n) {
+        return run(file, n, [](char* content) -> size_t {
+            // the page of the recorded window, newest first
+            double close = 0.;
+            std::function<bool(const gdax::Candle&)> onCandle = [&close](const gdax::Candle& candle) {
+                close += candle.close;
+                return true;
+            };
+            gdax::CandleHandler<std::function<bool(const gdax::Candle&)>> handler(0, UINT32_MAX, onCandle);
+            rapidjson::Reader reader;
+            rapidjson::InsituStringStream ss(content);
+            if (reader.Parse<rapidjson::kParseInsituFlag>(ss, handler).IsError() || !handler.error().empty() || close <= 0.) {
+                return 0;
+            }
+            return handler.count();
+        });
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000;
+    bool ok = runResponse<std::vector<gdax::Product>>("products.json", n) &&
+        runCandles("candles.json", n) &&
+        runResponse<std::vector<gdax::Order>>("orders.json", n) &&
+        runResponse<std::vector<gdax::Account>>("accounts.json", n) &&
+        runResponse<gdax::Ticker>("ticker.json", n) &&
+        runResponse<std::vector<gdax::Fill>>("fills.json", n);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+// Replays a recorded websocket feed through the FeedDecoder.
+//
+//   bench_feed_decoder [feed.jsonl] [passes]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gdax/feed.h"
+#include "bench/alloc_counter.h"
+
+using namespace gdax;
+
+namespace {
+    struct Listener : FeedListener {
+        uint64_t messages = 0;
+        uint64_t changes = 0;
+
+        void onFeedTicker(const FeedTicker&) { ++messages; }
+        void onFeedL2Update(const FeedL2Update& msg) { ++messages; changes += msg.count; }
+        void onFeedHeartbeat(const FeedHeartbeat&) { ++messages; }
+        void onFeedMatch(const FeedMatch&) { ++messages; }
+        void onFeedOrder(const FeedOrder&) { ++messages; }
+        void onFeedMessage(FeedType, const char*, size_t) { ++messages; }
+    };
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : TEST_DATA_DIR "/feed.jsonl";
+    const uint32_t passes = argc > 2 ? (uint32_t)atoi(argv[2]) : 2000;
+
+    std::vector<std::string> corpus;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);) {
+        if (!line.empty()) {
+            corpus.push_back(line);
+        }
+    }
+    if (corpus.empty()) {
+        fprintf(stderr, "no messages in %s\n", path);
+        return 1;
+    }
+    size_t bytes = 0;
+    for (auto& line : corpus) {
+        bytes += line.size();
+    }
+
+    Listener listener;
+    FeedDecoder<Listener> decoder(listener);
+    // one pass to warm up the buffer of the decoder
+    for (auto& line : corpus) {
+        decoder.decode(line.data(), line.size());
+    }
+
+    auto allocations = bench::allocations();
+    auto start = std::chrono::steady_clock::now();
+    uint64_t failed = 0;
+    for (uint32_t i = 0; i < passes; ++i) {
+        for (auto& line : corpus) {
+            failed += !decoder.decode(line.data(), line.size());
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    allocations = bench::allocations() - allocations;
+
+    const double messages = (double)corpus.size() * passes;
+    printf("%zu messages, %zu bytes, %u passes\n", corpus.size(), bytes, passes);
+    printf("%.1f ns/message, %.1f MB/s, %.3f allocations/message, %llu failed\n",
+        seconds * 1e9 / messages, (double)bytes * passes / seconds / 1e6, (double)allocations / messages, (unsigned long long)failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+// Allocations and time of parsing the recorded REST payloads into a DOM, from the thread local arena
+// and from rapidjson's default allocators.
+//
+//   bench_json_arena [documents]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "gdax/json.h"
+#include "bench/alloc_counter.h"
+#include "support/test_data.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template<typename Document>
+    void run(const char* name, const std::string& payload, uint64_t n) {
+        // in-situ parsing writes into the payload, it is copied into a reused buffer first
+        std::vector<char> buffer(payload.size() + 1);
+        uint64_t members = 0;
+        auto allocations = gdax::bench::allocations();
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < n; ++i) {
+            memcpy(buffer.data(), payload.c_str(), payload.size() + 1);
+            Document d;
+            if (d.ParseInsitu(buffer.data()).HasParseError()) {
+                fprintf(stderr, "parse error\n");
+                exit(1);
+            }
+            members += d.IsArray() ? d.Size() : d.MemberCount();
+        }
+        auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        printf("  %-10s %8.1f us/document, %6.1f MB/s, %.2f allocations/document (%llu values)\n", name, seconds * 1e6 / (double)n,
+            (double)payload.size() * (double)n / seconds / 1e6, (double)(gdax::bench::allocations() - allocations) / (double)n,
+            (unsigned long long)(members / n));
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000;
+    for (auto file : { "products.json", "orders.json", "accounts.json", "fills.json", "ticker.json" }) {
+        auto payload = gdax::test::readTestData(file);
+        if (payload.empty()) {
+            fprintf(stderr, "%s not found\n", file);
+            return 1;
+        }
+        printf("%s, %zu bytes\n", file, payload.size());
+        run<gdax::PooledDocument>("arena", payload, n);
+        run<rapidjson::Document>("default", payload, n);
+    }
+    return 0;
+}
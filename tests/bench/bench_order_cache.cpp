@@ -0,0 +1,99 @@
+// Memory and lookup cost of the OrderCache with a million orders.
+//
+//   bench_order_cache [orders]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "gdax/order_cache.h"
+
+using gdax::Order;
+using gdax::OrderCache;
+using gdax::OrderStatus;
+using gdax::Uuid;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double nanosPer(Clock::time_point start, size_t n) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double)n;
+    }
+
+    size_t nextPowerOfTwo(size_t n) {
+        size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::mt19937_64 rng(1);
+    std::vector<Uuid> ids(n);
+    for (auto& id : ids) {
+        id.hi = rng();
+        id.lo = rng();
+    }
+    std::vector<size_t> lookups(n);
+    for (auto& i : lookups) {
+        i = (size_t)(rng() % n);
+    }
+
+    OrderCache cache;
+    Order order;
+    order.status = OrderStatus::Open;
+
+    auto start = Clock::now();
+    for (auto& id : ids) {
+        order.id = id;
+        cache.insert(order);
+    }
+    auto insertNs = nanosPer(start, n);
+
+    start = Clock::now();
+    size_t found = 0;
+    for (auto i : lookups) {
+        found += cache.find(ids[i]) != nullptr;
+    }
+    auto findNs = nanosPer(start, n);
+
+    Uuid missing;
+    start = Clock::now();
+    size_t notFound = 0;
+    for (size_t i = 0; i < n; ++i) {
+        missing.hi = rng();
+        missing.lo = rng();
+        notFound += cache.find(missing) == nullptr;
+    }
+    auto missNs = nanosPer(start, n);
+
+    // the index is kept at most half full, a record is an Order and two flags padded to its alignment
+    const size_t buckets = nextPowerOfTwo(n * 2 + 2);
+    const double recordBytes = (double)n * (sizeof(Order) + alignof(Order));
+    const double indexBytes = (double)buckets * (sizeof(Uuid) + 8);
+    printf("orders %zu, sizeof(Order) %zu\n", n, sizeof(Order));
+    printf("insert %.1f ns, find %.1f ns, find missing %.1f ns (%zu found, %zu missing)\n",
+        insertNs, findNs, missNs, found, notFound);
+    printf("records %.1f MB, index %.1f MB (%zu buckets)\n", recordBytes / 1e6, indexBytes / 1e6, buckets);
+
+    // bounded: orders finishing as they are placed, trimmed like BrokerTrade does
+    OrderCache bounded;
+    order.status = OrderStatus::Done;
+    size_t peak = 0;
+    start = Clock::now();
+    for (auto& id : ids) {
+        order.id = id;
+        bounded.insert(order);
+        peak = peak < bounded.size() ? bounded.size() : peak;
+        bounded.trim();
+    }
+    printf("done orders with trim: %.1f ns per order, at most %zu live\n", nanosPer(start, n), peak);
+    return found == n ? 0 : 1;
+}
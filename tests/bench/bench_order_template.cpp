@@ -0,0 +1,79 @@
+// Cost of building an order body with the OrderTemplate, compared with a rapidjson Writer per order.
+//
+//   bench_order_template [orders]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "gdax/order_template.h"
+#include "bench/alloc_counter.h"
+
+using namespace gdax;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // the body as submitOrder built it before the templates
+    size_t writeOrder(const Product& product, double lots, double limit) {
+        rapidjson::StringBuffer s;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+        char price[32];
+        char size[32];
+        snprintf(price, sizeof(price), "%.2f", limit);
+        snprintf(size, sizeof(size), "%.8f", lots);
+        writer.StartObject();
+        writer.Key("product_id");
+        writer.String(product.id.c_str());
+        writer.Key("side");
+        writer.String("buy");
+        writer.Key("type");
+        writer.String("limit");
+        writer.Key("time_in_force");
+        writer.String("GTC");
+        writer.Key("price");
+        writer.String(price);
+        writer.Key("post_only");
+        writer.Bool(false);
+        writer.Key("size");
+        writer.String(size);
+        writer.EndObject();
+        return s.GetSize();
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+
+    Product product;
+    product.id = "BTC-USD";
+    Decimal::parse("0.00000001", 10, product.base_increment);
+    Decimal::parse("0.01", 4, product.quote_increment);
+    OrderTemplate orderTemplate(product, "");
+
+    size_t bytes = 0;
+    auto allocations = bench::allocations();
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < n; ++i) {
+        size_t len;
+        orderTemplate.build(OrderSide::Buy, OrderType::Limit, TimeInForce::GTC, 0.001 + (double)(i % 100) * 1e-5, 48726.63 + (double)(i % 50), 0., false, len);
+        bytes += len;
+    }
+    auto templateNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double)n;
+    auto templateAllocations = (double)(bench::allocations() - allocations) / (double)n;
+
+    allocations = bench::allocations();
+    start = Clock::now();
+    for (uint64_t i = 0; i < n; ++i) {
+        bytes += writeOrder(product, 0.001 + (double)(i % 100) * 1e-5, 48726.63 + (double)(i % 50));
+    }
+    auto writerNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double)n;
+    auto writerAllocations = (double)(bench::allocations() - allocations) / (double)n;
+
+    printf("template: %.1f ns/order, %.3f allocations/order\n", templateNs, templateAllocations);
+    printf("writer: %.1f ns/order, %.3f allocations/order\n", writerNs, writerAllocations);
+    return bytes ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+// Read latency of the QuoteTable while the websocket thread writes every slot as fast as it can.
+//
+//   bench_quote_table [reads]
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "gdax/quote_table.h"
+
+using gdax::Quote;
+using gdax::QuoteTable;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    QuoteTable s_table;
+    constexpr uint32_t s_slots = 32;
+
+    double readNanos(uint64_t reads) {
+        Quote quote;
+        double sum = 0.;
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < reads; ++i) {
+            s_table.read((uint32_t)(i % s_slots), quote);
+            sum += quote.bid;
+        }
+        auto ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double)reads;
+        // keep the reads
+        return sum < 0. ? -ns : ns;
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint64_t reads = argc > 1 ? strtoull(argv[1], nullptr, 10) : 50000000;
+    for (uint32_t i = 0; i < s_slots; ++i) {
+        s_table.add(("P" + std::to_string(i)).c_str());
+        s_table.update(i, 1., 2., 1.5, 0.);
+    }
+    printf("idle writer: %.2f ns per read\n", readNanos(reads));
+
+    std::atomic<bool> stop{ false };
+    std::atomic<uint64_t> updates{ 0 };
+    std::thread writer([&]() {
+        uint64_t n = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            auto bid = (double)++n;
+            s_table.update((uint32_t)(n % s_slots), bid, bid + 1., bid + .5, bid);
+        }
+        updates = n;
+    });
+    auto start = Clock::now();
+    auto ns = readNanos(reads);
+    stop = true;
+    writer.join();
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    printf("busy writer: %.2f ns per read, %.1f M updates/s\n", ns, (double)updates.load() / seconds / 1e6);
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Cost of signing a request with the pre-keyed HmacSigner, compared with keying the HMAC for every request.
+//
+//   bench_signer [signatures]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "gdax/signer.h"
+#include "bench/alloc_counter.h"
+
+using gdax::HmacSigner;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // prehash of an order request: timestamp, method, path and body
+    const char* s_timestamp = "1629000000";
+    const char* s_path = "POST/orders";
+    const char* s_body = R"({"product_id":"BTC-USD","side":"buy","type":"limit","price":"48726.63","size":"0.00102",)"
+        R"("time_in_force":"GTC","post_only":false,"client_oid":"d50ec974-76a2-454b-66f1-35c6b4a9d3b1"})";
+
+    uint8_t s_key[64];
+}
+
+int main(int argc, char** argv) {
+    const uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    for (size_t i = 0; i < sizeof(s_key); ++i) {
+        s_key[i] = (uint8_t)(i * 7 + 1);
+    }
+    const size_t timestampLength = strlen(s_timestamp), pathLength = strlen(s_path), bodyLength = strlen(s_body);
+    char out[HmacSigner::s_base64Size + 1];
+    unsigned checksum = 0;
+
+    HmacSigner signer;
+    signer.setKey(s_key, sizeof(s_key));
+    auto allocations = gdax::bench::allocations();
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < n; ++i) {
+        HmacSigner::Message(signer).update(s_timestamp, timestampLength).update(s_path, pathLength).update(s_body, bodyLength).finalBase64(out);
+        checksum += (unsigned char)out[0];
+    }
+    auto keyedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double)n;
+    auto keyedAllocations = (double)(gdax::bench::allocations() - allocations) / (double)n;
+
+    start = Clock::now();
+    for (uint64_t i = 0; i < n; ++i) {
+        HmacSigner rekeyed;
+        rekeyed.setKey(s_key, sizeof(s_key));
+        HmacSigner::Message(rekeyed).update(s_timestamp, timestampLength).update(s_path, pathLength).update(s_body, bodyLength).finalBase64(out);
+        checksum += (unsigned char)out[0];
+    }
+    auto rekeyedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double)n;
+
+    printf("pre-keyed: %.1f ns/signature, %.3f allocations/signature\n", keyedNs, keyedAllocations);
+    printf("keyed per request: %.1f ns/signature\n", rekeyedNs);
+    return checksum ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+// Stands in for the precompiled header of the plugin in the portable tests.
+// On Windows it includes windows.h like the plugin's, elsewhere it provides the few MSVC functions used
+// by the sources under test.
+
+#pragma once
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+#else
+
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+
+#ifndef __cdecl
+#define __cdecl
+#endif
+
+inline int fopen_s(FILE** file, const char* path, const char* mode) {
+    *file = fopen(path, mode);
+    return *file ? 0 : errno;
+}
+
+inline int localtime_s(struct tm* tm, const time_t* t) {
+    return localtime_r(t, tm) ? 0 : errno;
+}
+
+inline int gmtime_s(struct tm* tm, const time_t* t) {
+    return gmtime_r(t, tm) ? 0 : errno;
+}
+
+#endif
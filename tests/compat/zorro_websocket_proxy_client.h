@@ -0,0 +1,63 @@
+// Stands in for the client of the zorro_websocket_proxy submodule in the portable tests.
+// Nothing is connected: the websocket is opened by calling the callbacks of the plugin, and the sent
+// messages are recorded.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zorro {
+    namespace websocket {
+
+        class WebsocketProxyCallback {
+        public:
+            virtual ~WebsocketProxyCallback() = default;
+            virtual void onWebsocketProxyServerDisconnected() = 0;
+            virtual void onWebsocketOpened(uint32_t id) = 0;
+            virtual void onWebsocketClosed(uint32_t id) = 0;
+            virtual void onWebsocketError(uint32_t id, const char* err, size_t len) = 0;
+            virtual void onWebsocketData(uint32_t id, const char* data, size_t len, size_t remaining) = 0;
+        };
+
+        class ZorroWebsocketProxyClient {
+        public:
+            using BrokerErrorFn = int(__cdecl*)(const char*);
+            using BrokerProgressFn = int(__cdecl*)(const int);
+
+            ZorroWebsocketProxyClient(WebsocketProxyCallback*, const char*, BrokerErrorFn, BrokerProgressFn) {}
+            virtual ~ZorroWebsocketProxyClient() = default;
+
+            bool connect() { return proxyUp; }
+
+            uint32_t openWebSocket(const std::string& url) {
+                if (!proxyUp) {
+                    return 0;
+                }
+                openedUrl = url;
+                return ++lastId;
+            }
+
+            void closeWebSocket(uint32_t id) { closed.push_back(id); }
+
+            bool send(uint32_t id, const char* msg, size_t len) {
+                if (!id || id != lastId) {
+                    return false;
+                }
+                sent.emplace_back(msg, len);
+                return true;
+            }
+
+        public:
+            // test controls and records
+            bool proxyUp = true;
+            uint32_t lastId = 0;
+            std::string openedUrl;
+            std::vector<std::string> sent;
+            std::vector<uint32_t> closed;
+        };
+
+    } // namespace websocket
+} // namespace zorro
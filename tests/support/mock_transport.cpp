@@ -0,0 +1,134 @@
+#include "support/mock_transport.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace gdax {
+
+    namespace {
+        std::unique_ptr<HttpTransport> s_transport = std::make_unique<test::MockHttpTransport>();
+    }
+
+    // in place of http_transport.cpp, which needs WinHTTP
+    HttpTransport& transport() {
+        return *s_transport;
+    }
+
+    void setTransport(std::unique_ptr<HttpTransport> transport) {
+        s_transport = std::move(transport);
+    }
+
+    namespace test {
+
+        MockHttpTransport& MockHttpTransport::install() {
+            auto* mock = new MockHttpTransport();
+            setTransport(std::unique_ptr<HttpTransport>(mock));
+            return *mock;
+        }
+
+        void MockHttpTransport::on(const std::string& route, Handler handler) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            handlers_[route] = std::move(handler);
+        }
+
+        void MockHttpTransport::on(const std::string& route, const std::string& body) {
+            on(route, [body](const MockRequest&) { return MockResponse{ body }; });
+        }
+
+        std::vector<MockRequest> MockHttpTransport::requests() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return requests_;
+        }
+
+        size_t MockHttpTransport::count(const std::string& route) const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return std::count_if(requests_.begin(), requests_.end(), [&route](const MockRequest& r) { return matches(route, r); });
+        }
+
+        void MockHttpTransport::clearRequests() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requests_.clear();
+        }
+
+        size_t MockHttpTransport::inFlight() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return responses_.size();
+        }
+
+        bool MockHttpTransport::matches(const std::string& route, const MockRequest& request) {
+            auto space = route.find(' ');
+            return route.compare(0, space, request.method) == 0 && request.path.compare(0, route.size() - space - 1, route, space + 1) == 0;
+        }
+
+        int MockHttpTransport::send(Lane lane, const char* url, const char* data, const char* headers) {
+            MockRequest request;
+            request.lane = lane;
+            if (!data) {
+                request.method = "GET";
+            }
+            else if (data[0] == '#') {
+                request.method = data + 1;
+            }
+            else {
+                request.method = "POST";
+                request.body = data;
+            }
+            // https://host/path?query
+            auto* host = strstr(url, "://");
+            auto* path = host ? strchr(host + 3, '/') : nullptr;
+            request.path = path ? path : "/";
+            request.headers = headers ? headers : "";
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            request.id = ++nextId_;
+            const Handler* handler = nullptr;
+            size_t longest = 0;
+            for (auto& kvp : handlers_) {
+                if (matches(kvp.first, request) && kvp.first.size() >= longest) {
+                    handler = &kvp.second;
+                    longest = kvp.first.size();
+                }
+            }
+            responses_[request.id] = handler ? (*handler)(request) : MockResponse{ "{\"message\":\"NotFound\"}" };
+            requests_.push_back(request);
+            return request.id;
+        }
+
+        long MockHttpTransport::wait(int id, uint32_t) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = responses_.find(id);
+            if (it == responses_.end()) {
+                return -2;
+            }
+            auto& response = it->second;
+            if (response.pendingWaits) {
+                --response.pendingWaits;
+                return 0;
+            }
+            if (response.error) {
+                return response.error;
+            }
+            return std::max<long>((long)response.body.size(), 1);
+        }
+
+        long MockHttpTransport::result(int id, char* content, long size) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = responses_.find(id);
+            if (it == responses_.end()) {
+                return 0;
+            }
+            auto& body = it->second.body;
+            long n = std::min<long>(size, (long)body.size());
+            memcpy(content, body.data(), n);
+            content[n] = 0;
+            return n;
+        }
+
+        void MockHttpTransport::free(int id) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            responses_.erase(id);
+        }
+
+    } // namespace test
+} // namespace gdax
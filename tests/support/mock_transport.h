@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "http_transport.h"
+
+namespace gdax {
+    namespace test {
+
+        /**
+         * @brief A request as received by the mock server.
+         */
+        struct MockRequest {
+            int id = 0;
+            Lane lane = Lane::Public;
+            // GET, POST or the method after '#' of the data
+            std::string method;
+            // path and query, without scheme and host
+            std::string path;
+            std::string body;
+            std::string headers;
+        };
+
+        struct MockResponse {
+            std::string body;
+            // < 0 for a transport error, see HttpTransport::wait()
+            long error = 0;
+            // number of wait() calls the request stays pending
+            uint32_t pendingWaits = 0;
+        };
+
+        /**
+         * @brief HTTP transport answering from handlers instead of a server, installed as transport().
+         *
+         * A handler is registered for "<METHOD> <path prefix>", the one with the longest matching prefix
+         * answers. Requests without a handler are answered with a Coinbase style error message.
+         * Safe to be used from several threads.
+         */
+        class MockHttpTransport final : public HttpTransport {
+        public:
+            using Handler = std::function<MockResponse(const MockRequest&)>;
+
+            /**
+             * @brief Replace transport() with a new mock, which lives until the next install.
+             */
+            static MockHttpTransport& install();
+
+            void on(const std::string& route, Handler handler);
+            void on(const std::string& route, const std::string& body);
+
+            /**
+             * @brief The requests sent so far, in order.
+             */
+            std::vector<MockRequest> requests() const;
+            size_t count(const std::string& route) const;
+            void clearRequests();
+
+            /**
+             * @brief Number of requests sent and not freed yet.
+             */
+            size_t inFlight() const;
+
+            const char* name() const noexcept override { return "Mock"; }
+            int send(Lane lane, const char* url, const char* data, const char* headers) override;
+            long wait(int id, uint32_t timeout_ms) override;
+            long result(int id, char* content, long size) override;
+            void free(int id) override;
+
+        private:
+            static bool matches(const std::string& route, const MockRequest& request);
+
+        private:
+            mutable std::mutex mutex_;
+            std::map<std::string, Handler> handlers_;
+            std::vector<MockRequest> requests_;
+            std::map<int, MockResponse> responses_;
+            int nextId_ = 0;
+        };
+
+    } // namespace test
+} // namespace gdax
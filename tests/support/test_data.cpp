@@ -0,0 +1,15 @@
+#include "support/test_data.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace gdax {
+    namespace test {
+        std::string readTestData(const char* name) {
+            std::ifstream in(std::string(TEST_DATA_DIR) + "/" + name, std::ios::binary);
+            std::ostringstream content;
+            content << in.rdbuf();
+            return content.str();
+        }
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+namespace gdax {
+    namespace test {
+        /**
+         * @brief Content of a recorded payload in tests/data, empty if it can not be read.
+         */
+        std::string readTestData(const char* name);
+    }
+}
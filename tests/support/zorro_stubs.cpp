@@ -0,0 +1,33 @@
+#include "support/zorro_stubs.h"
+
+#include <mutex>
+
+namespace {
+    std::mutex s_mutex;
+    std::vector<std::string> s_errors;
+
+    int __cdecl brokerError(const char* txt) {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_errors.emplace_back(txt ? txt : "");
+        return 0;
+    }
+
+    int __cdecl brokerProgress(const int) {
+        return 1;
+    }
+}
+
+namespace gdax {
+    // set by BrokerOpen in the plugin
+    int(__cdecl* BrokerError)(const char* txt) = &brokerError;
+    int(__cdecl* BrokerProgress)(const int percent) = &brokerProgress;
+
+    namespace test {
+        std::vector<std::string> takeBrokerErrors() {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            std::vector<std::string> errors;
+            errors.swap(s_errors);
+            return errors;
+        }
+    }
+}
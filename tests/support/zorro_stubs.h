@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace gdax {
+
+    extern int(__cdecl* BrokerError)(const char* txt);
+    extern int(__cdecl* BrokerProgress)(const int percent);
+
+    namespace test {
+        /**
+         * @brief The messages passed to BrokerError since the last call.
+         */
+        std::vector<std::string> takeBrokerErrors();
+    }
+}
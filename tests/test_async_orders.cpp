@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gdax/async_orders.h"
+#include "support/mock_transport.h"
+
+using namespace gdax;
+using gdax::test::MockHttpTransport;
+using gdax::test::MockRequest;
+using gdax::test::MockResponse;
+
+namespace {
+    std::string order(const char* id) {
+        return std::string(R"({"id":")") + id + R"(","price":"100","size":"1","product_id":"BTC-USD","side":"buy","type":"limit","status":"pending"})";
+    }
+
+    int sendOrder(const char* body) {
+        return transport().send(Lane::Private, "https://api.test/orders", body, "");
+    }
+
+    std::vector<OrderAck> drainAll(AsyncOrderTracker& tracker, size_t n) {
+        std::vector<OrderAck> acks;
+        while (acks.size() < n && tracker.wait(5000)) {
+            tracker.drain([&acks](OrderAck& ack) { acks.push_back(std::move(ack)); });
+        }
+        return acks;
+    }
+}
+
+TEST(AsyncOrders, AcksAreQueuedInOrder) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("POST /orders", [](const MockRequest& request) {
+        // the first order is answered last
+        MockResponse response{ order(request.body.c_str()) };
+        response.pendingWaits = request.body == "d50ec984-77a8-460a-b958-66f114b0de9b" ? 20 : 0;
+        return response;
+    });
+
+    std::atomic<int> notified{ 0 };
+    auto tracker = std::make_unique<AsyncOrderTracker>([&notified]() { ++notified; });
+    tracker->track(11, sendOrder("d50ec984-77a8-460a-b958-66f114b0de9b"));
+    tracker->track(12, sendOrder("8ba6dbbd-14a2-47bc-a6a9-5d0e6a4f2f0c"));
+    EXPECT_EQ(tracker->pending(), 2u);
+
+    auto acks = drainAll(*tracker, 2);
+    ASSERT_EQ(acks.size(), 2u);
+    EXPECT_EQ(acks[0].trade_id, 11);
+    ASSERT_TRUE(acks[0].response) << acks[0].response.what();
+    EXPECT_EQ(acks[0].response.content().id.str(), "d50ec984-77a8-460a-b958-66f114b0de9b");
+    EXPECT_EQ(acks[0].response.content().status, OrderStatus::Pending);
+    EXPECT_EQ(acks[1].trade_id, 12);
+    EXPECT_EQ(acks[1].response.content().id.str(), "8ba6dbbd-14a2-47bc-a6a9-5d0e6a4f2f0c");
+    EXPECT_EQ(tracker->pending(), 0u);
+    EXPECT_EQ(mock.inFlight(), 0u);
+
+    // the worker notifies after queueing the ack
+    tracker.reset();
+    EXPECT_EQ(notified, 2);
+}
+
+TEST(AsyncOrders, RejectedOrderIsAcked) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("POST /orders", R"({"message":"Insufficient funds"})");
+
+    AsyncOrderTracker tracker(nullptr);
+    tracker.track(3, sendOrder("{}"));
+    auto acks = drainAll(tracker, 1);
+    ASSERT_EQ(acks.size(), 1u);
+    EXPECT_EQ(acks[0].trade_id, 3);
+    EXPECT_FALSE(acks[0].response);
+    EXPECT_EQ(acks[0].response.what(), "Insufficient funds");
+    EXPECT_EQ(tracker.pending(), 0u);
+}
+
+TEST(AsyncOrders, DrainIsReentrant) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("POST /orders", [](const MockRequest& request) { return MockResponse{ order(request.body.c_str()) }; });
+
+    AsyncOrderTracker tracker(nullptr);
+    tracker.track(1, sendOrder("d50ec984-77a8-460a-b958-66f114b0de9b"));
+    ASSERT_TRUE(tracker.wait(5000));
+
+    // an ack arriving while the first one is applied, e.g. drained by GET_CALLBACK from BrokerProgress
+    std::vector<int32_t> applied;
+    tracker.drain([&](OrderAck& ack) {
+        tracker.track(2, sendOrder("8ba6dbbd-14a2-47bc-a6a9-5d0e6a4f2f0c"));
+        ASSERT_TRUE(tracker.wait(5000));
+        tracker.drain([&applied](OrderAck& nested) { applied.push_back(nested.trade_id); });
+        applied.push_back(ack.trade_id);
+    });
+    EXPECT_EQ(applied, (std::vector<int32_t>{ 2, 1 }));
+    EXPECT_EQ(tracker.pending(), 0u);
+}
+
+TEST(AsyncOrders, RequestsInFlightAreFreedOnDestruction) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("POST /orders", [](const MockRequest& request) {
+        MockResponse response{ order(request.body.c_str()) };
+        response.pendingWaits = UINT32_MAX;
+        return response;
+    });
+
+    {
+        AsyncOrderTracker tracker(nullptr);
+        tracker.track(1, sendOrder("d50ec984-77a8-460a-b958-66f114b0de9b"));
+        tracker.track(2, sendOrder("8ba6dbbd-14a2-47bc-a6a9-5d0e6a4f2f0c"));
+        EXPECT_EQ(tracker.pending(), 2u);
+        EXPECT_FALSE(tracker.wait(10));
+    }
+    EXPECT_EQ(mock.inFlight(), 0u);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "rapidjson/reader.h"
+#include "gdax/candle.h"
+#include "support/test_data.h"
+
+using gdax::Candle;
+
+namespace {
+    using OnCandle = std::function<bool(const Candle&)>;
+
+    struct Result {
+        std::vector<Candle> candles;
+        uint32_t count = 0;
+        bool stopped = false;
+        bool parseError = false;
+        std::string error;
+    };
+
+    Result parse(std::string payload, uint32_t start, uint32_t end, size_t stopAfter = SIZE_MAX) {
+        Result result;
+        OnCandle onCandle = [&result, stopAfter](const Candle& candle) {
+            result.candles.push_back(candle);
+            return result.candles.size() < stopAfter;
+        };
+        gdax::CandleHandler<OnCandle> handler(start, end, onCandle);
+        rapidjson::Reader reader;
+        rapidjson::InsituStringStream ss(&payload[0]);
+        result.parseError = reader.Parse<rapidjson::kParseInsituFlag>(ss, handler).IsError();
+        result.count = handler.count();
+        result.stopped = handler.stopped();
+        result.error = handler.error();
+        return result;
+    }
+}
+
+TEST(CandleHandler, RecordedPage) {
+    // 300 one-minute candles, newest first, ending at 1629000000
+    auto result = parse(gdax::test::readTestData("candles.json"), 0, UINT32_MAX);
+    ASSERT_FALSE(result.parseError);
+    EXPECT_TRUE(result.error.empty());
+    EXPECT_FALSE(result.stopped);
+    ASSERT_EQ(result.candles.size(), 300u);
+    EXPECT_EQ(result.count, 300u);
+    EXPECT_EQ(result.candles.front().time, 1629000000u);
+    EXPECT_EQ(result.candles.back().time, 1629000000u - 299 * 60);
+    for (auto& candle : result.candles) {
+        ASSERT_LE(candle.low, candle.high);
+        ASSERT_LE(candle.low, std::min(candle.open, candle.close));
+        ASSERT_GE(candle.high, std::max(candle.open, candle.close));
+        ASSERT_GE(candle.volume, 0.);
+    }
+}
+
+TEST(CandleHandler, Fields) {
+    auto result = parse(R"([[1629000000,48700.1,48750,48710.5,48720,12.5],[1628999940,1,2,"1.5",1.75,null]])", 0, UINT32_MAX);
+    ASSERT_FALSE(result.parseError);
+    ASSERT_EQ(result.candles.size(), 2u);
+    auto& c = result.candles[0];
+    EXPECT_EQ(c.time, 1629000000u);
+    EXPECT_EQ(c.low, 48700.1);
+    EXPECT_EQ(c.high, 48750.);
+    EXPECT_EQ(c.open, 48710.5);
+    EXPECT_EQ(c.close, 48720.);
+    EXPECT_EQ(c.volume, 12.5);
+    // numbers as strings and null
+    EXPECT_EQ(result.candles[1].open, 1.5);
+    EXPECT_TRUE(std::isnan(result.candles[1].volume));
+}
+
+TEST(CandleHandler, SkipsCandlesOutsideTheWindow) {
+    const uint32_t end = 1629000000 - 10 * 60;
+    const uint32_t start = end - 99 * 60;
+    auto result = parse(gdax::test::readTestData("candles.json"), start, end);
+    ASSERT_FALSE(result.parseError);
+    ASSERT_EQ(result.candles.size(), 100u);
+    EXPECT_EQ(result.count, 100u);
+    EXPECT_EQ(result.candles.front().time, end);
+    EXPECT_EQ(result.candles.back().time, start);
+
+    // incomplete candles are skipped too
+    auto incomplete = parse("[[1629000000,1,2,3],[1628999940,1,2,3,4,5]]", 0, UINT32_MAX);
+    ASSERT_EQ(incomplete.candles.size(), 1u);
+    EXPECT_EQ(incomplete.candles[0].time, 1628999940u);
+
+    auto empty = parse("[]", 0, UINT32_MAX);
+    EXPECT_FALSE(empty.parseError);
+    EXPECT_EQ(empty.count, 0u);
+}
+
+TEST(CandleHandler, StopsWhenAsked) {
+    auto result = parse(gdax::test::readTestData("candles.json"), 0, UINT32_MAX, 10);
+    EXPECT_TRUE(result.stopped);
+    EXPECT_TRUE(result.parseError);
+    EXPECT_EQ(result.candles.size(), 10u);
+}
+
+TEST(CandleHandler, ErrorObject) {
+    auto result = parse(R"({"message":"granularity too small"})", 0, UINT32_MAX);
+    EXPECT_EQ(result.error, "granularity too small");
+    EXPECT_TRUE(result.candles.empty());
+
+    auto unexpected = parse(R"({"candles":[]})", 0, UINT32_MAX);
+    EXPECT_FALSE(unexpected.error.empty());
+
+    auto nested = parse(R"([[1629000000,[1],2,3,4,5]])", 0, UINT32_MAX);
+    EXPECT_TRUE(nested.parseError);
+}
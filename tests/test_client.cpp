@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gdax/client.h"
+#include "support/mock_transport.h"
+#include "support/test_data.h"
+
+using namespace gdax;
+using gdax::test::MockHttpTransport;
+using gdax::test::readTestData;
+
+namespace {
+    Client makeClient() {
+        return Client("key", "passphrase", "c2VjcmV0", true);
+    }
+}
+
+TEST(Client, WarmUpSendsOnlyTheProductsRequest) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("GET /products", readTestData("products.json"));
+
+    auto client = makeClient();
+    client.warmUp();
+
+    auto requests = mock.requests();
+    ASSERT_EQ(requests.size(), 1u);
+    EXPECT_EQ(requests[0].path, "/products");
+    EXPECT_EQ(requests[0].lane, Lane::Public);
+    EXPECT_EQ(client.getProducts().size(), 12u);
+
+    // the products are cached, the strategy does not pay for them again
+    ASSERT_NE(client.getProduct("BTC-USD"), nullptr);
+    EXPECT_EQ(mock.requests().size(), 1u);
+}
+
+namespace {
+    const char* s_ltcOrder = R"({"id":"3aa5add7-7507-4d7b-8194-9e487d265665","size":"0.24198753","product_id":"LTC-USD","side":"buy","type":"market","time_in_force":"GTC","post_only":false,"created_at":"2021-08-14T04:10:20.620647Z","fill_fees":"0","filled_size":"0","executed_value":"0","status":"open","settled":false})";
+    const char* s_solOrder = R"({"id":"89f13f6d-dcc6-40fc-8abd-a6788c286ad0","price":"10147.25","size":"1.50632503","product_id":"SOL-USD","side":"sell","type":"limit","time_in_force":"GTC","post_only":false,"created_at":"2021-08-15T03:59:53.070978Z","fill_fees":"0","filled_size":"0","executed_value":"0","status":"open","settled":false})";
+    const char* s_solOrderDone = R"({"id":"89f13f6d-dcc6-40fc-8abd-a6788c286ad0","price":"10147.25","size":"1.50632503","product_id":"SOL-USD","side":"sell","type":"limit","time_in_force":"GTC","post_only":false,"created_at":"2021-08-15T03:59:53.070978Z","fill_fees":"0.1","filled_size":"1.50632503","executed_value":"15284.91","status":"done","done_reason":"filled","settled":true})";
+
+    void cacheOrders(MockHttpTransport& mock, Client& client) {
+        mock.on("GET /orders/3aa5add7", s_ltcOrder);
+        mock.on("GET /orders/89f13f6d", s_solOrder);
+        ASSERT_TRUE(client.getOrder(std::string("3aa5add7-7507-4d7b-8194-9e487d265665")));
+        ASSERT_TRUE(client.getOrder(std::string("89f13f6d-dcc6-40fc-8abd-a6788c286ad0")));
+        mock.clearRequests();
+    }
+}
+
+TEST(Client, SweepAsksForTheLargestPage) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("GET /orders?", readTestData("orders.json"));
+    auto client = makeClient();
+    cacheOrders(mock, client);
+
+    auto response = client.sweepOrders();
+    ASSERT_TRUE(response) << response.what();
+    EXPECT_EQ(response.content(), 25u);
+
+    // both cached orders are open, no request of their own
+    auto requests = mock.requests();
+    ASSERT_EQ(requests.size(), 1u);
+    EXPECT_EQ(requests[0].path, "/orders?limit=1000");
+    EXPECT_EQ(requests[0].lane, Lane::Private);
+}
+
+TEST(Client, SweepRequestsTheFinishedOrders) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("GET /orders?", std::string("[") + s_ltcOrder + "]");
+    auto client = makeClient();
+    cacheOrders(mock, client);
+    mock.on("GET /orders/89f13f6d", s_solOrderDone);
+
+    auto response = client.sweepOrders();
+    ASSERT_TRUE(response) << response.what();
+    EXPECT_EQ(response.content(), 1u);
+    EXPECT_EQ(mock.count("GET /orders?limit=1000"), 1u);
+    EXPECT_EQ(mock.count("GET /orders/89f13f6d"), 1u);
+    EXPECT_EQ(mock.count("GET /orders/3aa5add7"), 0u);
+
+    Uuid id;
+    ASSERT_TRUE(Uuid::parse("89f13f6d-dcc6-40fc-8abd-a6788c286ad0", 36, id));
+    auto* order = client.findOrder(id);
+    ASSERT_NE(order, nullptr);
+    EXPECT_EQ(order->status, OrderStatus::Done);
+}
+
+namespace {
+    constexpr uint32_t s_candlesEnd = 1629000000;
+    constexpr uint32_t s_windowSpan = 299 * 60;
+
+    // one candle in the minute of the end of the index-th 1-minute window, an empty window if not in candles
+    MockHttpTransport::Handler candleWindows(std::vector<bool> candles) {
+        auto index = std::make_shared<size_t>(0);
+        return [index, candles](const test::MockRequest&) {
+            size_t i = (*index)++;
+            if (i >= candles.size() || !candles[i]) {
+                return test::MockResponse{ "[]" };
+            }
+            uint32_t end = s_candlesEnd - (uint32_t)i * (s_windowSpan + 1);
+            uint32_t time = end - end % 60;
+            return test::MockResponse{ "[[" + std::to_string(time) + ",1.5,2.5,2,2.25,10]]" };
+        };
+    }
+}
+
+TEST(Client, CandleDownloadStopsAfterEmptyWindows) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("GET /products/BTC-USD/candles", candleWindows({}));
+    auto client = makeClient();
+
+    uint32_t start = s_candlesEnd - 20 * (s_windowSpan + 1);
+    auto response = client.getCandles("BTC-USD", start, s_candlesEnd, 60, 10000, [](const Candle&) { return true; });
+    ASSERT_TRUE(response) << response.what();
+    EXPECT_EQ(response.content(), 0u);
+
+    // 4 empty windows in a row, plus at most the requests in flight behind them
+    auto sent = mock.count("GET /products/BTC-USD/candles");
+    EXPECT_GE(sent, 4u);
+    EXPECT_LE(sent, 6u);
+    EXPECT_EQ(mock.inFlight(), 0u);
+}
+
+TEST(Client, CandleDownloadSkipsGaps) {
+    auto& mock = MockHttpTransport::install();
+    // 3 empty windows between the first and the last
+    mock.on("GET /products/BTC-USD/candles", candleWindows({ true, false, false, false, true }));
+    auto client = makeClient();
+
+    std::vector<uint32_t> times;
+    uint32_t start = s_candlesEnd - 5 * (s_windowSpan + 1) + 1;
+    auto response = client.getCandles("BTC-USD", start, s_candlesEnd, 60, 10000, [&times](const Candle& candle) {
+        times.push_back(candle.time);
+        return true;
+    });
+    ASSERT_TRUE(response) << response.what();
+    EXPECT_EQ(response.content(), 2u);
+    ASSERT_EQ(times.size(), 2u);
+    EXPECT_GT(times[0], times[1]);
+    EXPECT_EQ(mock.count("GET /products/BTC-USD/candles"), 5u);
+    EXPECT_EQ(mock.inFlight(), 0u);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "gdax/decimal.h"
+#include "gdax/json.h"
+
+using gdax::Decimal;
+
+namespace {
+    Decimal parse(const std::string& s) {
+        Decimal d = Decimal::invalid();
+        EXPECT_TRUE(Decimal::parse(s.c_str(), s.size(), d)) << s;
+        return d;
+    }
+
+    std::string format(Decimal d, int32_t decimals = -1) {
+        char buf[32];
+        auto n = d.format(buf, decimals);
+        return std::string(buf, n);
+    }
+
+    bool parses(const std::string& s) {
+        Decimal d;
+        return Decimal::parse(s.c_str(), s.size(), d);
+    }
+}
+
+TEST(Decimal, ParseAndFormat) {
+    EXPECT_EQ(parse("123.45").raw(), 12345000000);
+    EXPECT_EQ(parse("-0.00000001").raw(), -1);
+    EXPECT_EQ(parse("+7").raw(), 700000000);
+    EXPECT_EQ(parse(".5").raw(), 50000000);
+    EXPECT_EQ(parse("3.").raw(), 300000000);
+    // digits beyond 8 decimals are truncated
+    EXPECT_EQ(parse("0.123456789").raw(), 12345678);
+
+    EXPECT_EQ(format(parse("123.4500")), "123.45");
+    EXPECT_EQ(format(parse("123.45"), 4), "123.4500");
+    EXPECT_EQ(format(parse("123.456"), 2), "123.45");
+    EXPECT_EQ(format(parse("-0.5")), "-0.5");
+    EXPECT_EQ(format(parse("0")), "0");
+    EXPECT_EQ(parse("0.01").decimals(), 2);
+    EXPECT_EQ(parse("1").decimals(), 0);
+}
+
+TEST(Decimal, RejectsInvalidStrings) {
+    EXPECT_FALSE(parses(""));
+    EXPECT_FALSE(parses("-"));
+    EXPECT_FALSE(parses("."));
+    EXPECT_FALSE(parses("1e5"));
+    EXPECT_FALSE(parses("1.2.3"));
+    EXPECT_FALSE(parses(" 1"));
+    EXPECT_FALSE(parses("abc"));
+}
+
+TEST(Decimal, Range) {
+    constexpr int64_t maxIntegral = INT64_MAX / Decimal::s_unit - 1;
+    EXPECT_TRUE(parses(std::to_string(maxIntegral) + ".99999999"));
+    EXPECT_FALSE(parses(std::to_string(maxIntegral + 1)));
+    EXPECT_FALSE(parses("99999999999999999999999"));
+    EXPECT_FALSE(Decimal::fromDouble(1e11).isValid());
+    EXPECT_FALSE(Decimal::fromDouble(NAN).isValid());
+    EXPECT_EQ(Decimal::fromDouble(0.1).raw(), 10000000);
+}
+
+TEST(Decimal, Ticks) {
+    auto tick = parse("0.01");
+    EXPECT_EQ(parse("1.234").floorToTick(tick), parse("1.23"));
+    EXPECT_EQ(parse("1.234").ceilToTick(tick), parse("1.24"));
+    EXPECT_EQ(parse("1.235").roundToTick(tick), parse("1.24"));
+    EXPECT_EQ(parse("1.2349").roundToTick(tick), parse("1.23"));
+    EXPECT_EQ(parse("-1.234").floorToTick(tick), parse("-1.24"));
+    EXPECT_EQ(parse("-1.234").ceilToTick(tick), parse("-1.23"));
+    EXPECT_EQ(parse("1.20").ceilToTick(tick), parse("1.2"));
+    EXPECT_EQ(parse("0.129").ticks(tick), 12);
+    EXPECT_EQ(parse("1").ticks(Decimal()), 0);
+}
+
+TEST(Decimal, FormatParseRoundTrip) {
+    std::mt19937_64 rng(20210216);
+    std::uniform_int_distribution<int64_t> raw(-(INT64_MAX / 2), INT64_MAX / 2);
+    char buf[32];
+    for (int i = 0; i < 100000; ++i) {
+        auto d = Decimal::fromRaw(raw(rng) / Decimal::s_unit * Decimal::s_unit / 2 + raw(rng) % Decimal::s_unit);
+        auto n = d.format(buf);
+        Decimal back;
+        ASSERT_TRUE(Decimal::parse(buf, n, back)) << buf;
+        ASSERT_EQ(back, d) << buf;
+    }
+}
+
+TEST(Decimal, ReadJson) {
+    gdax::JsonDocument d;
+    d.Parse(R"({"s":"1.5","i":2,"f":0.25,"big":100000000000,"nan":"x","b":true})");
+    ASSERT_FALSE(d.HasParseError());
+
+    Decimal value;
+    EXPECT_TRUE(gdax::readJson(d["s"], value));
+    EXPECT_EQ(value, parse("1.5"));
+    EXPECT_TRUE(gdax::readJson(d["i"], value));
+    EXPECT_EQ(value, parse("2"));
+    EXPECT_TRUE(gdax::readJson(d["f"], value));
+    EXPECT_EQ(value, parse("0.25"));
+
+    // out of range and invalid values keep the current value
+    EXPECT_FALSE(gdax::readJson(d["big"], value));
+    EXPECT_FALSE(gdax::readJson(d["nan"], value));
+    EXPECT_FALSE(gdax::readJson(d["b"], value));
+    EXPECT_EQ(value, parse("0.25"));
+}
+
+TEST(Decimal, ParseDouble) {
+    double value = 0.;
+    EXPECT_TRUE(gdax::parseDouble("912345678901234.5", 17, value));
+    EXPECT_DOUBLE_EQ(value, 912345678901234.5);
+    // not null-terminated
+    EXPECT_TRUE(gdax::parseDouble("12.5xyz", 4, value));
+    EXPECT_DOUBLE_EQ(value, 12.5);
+    EXPECT_FALSE(gdax::parseDouble("12x", 3, value));
+    EXPECT_FALSE(gdax::parseDouble("", 0, value));
+    EXPECT_DOUBLE_EQ(value, 12.5);
+}
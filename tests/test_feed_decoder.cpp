@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "gdax/feed.h"
+
+using namespace gdax;
+
+namespace {
+    struct Recorder : FeedListener {
+        std::vector<FeedTicker> tickers;
+        std::vector<FeedL2Update> updates;
+        std::vector<FeedHeartbeat> heartbeats;
+        std::vector<FeedMatch> matches;
+        std::vector<FeedOrder> orders;
+        std::vector<FeedError> errors;
+        std::vector<FeedType> others;
+
+        void onFeedTicker(const FeedTicker& msg) { tickers.push_back(msg); }
+        void onFeedL2Update(const FeedL2Update& msg) { updates.push_back(msg); }
+        void onFeedHeartbeat(const FeedHeartbeat& msg) { heartbeats.push_back(msg); }
+        void onFeedMatch(const FeedMatch& msg) { matches.push_back(msg); }
+        void onFeedOrder(const FeedOrder& msg) { orders.push_back(msg); }
+        void onFeedError(const FeedError& msg) { errors.push_back(msg); }
+        void onFeedMessage(FeedType type, const char*, size_t) { others.push_back(type); }
+    };
+
+    struct FeedDecoderTest : ::testing::Test {
+        Recorder recorder;
+        FeedDecoder<Recorder> decoder{ recorder };
+
+        bool decode(const std::string& json) { return decoder.decode(json.data(), json.size()); }
+    };
+
+    Decimal dec(const char* s) {
+        Decimal d;
+        EXPECT_TRUE(Decimal::parse(s, strlen(s), d)) << s;
+        return d;
+    }
+}
+
+TEST(FeedType, EveryNameMapsToItsType) {
+    for (size_t i = 0; i < feed::s_typeCount; ++i) {
+        auto name = feed::s_typeNames[i];
+        EXPECT_EQ(to_feedType(name, strlen(name)), (FeedType)(i + 1)) << name;
+    }
+    EXPECT_EQ(to_feedType("", 0), FeedType::Unknown);
+    EXPECT_EQ(to_feedType("tick", 4), FeedType::Unknown);
+    EXPECT_EQ(to_feedType("tickers", 7), FeedType::Unknown);
+    EXPECT_EQ(to_feedType("matches", 7), FeedType::Unknown);
+    // a name which shares the slot and length of a known type
+    EXPECT_EQ(to_feedType("tacker", 6), FeedType::Unknown);
+}
+
+TEST_F(FeedDecoderTest, Ticker) {
+    ASSERT_TRUE(decode(R"({"type":"ticker","sequence":29912239716,"product_id":"BTC-USD","price":"48726.63",)"
+        R"("open_24h":"47450.01","volume_24h":"18022.45389513","low_24h":"47107.36","high_24h":"49000",)"
+        R"("volume_30d":"540000.1","best_bid":"48726.62","best_ask":"48726.63","side":"buy",)"
+        R"("time":"2021-08-14T20:42:27.265123Z","trade_id":201766453,"last_size":"0.00102"})"));
+    ASSERT_EQ(recorder.tickers.size(), 1u);
+    auto& t = recorder.tickers[0];
+    EXPECT_EQ(t.type, FeedType::Ticker);
+    EXPECT_EQ(t.sequence, 29912239716u);
+    EXPECT_STREQ(t.product_id.c_str(), "BTC-USD");
+    EXPECT_EQ(t.price, dec("48726.63"));
+    EXPECT_EQ(t.best_bid, dec("48726.62"));
+    EXPECT_EQ(t.best_ask, dec("48726.63"));
+    EXPECT_EQ(t.last_size, dec("0.00102"));
+    EXPECT_DOUBLE_EQ(t.volume_24h, 18022.45389513);
+    EXPECT_EQ(t.side, OrderSide::Buy);
+    EXPECT_EQ(t.trade_id, 201766453u);
+    int64_t time;
+    ASSERT_TRUE(parseTimestamp("2021-08-14T20:42:27.265123Z", 27, time));
+    EXPECT_EQ(t.time, time);
+}
+
+TEST_F(FeedDecoderTest, TickerVolumeAboveDecimalRange) {
+    ASSERT_TRUE(decode(R"({"type":"ticker","product_id":"SHIB-USD","price":"0.00000712","volume_24h":"912345678901234.5"})"));
+    ASSERT_EQ(recorder.tickers.size(), 1u);
+    EXPECT_DOUBLE_EQ(recorder.tickers[0].volume_24h, 912345678901234.5);
+    EXPECT_FALSE(recorder.tickers[0].best_bid.isValid());
+}
+
+TEST_F(FeedDecoderTest, L2Update) {
+    ASSERT_TRUE(decode(R"({"type":"l2update","product_id":"ETH-USD","changes":[["buy","3015.12","0.5"],)"
+        R"(["sell","3015.50","0"]],"time":"2021-08-14T20:42:27.265Z"})"));
+    ASSERT_EQ(recorder.updates.size(), 1u);
+    auto& u = recorder.updates[0];
+    EXPECT_STREQ(u.product_id.c_str(), "ETH-USD");
+    ASSERT_EQ(u.count, 2u);
+    EXPECT_FALSE(u.truncated);
+    EXPECT_EQ(u.changes[0].side, OrderSide::Buy);
+    EXPECT_EQ(u.changes[0].price, dec("3015.12"));
+    EXPECT_EQ(u.changes[0].size, dec("0.5"));
+    EXPECT_EQ(u.changes[1].side, OrderSide::Sell);
+    EXPECT_EQ(u.changes[1].size, Decimal());
+}
+
+TEST_F(FeedDecoderTest, L2UpdateDropsChangesBeyondTheLimit) {
+    std::string json = R"({"type":"l2update","product_id":"ETH-USD","changes":[)";
+    for (uint32_t i = 0; i < FeedL2Update::s_maxChanges + 3; ++i) {
+        json += (i ? "," : "") + std::string(R"(["buy",")") + std::to_string(i + 1) + R"(","1"])";
+    }
+    json += "]}";
+    ASSERT_TRUE(decode(json));
+    auto& u = recorder.updates.at(0);
+    EXPECT_EQ(u.count, FeedL2Update::s_maxChanges);
+    EXPECT_TRUE(u.truncated);
+    EXPECT_EQ(u.changes[FeedL2Update::s_maxChanges - 1].price, Decimal::fromRaw((int64_t)FeedL2Update::s_maxChanges * Decimal::s_unit));
+}
+
+TEST_F(FeedDecoderTest, MatchAndOrderMessages) {
+    ASSERT_TRUE(decode(R"({"type":"match","trade_id":10,"sequence":50,"maker_order_id":"ac928c66-ca53-498f-9c13-a110027a60e8",)"
+        R"("taker_order_id":"132fb6ae-456b-4654-b4e0-d681ac05cea1","time":"2014-11-07T08:19:27.028459Z",)"
+        R"("product_id":"BTC-USD","size":"5.23512","price":"400.23","side":"sell","taker_fee_rate":"0.005"})"));
+    ASSERT_TRUE(decode(R"({"type":"last_match","trade_id":11,"product_id":"BTC-USD","size":"1","price":"400.24","side":"buy"})"));
+    ASSERT_EQ(recorder.matches.size(), 2u);
+    auto& m = recorder.matches[0];
+    EXPECT_EQ(m.type, FeedType::Match);
+    EXPECT_EQ(m.trade_id, 10u);
+    EXPECT_EQ(m.maker_order_id.str(), "ac928c66-ca53-498f-9c13-a110027a60e8");
+    EXPECT_EQ(m.taker_order_id.str(), "132fb6ae-456b-4654-b4e0-d681ac05cea1");
+    EXPECT_EQ(m.size, dec("5.23512"));
+    EXPECT_EQ(m.side, OrderSide::Sell);
+    EXPECT_EQ(m.taker_fee_rate, dec("0.005"));
+    EXPECT_FALSE(m.maker_fee_rate.isValid());
+    EXPECT_EQ(recorder.matches[1].type, FeedType::LastMatch);
+
+    ASSERT_TRUE(decode(R"({"type":"received","time":"2014-11-07T08:19:27.028459Z","product_id":"BTC-USD","sequence":10,)"
+        R"("order_id":"d50ec984-77a8-460a-b958-66f114b0de9b","size":"1.34","price":"502.1","side":"buy",)"
+        R"("order_type":"limit","client_oid":"d50ec974-76a2-454b-66f1-35c6b4a9d3b1"})"));
+    ASSERT_TRUE(decode(R"({"type":"done","time":"2014-11-07T08:19:27.028459Z","product_id":"BTC-USD","sequence":10,)"
+        R"("price":"200.2","order_id":"d50ec984-77a8-460a-b958-66f114b0de9b","reason":"filled","side":"sell","remaining_size":"0"})"));
+    ASSERT_TRUE(decode(R"({"type":"received","order_id":"dddec984-77a8-460a-b958-66f114b0de9b","order_type":"market","funds":"3000.234","side":"buy"})"));
+    ASSERT_EQ(recorder.orders.size(), 3u);
+    auto& r = recorder.orders[0];
+    EXPECT_EQ(r.type, FeedType::Received);
+    EXPECT_EQ(r.order_id.str(), "d50ec984-77a8-460a-b958-66f114b0de9b");
+    EXPECT_STREQ(r.client_oid.c_str(), "d50ec974-76a2-454b-66f1-35c6b4a9d3b1");
+    EXPECT_EQ(r.order_type, OrderType::Limit);
+    EXPECT_EQ(r.price, dec("502.1"));
+    auto& d = recorder.orders[1];
+    EXPECT_EQ(d.type, FeedType::Done);
+    EXPECT_STREQ(d.reason.c_str(), "filled");
+    EXPECT_EQ(d.remaining_size, Decimal());
+    EXPECT_EQ(recorder.orders[2].order_type, OrderType::Market);
+    EXPECT_EQ(recorder.orders[2].funds, dec("3000.234"));
+}
+
+TEST_F(FeedDecoderTest, HeartbeatErrorAndOtherMessages) {
+    ASSERT_TRUE(decode(R"({"type":"heartbeat","sequence":90,"last_trade_id":20,"product_id":"BTC-USD","time":"2014-11-07T08:19:28.464459Z"})"));
+    ASSERT_TRUE(decode(R"({"type":"error","message":"Failed to subscribe","reason":"ETH-XYZ is not a valid product"})"));
+    ASSERT_TRUE(decode(R"({"type":"subscriptions","channels":[{"name":"level2","product_ids":["ETH-USD"]}]})"));
+    ASSERT_TRUE(decode(R"({"type":"snapshot","product_id":"ETH-USD","bids":[["10.1","1"]],"asks":[["10.2","1"]]})"));
+    ASSERT_TRUE(decode(R"({"type" : "unknown_type"})"));
+
+    ASSERT_EQ(recorder.heartbeats.size(), 1u);
+    EXPECT_EQ(recorder.heartbeats[0].last_trade_id, 20u);
+    EXPECT_EQ(recorder.heartbeats[0].sequence, 90u);
+    ASSERT_EQ(recorder.errors.size(), 1u);
+    EXPECT_STREQ(recorder.errors[0].message.c_str(), "Failed to subscribe");
+    EXPECT_STREQ(recorder.errors[0].reason.c_str(), "ETH-XYZ is not a valid product");
+    ASSERT_EQ(recorder.others.size(), 3u);
+    EXPECT_EQ(recorder.others[0], FeedType::Subscriptions);
+    EXPECT_EQ(recorder.others[1], FeedType::Snapshot);
+    EXPECT_EQ(recorder.others[2], FeedType::Unknown);
+}
+
+TEST_F(FeedDecoderTest, RejectsInvalidMessages) {
+    EXPECT_FALSE(decode(R"({"product_id":"BTC-USD"})"));
+    EXPECT_FALSE(decode(R"({"type":1})"));
+    EXPECT_FALSE(decode(R"({"type":"ticker","price":"1")"));
+    EXPECT_FALSE(decode(R"({"type":"ticker)"));
+    EXPECT_TRUE(recorder.tickers.empty());
+}
+
+TEST_F(FeedDecoderTest, UnknownOrderTypeKeepsTheDefault) {
+    // a new order type of Coinbase does not assert, the event of the order is still delivered
+    ASSERT_TRUE(decode(R"({"type":"received","order_id":"d50ec984-77a8-460a-b958-66f114b0de9b","order_type":"stop","side":"sell"})"));
+    ASSERT_EQ(recorder.orders.size(), 1u);
+    EXPECT_EQ(recorder.orders[0].order_type, OrderType::Limit);
+    EXPECT_EQ(recorder.orders[0].side, OrderSide::Sell);
+    EXPECT_EQ(recorder.orders[0].order_id.str(), "d50ec984-77a8-460a-b958-66f114b0de9b");
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "response.h"
+#include "gdax/account.h"
+#include "gdax/fill.h"
+#include "gdax/json.h"
+#include "gdax/order.h"
+#include "gdax/ticker.h"
+#include "gdax/time.h"
+#include "support/test_data.h"
+
+using namespace gdax;
+
+namespace {
+    template<typename T>
+    Response<T> parse(std::string payload) {
+        Response<T> response;
+        response.parseContent(&payload[0], nullptr);
+        return response;
+    }
+
+    Decimal dec(const char* s) {
+        Decimal d;
+        EXPECT_TRUE(Decimal::parse(s, strlen(s), d)) << s;
+        return d;
+    }
+
+    // the keys are dispatched by a switch, so the hash is usable as a case label
+    static_assert("id"_field == fieldHash("id", 2), "field hash is not constexpr");
+    static_assert("id"_field != "ids"_field && "size"_field != "side"_field, "field hashes collide");
+}
+
+TEST(FieldTable, FnvHash) {
+    // FNV-1a 64 of "" and "a"
+    EXPECT_EQ(fieldHash("", 0), 0xcbf29ce484222325ull);
+    EXPECT_EQ(fieldHash("a", 1), 0xaf63dc4c8601ec8cull);
+    EXPECT_EQ(fieldHash("product_id", 10), "product_id"_field);
+}
+
+TEST(FieldTable, Accounts) {
+    auto accounts = parse<std::vector<Account>>(test::readTestData("accounts.json"));
+    ASSERT_TRUE(accounts) << accounts.what();
+    ASSERT_EQ(accounts.content().size(), 10u);
+    auto& a = accounts.content()[0];
+    EXPECT_EQ(a.id, "657f76f9-edf1-4354-9aa4-f8251453aeca");
+    EXPECT_EQ(a.currency, "BTC");
+    EXPECT_EQ(a.profile_id, "8058d771-2d88-4f0f-ab6e-299c153d4308");
+    EXPECT_DOUBLE_EQ(a.balance, 927.2315996205568354);
+    EXPECT_DOUBLE_EQ(a.hold, 166.8572488583813822);
+    EXPECT_DOUBLE_EQ(a.available, 760.3743507621754816);
+    EXPECT_TRUE(a.trading_enabled);
+}
+
+TEST(FieldTable, Fills) {
+    auto fills = parse<std::vector<Fill>>(test::readTestData("fills.json"));
+    ASSERT_TRUE(fills) << fills.what();
+    ASSERT_EQ(fills.content().size(), 30u);
+    auto& f = fills.content()[0];
+    EXPECT_EQ(f.product_id, "ETH-USD");
+    EXPECT_EQ(f.order_id, "f7a227a0-4574-4a68-a3b0-93a00e6c8ce6");
+    EXPECT_EQ(f.price, dec("14333.10"));
+    EXPECT_EQ(f.size, dec("0.84970914"));
+    EXPECT_EQ(f.fee, dec("0.91111314"));
+    EXPECT_EQ(f.side, OrderSide::Buy);
+    EXPECT_TRUE(f.settled);
+    int64_t created;
+    ASSERT_TRUE(parseTimestamp("2021-08-14T21:50:57.157725Z", 27, created));
+    EXPECT_EQ(f.created_at, created);
+}
+
+TEST(FieldTable, Ticker) {
+    auto ticker = parse<Ticker>(test::readTestData("ticker.json"));
+    ASSERT_TRUE(ticker) << ticker.what();
+    auto& t = ticker.content();
+    EXPECT_EQ(t.trade_id, 201766453u);
+    EXPECT_EQ(t.price, dec("48726.63"));
+    EXPECT_EQ(t.size, dec("0.00102"));
+    EXPECT_EQ(t.bid, dec("48726.62"));
+    EXPECT_EQ(t.ask, dec("48726.63"));
+    EXPECT_DOUBLE_EQ(t.volume, 18022.45389513);
+    EXPECT_NE(t.time, 0);
+}
+
+TEST(FieldTable, Time) {
+    auto time = parse<Time>(R"({"iso":"2015-01-07T23:47:25.201Z","epoch":1420674445.201})");
+    ASSERT_TRUE(time) << time.what();
+    EXPECT_EQ(time.content().iso, "2015-01-07T23:47:25.201Z");
+    EXPECT_EQ(time.content().epoch, 1420674445201u);
+}
+
+TEST(FieldTable, MemberOrderAndUnknownMembers) {
+    // any order, unknown members and members of other types are skipped
+    auto order = parse<Order>(R"({"unknown":{"id":"nested"},"status":"done","size":"1.5","extra":[1,2],"side":"buy",)"
+        R"("id":"d50ec984-77a8-460a-b958-66f114b0de9b","type":"limit","price":12,"product_id":"BTC-USD","settled":"yes"})");
+    ASSERT_TRUE(order) << order.what();
+    auto& o = order.content();
+    EXPECT_EQ(o.id.str(), "d50ec984-77a8-460a-b958-66f114b0de9b");
+    EXPECT_EQ(o.status, OrderStatus::Done);
+    EXPECT_EQ(o.side, OrderSide::Buy);
+    EXPECT_EQ(o.type, OrderType::Limit);
+    EXPECT_EQ(o.price, dec("12"));
+    EXPECT_STREQ(o.product_id.c_str(), "BTC-USD");
+    EXPECT_FALSE(o.settled);
+
+    // an unknown order type keeps the default instead of asserting
+    auto unknown = parse<Order>(R"({"type":"twap","time_in_force":"XYZ","status":"open"})");
+    ASSERT_TRUE(unknown) << unknown.what();
+    EXPECT_EQ(unknown.content().type, OrderType::Market);
+    EXPECT_EQ(unknown.content().tif, TimeInForce::GTC);
+}
+
+TEST(FieldTable, ParserGet) {
+    JsonDocument d;
+    d.Parse(R"({"a":"1.25","b":7,"s":"text"})");
+    Parser<JsonDocument> parser(d);
+    Decimal a;
+    EXPECT_TRUE(parser.get("a", a));
+    EXPECT_EQ(a, dec("1.25"));
+    int32_t b = 0;
+    EXPECT_TRUE(parser.get("b", b));
+    EXPECT_EQ(b, 7);
+    EXPECT_FALSE(parser.get("missing", b));
+    EXPECT_EQ(parser.get<std::string>("s"), "text");
+    EXPECT_EQ(parser.get<std::string>("b"), "");
+}
+
+TEST(FieldTable, UnknownOrderEnums) {
+    auto type = OrderType::Limit;
+    EXPECT_FALSE(to_orderType("stop", 4, type));
+    EXPECT_FALSE(to_orderType("limits", 6, type));
+    EXPECT_EQ(type, OrderType::Limit);
+    EXPECT_TRUE(to_orderType("market", 6, type));
+    EXPECT_EQ(type, OrderType::Market);
+
+    auto tif = TimeInForce::IOC;
+    EXPECT_FALSE(to_timeInForce("GTD", 3, tif));
+    EXPECT_FALSE(to_timeInForce("GTCX", 4, tif));
+    EXPECT_EQ(tif, TimeInForce::IOC);
+    EXPECT_TRUE(to_timeInForce("FOK", 3, tif));
+    EXPECT_EQ(tif, TimeInForce::FOK);
+
+    // an unknown status keeps the current one
+    auto order = parse<Order>(R"({"status":"open"})");
+    ASSERT_TRUE(order) << order.what();
+    JsonDocument d;
+    d.Parse(R"({"status":"expired","type":"stop"})");
+    auto o = order.content();
+    EXPECT_FALSE(readJson(d["status"], o.status));
+    EXPECT_FALSE(readJson(d["type"], o.type));
+    EXPECT_EQ(o.status, OrderStatus::Open);
+    EXPECT_EQ(o.type, OrderType::Market);
+}
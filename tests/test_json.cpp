@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "response.h"
+#include "gdax/json.h"
+#include "gdax/order.h"
+#include "gdax/product.h"
+#include "support/test_data.h"
+
+using namespace gdax;
+
+namespace {
+    template<typename T>
+    Response<T> parse(std::string payload) {
+        Response<T> response;
+        response.parseContent(&payload[0], nullptr);
+        return response;
+    }
+}
+
+TEST(InlineString, InlineAndHeap) {
+    InlineString<7> s("BTC-USD");
+    EXPECT_EQ(s.size(), 7u);
+    EXPECT_TRUE(s == "BTC-USD");
+    // longer strings spill to the heap
+    s = "MATIC-USDC";
+    EXPECT_STREQ(s.c_str(), "MATIC-USDC");
+    EXPECT_EQ(s.size(), 10u);
+    // and back inline
+    s.assign("ETH", 3);
+    EXPECT_STREQ(s.c_str(), "ETH");
+    s = "0123456789abcdef";
+    EXPECT_EQ(s.str(), "0123456789abcdef");
+
+    InlineString<7> copy(s);
+    InlineString<7> moved(std::move(copy));
+    EXPECT_EQ(moved, s);
+    copy = moved;
+    EXPECT_STREQ(copy.c_str(), "0123456789abcdef");
+    EXPECT_EQ("id " + moved, "id 0123456789abcdef");
+    EXPECT_TRUE(InlineString<7>().empty());
+}
+
+TEST(JsonArena, ParsesRecordedPayloads) {
+    auto products = parse<std::vector<Product>>(test::readTestData("products.json"));
+    ASSERT_TRUE(products) << products.what();
+    ASSERT_EQ(products.content().size(), 12u);
+    auto& btc = products.content()[0];
+    EXPECT_STREQ(btc.id.c_str(), "BTC-USD");
+    EXPECT_STREQ(btc.quote_currency.c_str(), "USD");
+    EXPECT_EQ(btc.quote_increment.decimals(), 2);
+    EXPECT_EQ(btc.base_increment.decimals(), 8);
+    EXPECT_EQ(btc.base_max_size, 1500.);
+    // above the range of Decimal
+    EXPECT_EQ(products.content()[6].base_max_size, 900000000000.);
+
+    auto orders = parse<std::vector<Order>>(test::readTestData("orders.json"));
+    ASSERT_TRUE(orders) << orders.what();
+    ASSERT_EQ(orders.content().size(), 25u);
+    auto& order = orders.content()[0];
+    EXPECT_EQ(order.id.str(), "3aa5add7-7507-4d7b-8194-9e487d265665");
+    EXPECT_STREQ(order.product_id.c_str(), "LTC-USD");
+    EXPECT_EQ(order.type, OrderType::Market);
+    EXPECT_EQ(order.status, OrderStatus::Open);
+    EXPECT_NE(order.created_at, 0);
+}
+
+TEST(JsonArena, ReusedAcrossDocuments) {
+    // a payload outgrowing the thread local buffers, then small ones reusing them
+    std::string orders = test::readTestData("orders.json");
+    std::string large = "[";
+    for (int i = 0; i < 20; ++i) {
+        large += (i ? "," : "") + orders.substr(1, orders.size() - 2);
+    }
+    large += "]";
+    ASSERT_GT(large.size(), 128u * 1024);
+    auto all = parse<std::vector<Order>>(large);
+    ASSERT_TRUE(all) << all.what();
+    EXPECT_EQ(all.content().size(), 500u);
+
+    for (int i = 0; i < 3; ++i) {
+        auto some = parse<std::vector<Order>>(orders);
+        ASSERT_TRUE(some) << some.what();
+        ASSERT_EQ(some.content().size(), 25u);
+        EXPECT_EQ(some.content()[24].id, all.content()[499].id);
+    }
+}
+
+TEST(JsonArena, ErrorMessage) {
+    auto response = parse<std::vector<Order>>(R"({"message":"Invalid API Key"})");
+    EXPECT_FALSE(response);
+    EXPECT_EQ(response.what(), "Invalid API Key");
+
+    auto invalid = parse<std::vector<Order>>("[{");
+    EXPECT_FALSE(invalid);
+}
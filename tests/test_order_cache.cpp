@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "gdax/order_cache.h"
+
+using gdax::Order;
+using gdax::OrderCache;
+using gdax::OrderStatus;
+using gdax::Uuid;
+
+namespace {
+    Order makeOrder(const Uuid& id, OrderStatus status) {
+        Order order;
+        order.id = id;
+        order.status = status;
+        return order;
+    }
+
+    Uuid makeId(std::mt19937_64& rng) {
+        Uuid id;
+        id.hi = rng();
+        id.lo = rng();
+        return id;
+    }
+
+    bool isTerminal(OrderStatus status) {
+        return status == OrderStatus::Done || status == OrderStatus::Canceled || status == OrderStatus::Rejected;
+    }
+}
+
+TEST(Uuid, ParseAndFormat) {
+    const char* s = "d50ec984-77a8-460a-b958-66f114b0de9b";
+    Uuid id;
+    ASSERT_TRUE(Uuid::parse(s, Uuid::s_length, id));
+    EXPECT_EQ(id.hi, 0xd50ec98477a8460aull);
+    EXPECT_EQ(id.lo, 0xb95866f114b0de9bull);
+    EXPECT_EQ(id.str(), s);
+
+    Uuid upper;
+    ASSERT_TRUE(Uuid::parse("D50EC984-77A8-460A-B958-66F114B0DE9B", Uuid::s_length, upper));
+    EXPECT_EQ(upper, id);
+    EXPECT_FALSE(id.isNil());
+    EXPECT_TRUE(Uuid().isNil());
+}
+
+TEST(Uuid, RejectsInvalidStrings) {
+    Uuid id;
+    EXPECT_FALSE(Uuid::parse("d50ec984-77a8-460a-b958-66f114b0de9", 35, id));
+    EXPECT_FALSE(Uuid::parse("d50ec98477a8-460a-b958-66f114b0de9b0", 36, id));
+    EXPECT_FALSE(Uuid::parse("g50ec984-77a8-460a-b958-66f114b0de9b", 36, id));
+    EXPECT_FALSE(Uuid::parse("d50ec984-77a8-460a-b958-66f114b0de:b", 36, id));
+    EXPECT_TRUE(id.isNil());
+}
+
+TEST(OrderCache, InsertKeepsAddress) {
+    std::mt19937_64 rng(1);
+    OrderCache cache;
+    auto id = makeId(rng);
+    auto* order = cache.insert(makeOrder(id, OrderStatus::Open));
+    order->last_trade_id = 42;
+
+    // growing the index keeps the records in place
+    for (int i = 0; i < 5000; ++i) {
+        cache.insert(makeOrder(makeId(rng), OrderStatus::Open));
+    }
+    EXPECT_EQ(cache.find(id), order);
+
+    // an update keeps the state only known locally
+    auto* updated = cache.insert(makeOrder(id, OrderStatus::Done));
+    EXPECT_EQ(updated, order);
+    EXPECT_EQ(order->status, OrderStatus::Done);
+    EXPECT_EQ(order->last_trade_id, 42u);
+    EXPECT_EQ(cache.size(), 5001u);
+    EXPECT_EQ(cache.find(makeId(rng)), nullptr);
+}
+
+TEST(OrderCache, TrimKeepsRetainedAndWorkingOrders) {
+    std::mt19937_64 rng(2);
+    OrderCache cache;
+    std::vector<Uuid> ids;
+    for (size_t i = 0; i < OrderCache::s_trimThreshold; ++i) {
+        ids.push_back(makeId(rng));
+        cache.insert(makeOrder(ids.back(), i % 2 ? OrderStatus::Done : OrderStatus::Open));
+    }
+    ASSERT_TRUE(cache.retain(ids[1]));
+
+    EXPECT_EQ(cache.trim(), OrderCache::s_trimThreshold / 2 - 1);
+    EXPECT_EQ(cache.size(), OrderCache::s_trimThreshold / 2 + 1);
+    // under the threshold now
+    EXPECT_EQ(cache.trim(), 0u);
+
+    EXPECT_EQ(cache.find(ids[1])->status, OrderStatus::Done);
+    EXPECT_FALSE(cache.retain(ids[3]));
+    // the newest archived orders are still found
+    auto* archived = cache.find(ids.back());
+    ASSERT_NE(archived, nullptr);
+    EXPECT_EQ(archived->id, ids.back());
+    // the oldest ones are dropped
+    EXPECT_EQ(cache.find(ids[5]), nullptr);
+}
+
+TEST(OrderCache, TrimArchivesClusterWrappingAroundTheIndex) {
+    // 1024 orders are indexed by 2048 buckets. Orders whose home is the last bucket form a cluster which
+    // wraps around to the first buckets, erasing from it shifts buckets across the end of the table.
+    constexpr size_t mask = 2047;
+    std::mt19937_64 rng(3);
+    std::vector<Uuid> wrapping;
+    std::vector<Uuid> others;
+    while (wrapping.size() < 16) {
+        auto id = makeId(rng);
+        auto home = id.hash() & mask;
+        if (home == mask || home == mask - 1) {
+            wrapping.push_back(id);
+        }
+    }
+
+    OrderCache cache;
+    for (auto& id : wrapping) {
+        cache.insert(makeOrder(id, OrderStatus::Done));
+    }
+    while (cache.size() < OrderCache::s_trimThreshold) {
+        auto id = makeId(rng);
+        if (id.hash() & mask) {
+            others.push_back(id);
+            cache.insert(makeOrder(id, others.size() % 2 ? OrderStatus::Open : OrderStatus::Canceled));
+        }
+    }
+
+    cache.trim();
+    size_t live = 0;
+    cache.forEach([&live](Order& order) {
+        EXPECT_FALSE(isTerminal(order.status)) << order.id.str();
+        ++live;
+    });
+    EXPECT_EQ(live, cache.size());
+    EXPECT_EQ(live, (others.size() + 1) / 2);
+    for (size_t i = 0; i < others.size(); i += 2) {
+        auto* order = cache.find(others[i]);
+        ASSERT_NE(order, nullptr);
+        EXPECT_EQ(order->status, OrderStatus::Open);
+    }
+}
+
+TEST(OrderCache, MatchesReferenceMap) {
+    struct Entry {
+        OrderStatus status;
+        bool retained;
+    };
+    std::map<std::pair<uint64_t, uint64_t>, Entry> reference;
+    std::vector<Uuid> ids;
+    std::mt19937_64 rng(20210301);
+    std::uniform_int_distribution<int> op(0, 99);
+    std::uniform_int_distribution<int> status(1, 6);
+
+    OrderCache cache;
+    auto key = [](const Uuid& id) { return std::make_pair(id.hi, id.lo); };
+    auto pick = [&]() { return ids[std::uniform_int_distribution<size_t>(0, ids.size() - 1)(rng)]; };
+
+    for (int i = 0; i < 50000; ++i) {
+        auto n = op(rng);
+        if (n < 40 || ids.empty()) {
+            // a new order
+            ids.push_back(makeId(rng));
+            auto s = (OrderStatus)status(rng);
+            ASSERT_EQ(cache.insert(makeOrder(ids.back(), s))->status, s);
+            reference[key(ids.back())] = { s, false };
+        }
+        else if (n < 60) {
+            // a new state of a known order, live or archived
+            auto id = pick();
+            auto s = (OrderStatus)status(rng);
+            cache.insert(makeOrder(id, s));
+            auto it = reference.find(key(id));
+            if (it != reference.end()) {
+                it->second.status = s;
+            }
+            else {
+                reference[key(id)] = { s, false };
+            }
+        }
+        else if (n < 85) {
+            auto id = pick();
+            auto* order = cache.find(id);
+            auto it = reference.find(key(id));
+            if (it != reference.end()) {
+                ASSERT_NE(order, nullptr);
+                ASSERT_EQ(order->status, it->second.status);
+            }
+            else if (order) {
+                // archived, and not dropped from the archive yet
+                ASSERT_EQ(order->id, id);
+                ASSERT_TRUE(isTerminal(order->status));
+            }
+        }
+        else if (n < 92) {
+            auto id = pick();
+            auto it = reference.find(key(id));
+            ASSERT_EQ(cache.retain(id), it != reference.end());
+            if (it != reference.end()) {
+                it->second.retained = true;
+            }
+        }
+        else if (n < 98) {
+            auto id = pick();
+            cache.release(id);
+            auto it = reference.find(key(id));
+            if (it != reference.end()) {
+                it->second.retained = false;
+            }
+        }
+        else {
+            auto before = reference.size();
+            size_t expected = 0;
+            if (before >= OrderCache::s_trimThreshold) {
+                for (auto it = reference.begin(); it != reference.end();) {
+                    if (!it->second.retained && isTerminal(it->second.status)) {
+                        it = reference.erase(it);
+                        ++expected;
+                    }
+                    else {
+                        ++it;
+                    }
+                }
+            }
+            ASSERT_EQ(cache.trim(), expected);
+        }
+        ASSERT_EQ(cache.size(), reference.size());
+    }
+
+    std::set<std::pair<uint64_t, uint64_t>> live;
+    cache.forEach([&](Order& order) { live.insert(key(order.id)); });
+    ASSERT_EQ(live.size(), reference.size());
+    for (auto& entry : reference) {
+        EXPECT_TRUE(live.count(entry.first));
+    }
+}
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "gdax/client.h"
+#include "gdax/websocket.h"
+#include "support/mock_transport.h"
+#include "support/zorro_stubs.h"
+
+using namespace gdax;
+using gdax::test::MockHttpTransport;
+using gdax::test::MockRequest;
+using gdax::test::MockResponse;
+
+namespace {
+    // base64 of "secret"
+    const char* s_secret = "c2VjcmV0";
+    const char* s_orderId = "d50ec984-77a8-460a-b958-66f114b0de9b";
+    const char* s_otherId = "8ba6dbbd-14a2-47bc-a6a9-5d0e6a4f2f0c";
+
+    std::string restOrder(const char* status, const char* filled, const char* value, const char* fees) {
+        return std::string(R"({"id":")") + s_orderId + R"(","price":"100","size":"1","product_id":"BTC-USD","side":"buy","type":"limit",)"
+            R"("time_in_force":"GTC","post_only":false,"created_at":"2021-08-15T03:59:53.070978Z","fill_fees":")" + fees +
+            R"(","filled_size":")" + filled + R"(","executed_value":")" + value + R"(","status":")" + status + R"(","settled":false})";
+    }
+
+    std::string now() {
+        char buf[32];
+        formatTimestamp(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count(), buf);
+        return buf;
+    }
+
+    std::string match(uint64_t tradeId, const char* size, const std::string& time) {
+        return R"({"type":"match","trade_id":)" + std::to_string(tradeId) + R"(,"maker_order_id":")" + s_orderId + R"(","taker_order_id":")" + s_otherId +
+            R"(","side":"buy","size":")" + size + R"(","price":"100","product_id":"BTC-USD","sequence":1,"time":")" + time + R"(","maker_fee_rate":"0.005"})";
+    }
+
+    std::string orderMessage(const char* type, const char* extra = "") {
+        return std::string(R"({"type":")") + type + R"(","order_id":")" + s_orderId + R"(","product_id":"BTC-USD","side":"buy","price":"100","sequence":1,"time":")" +
+            now() + "\"" + extra + "}";
+    }
+
+    /**
+     * @brief A stand-in of the websocket feed scripting the user channel, and the REST API behind a Client.
+     */
+    struct OrderEventsTest : ::testing::Test {
+        MockHttpTransport& rest = MockHttpTransport::install();
+        std::unique_ptr<GdaxWebsocket> ws = std::make_unique<GdaxWebsocket>();
+        std::unique_ptr<Client> client = std::make_unique<Client>("key", "phrase", s_secret, true);
+        Uuid id;
+
+        void SetUp() override {
+            test::takeBrokerErrors();
+            ASSERT_TRUE(Uuid::parse(s_orderId, strlen(s_orderId), id));
+            ASSERT_TRUE(ws->login("key", "phrase", s_secret, true));
+            ws->onWebsocketOpened(ws->lastId);
+            ws->subscribe("BTC-USD");
+            subscribed();
+            client->setOrderEvents(&ws->orderEvents());
+        }
+
+        void receive(const std::string& msg) {
+            ws->onWebsocketData(ws->lastId, msg.data(), msg.size(), 0);
+        }
+
+        void subscribed() {
+            receive(R"({"type":"subscriptions","channels":[{"name":"ticker","product_ids":["BTC-USD"]},{"name":"user","product_ids":["BTC-USD"]}]})");
+            ASSERT_TRUE(ws->orderEvents().live());
+        }
+
+        Order* cacheOrder() {
+            rest.on(std::string("GET /orders/") + s_orderId, restOrder("open", "0", "0", "0"));
+            auto response = client->getOrder(id);
+            EXPECT_TRUE(response) << response.what();
+            rest.clearRequests();
+            return response ? response.content() : nullptr;
+        }
+    };
+}
+
+TEST(OrderEvent, MatchIsAppliedOnce) {
+    Order order;
+    order.size = Decimal::fromDouble(1.);
+    order.status = OrderStatus::Open;
+
+    OrderEvent event;
+    event.type = FeedType::Match;
+    event.trade_id = 7;
+    event.price = Decimal::fromDouble(100.);
+    event.size = Decimal::fromDouble(0.25);
+    applyOrderEvent(order, event);
+    applyOrderEvent(order, event);
+    EXPECT_EQ(order.filled_size, Decimal::fromDouble(0.25));
+    EXPECT_EQ(order.last_trade_id, 7u);
+    EXPECT_DOUBLE_EQ(order.filled_price, 100.);
+
+    // a fill past the size of the order is in a snapshot already, its trade id is not recorded
+    event.trade_id = 8;
+    event.size = Decimal::fromDouble(0.8);
+    applyOrderEvent(order, event);
+    EXPECT_EQ(order.filled_size, Decimal::fromDouble(0.25));
+    EXPECT_EQ(order.last_trade_id, 7u);
+
+    // older than the last snapshot
+    order.synced_at = 2000;
+    event.size = Decimal::fromDouble(0.5);
+    event.time = 1000;
+    applyOrderEvent(order, event);
+    EXPECT_EQ(order.filled_size, Decimal::fromDouble(0.25));
+    event.time = 3000;
+    applyOrderEvent(order, event);
+    EXPECT_EQ(order.filled_size, Decimal::fromDouble(0.75));
+    EXPECT_EQ(order.last_trade_id, 8u);
+}
+
+TEST(OrderEvent, TerminalOrderIsNotChanged) {
+    Order order;
+    order.size = Decimal::fromDouble(1.);
+    order.status = OrderStatus::Canceled;
+
+    OrderEvent event;
+    event.type = FeedType::Open;
+    applyOrderEvent(order, event);
+    EXPECT_EQ(order.status, OrderStatus::Canceled);
+
+    event.type = FeedType::Change;
+    event.size = Decimal::fromDouble(0.5);
+    applyOrderEvent(order, event);
+    EXPECT_EQ(order.size, Decimal::fromDouble(1.));
+
+    event.type = FeedType::Match;
+    event.trade_id = 1;
+    event.price = Decimal::fromDouble(100.);
+    applyOrderEvent(order, event);
+    EXPECT_TRUE(order.filled_size.isZero());
+}
+
+TEST_F(OrderEventsTest, FillsArePushedToTheWaitingOrder) {
+    auto* order = cacheOrder();
+    ASSERT_NE(order, nullptr);
+
+    // the feed scripts the fills while the Zorro thread waits
+    std::thread feed([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        receive(match(1, "0.4", now()));
+        receive(match(2, "0.6", now()));
+        receive(orderMessage("done", R"(,"reason":"filled","remaining_size":"0")"));
+    });
+    auto response = client->waitOrder(order, [](const Order& o) { return o.status == OrderStatus::Done; }, 5000);
+    feed.join();
+
+    ASSERT_TRUE(response) << response.what();
+    EXPECT_EQ(order->status, OrderStatus::Done);
+    EXPECT_EQ(order->filled_size, Decimal::fromDouble(1.));
+    EXPECT_EQ(order->executed_value, Decimal::fromDouble(100.));
+    EXPECT_EQ(order->fill_fees, Decimal::fromDouble(0.5));
+    EXPECT_EQ(order->last_trade_id, 2u);
+    // no polling while the user channel is live
+    EXPECT_TRUE(rest.requests().empty());
+}
+
+TEST_F(OrderEventsTest, MatchInTheResyncSnapshotIsCountedOnce) {
+    auto* order = cacheOrder();
+    ASSERT_NE(order, nullptr);
+
+    // the feed reconnects, events may have been missed
+    ws->onWebsocketClosed(ws->lastId);
+    ws->onWebsocketOpened(ws->lastId);
+    subscribed();
+
+    // a fill made before the resync is in its snapshot, but its match is delivered during the round trip
+    auto filledAt = now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    rest.on(std::string("GET /orders/") + s_orderId, [this, filledAt](const MockRequest&) {
+        receive(match(5, "0.25", filledAt));
+        return MockResponse{ restOrder("open", "0.25", "25", "0.125") };
+    });
+    auto response = client->refreshOrder(order);
+    ASSERT_TRUE(response) << response.what();
+    EXPECT_EQ(order->filled_size, Decimal::fromDouble(0.25));
+    EXPECT_EQ(order->executed_value, Decimal::fromDouble(25.));
+    EXPECT_EQ(order->fill_fees, Decimal::fromDouble(0.125));
+    EXPECT_EQ(rest.count("GET /orders/"), 1u);
+
+    // a later fill is applied
+    rest.clearRequests();
+    receive(match(6, "0.5", now()));
+    ASSERT_TRUE(client->refreshOrder(order));
+    EXPECT_EQ(order->filled_size, Decimal::fromDouble(0.75));
+    EXPECT_EQ(order->executed_value, Decimal::fromDouble(75.));
+    EXPECT_TRUE(rest.requests().empty());
+}
+
+TEST_F(OrderEventsTest, MatchDuringTheResyncRoundTripIsCountedOnce) {
+    auto* order = cacheOrder();
+    ASSERT_NE(order, nullptr);
+
+    ws->onWebsocketClosed(ws->lastId);
+    ws->onWebsocketOpened(ws->lastId);
+    subscribed();
+
+    // the fill is made while the snapshot is requested, it may or may not be in it
+    rest.on(std::string("GET /orders/") + s_orderId, [this](const MockRequest&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        receive(match(5, "0.25", now()));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        return MockResponse{ restOrder("open", "0.25", "25", "0.125") };
+    });
+    auto response = client->refreshOrder(order);
+    ASSERT_TRUE(response) << response.what();
+    EXPECT_EQ(order->filled_size, Decimal::fromDouble(0.25));
+    EXPECT_EQ(order->executed_value, Decimal::fromDouble(25.));
+    EXPECT_EQ(order->fill_fees, Decimal::fromDouble(0.125));
+    // so the order is requested once more
+    EXPECT_GE(rest.count("GET /orders/"), 2u);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "rapidjson/document.h"
+#include "gdax/order_template.h"
+
+using namespace gdax;
+
+namespace {
+    Product makeProduct(const char* id, const char* baseIncrement, const char* quoteIncrement) {
+        Product product;
+        product.id = id;
+        EXPECT_TRUE(Decimal::parse(baseIncrement, strlen(baseIncrement), product.base_increment));
+        EXPECT_TRUE(Decimal::parse(quoteIncrement, strlen(quoteIncrement), product.quote_increment));
+        return product;
+    }
+
+    std::string build(const OrderTemplate& t, OrderSide side, OrderType type, TimeInForce tif, double lots,
+        double limit = 0., double stop = 0., bool postOnly = false) {
+        size_t len = 0;
+        auto body = t.build(side, type, tif, lots, limit, stop, postOnly, len);
+        EXPECT_EQ(len, strlen(body));
+        return std::string(body, len);
+    }
+}
+
+TEST(OrderTemplate, LimitOrder) {
+    OrderTemplate t(makeProduct("BTC-USD", "0.00000001", "0.01"), "");
+    EXPECT_EQ(build(t, OrderSide::Buy, OrderType::Limit, TimeInForce::GTC, 0.5, 48726.638, 0., true),
+        R"({"product_id":"BTC-USD","side":"buy","type":"limit","time_in_force":"GTC","price":"48726.63","post_only":true,"size":"0.50000000"})");
+    // a sell limit is rounded up to the tick
+    EXPECT_EQ(build(t, OrderSide::Sell, OrderType::Limit, TimeInForce::GTT, 0.00102, 48726.631),
+        R"({"product_id":"BTC-USD","side":"sell","type":"limit","time_in_force":"GTT","price":"48726.64","post_only":false,"size":"0.00102000"})");
+    // post_only is not allowed with IOC and FOK
+    EXPECT_EQ(build(t, OrderSide::Buy, OrderType::Limit, TimeInForce::IOC, 1., 100., 0., true),
+        R"({"product_id":"BTC-USD","side":"buy","type":"limit","time_in_force":"IOC","price":"100.00","size":"1.00000000"})");
+}
+
+TEST(OrderTemplate, StopAndMarketOrders) {
+    OrderTemplate t(makeProduct("ETH-EUR", "0.001", "0.1"), "co");
+    EXPECT_EQ(build(t, OrderSide::Sell, OrderType::Limit, TimeInForce::GTC, 2.0004, 2500., 2510.06),
+        R"({"product_id":"ETH-EUR","side":"sell","type":"limit","stp":"co","time_in_force":"GTC","price":"2500.0",)"
+        R"("stop_price":"2510.1","stop":"loss","post_only":false,"size":"2.000"})");
+    EXPECT_EQ(build(t, OrderSide::Buy, OrderType::Market, TimeInForce::GTC, 1.5, 2500.),
+        R"({"product_id":"ETH-EUR","side":"buy","type":"market","stp":"co","size":"1.500"})");
+}
+
+TEST(OrderTemplate, EscapesProductAndStp) {
+    OrderTemplate t(makeProduct("A\"B", "1", "1"), "c\\o");
+    auto body = build(t, OrderSide::Buy, OrderType::Market, TimeInForce::GTC, 3.);
+    rapidjson::Document d;
+    ASSERT_FALSE(d.Parse(body.c_str()).HasParseError()) << body;
+    EXPECT_STREQ(d["product_id"].GetString(), "A\"B");
+    EXPECT_STREQ(d["stp"].GetString(), "c\\o");
+    EXPECT_STREQ(d["size"].GetString(), "3");
+}
+
+TEST(OrderTemplate, RandomOrdersAreValidJson) {
+    std::mt19937_64 rng(15);
+    std::uniform_real_distribution<double> price(0.0001, 100000.);
+    std::uniform_real_distribution<double> lots(0.001, 1000.);
+    const char* increments[] = { "1", "0.1", "0.01", "0.0001", "0.00000001" };
+    for (int i = 0; i < 10000; ++i) {
+        OrderTemplate t(makeProduct("SOL-USD", increments[rng() % 5], increments[rng() % 5]), i % 2 ? "dc" : "");
+        auto side = rng() % 2 ? OrderSide::Buy : OrderSide::Sell;
+        auto type = rng() % 2 ? OrderType::Limit : OrderType::Market;
+        auto tif = (TimeInForce)(rng() % 4);
+        auto limit = price(rng);
+        auto body = build(t, side, type, tif, lots(rng), limit, rng() % 2 ? price(rng) : 0., rng() % 2);
+        ASSERT_LT(body.size(), OrderTemplate::s_maxBodySize);
+
+        rapidjson::Document d;
+        ASSERT_FALSE(d.Parse(body.c_str()).HasParseError()) << body;
+        ASSERT_EQ(d["side"].GetString(), std::string(side == OrderSide::Buy ? "buy" : "sell")) << body;
+        ASSERT_TRUE(d["size"].IsString()) << body;
+        if (type == OrderType::Limit) {
+            Decimal p;
+            ASSERT_TRUE(Decimal::parse(d["price"].GetString(), d["price"].GetStringLength(), p)) << body;
+            // never worse than the limit, up to the resolution of Decimal
+            const double resolution = 1. / Decimal::s_unit;
+            bool atLimit = side == OrderSide::Buy ? p.toDouble() <= limit + resolution : p.toDouble() >= limit - resolution;
+            ASSERT_TRUE(atLimit) << body << " limit " << limit;
+        }
+        else {
+            ASSERT_FALSE(d.HasMember("price")) << body;
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "gdax/quote_table.h"
+
+using gdax::Quote;
+using gdax::QuoteTable;
+
+TEST(QuoteTable, AddAndFind) {
+    static QuoteTable table;
+    table.clear();
+    EXPECT_EQ(table.add("BTC-USD"), 0u);
+    EXPECT_EQ(table.add("ETH-USD"), 1u);
+    EXPECT_EQ(table.size(), 2u);
+    EXPECT_EQ(table.find("ETH-USD", 7), 1u);
+    EXPECT_EQ(table.find("ETH-USDC", 8), QuoteTable::invalid_slot);
+    EXPECT_EQ(table.find("ETH", 3), QuoteTable::invalid_slot);
+    EXPECT_STREQ(table.symbol(0), "BTC-USD");
+    EXPECT_EQ(table.add(std::string(QuoteTable::max_symbol_len + 1, 'X').c_str()), QuoteTable::invalid_slot);
+
+    table.clear();
+    for (uint32_t i = 0; i < QuoteTable::capacity; ++i) {
+        ASSERT_EQ(table.add(("P" + std::to_string(i)).c_str()), i);
+    }
+    EXPECT_EQ(table.add("FULL"), QuoteTable::invalid_slot);
+    table.clear();
+}
+
+TEST(QuoteTable, UpdateKeepsNanFields) {
+    static QuoteTable table;
+    auto slot = table.add("BTC-USD");
+    Quote quote;
+    EXPECT_FALSE(table.read(slot, quote));
+
+    table.update(slot, 100., 101., NAN, NAN);
+    ASSERT_TRUE(table.read(slot, quote));
+    EXPECT_EQ(quote.bid, 100.);
+    EXPECT_EQ(quote.ask, 101.);
+    EXPECT_TRUE(std::isnan(quote.price));
+    EXPECT_EQ(quote.volume, 0.);
+
+    // a trade only changes the last price and volume
+    table.update(slot, NAN, NAN, 100.5, 1234.);
+    ASSERT_TRUE(table.read(slot, quote));
+    EXPECT_EQ(quote.bid, 100.);
+    EXPECT_EQ(quote.ask, 101.);
+    EXPECT_EQ(quote.price, 100.5);
+    EXPECT_EQ(quote.volume, 1234.);
+
+    table.invalidate();
+    EXPECT_FALSE(table.read(slot, quote));
+    EXPECT_EQ(quote.volume, 0.);
+    EXPECT_EQ(table.size(), 1u);
+}
+
+TEST(QuoteTable, ReadersSeeConsistentSnapshots) {
+    // the writer keeps ask = bid + 1, price = bid + 0.5 and volume = bid in every update
+    static QuoteTable table;
+    constexpr uint32_t slots = 4;
+    for (uint32_t i = 0; i < slots; ++i) {
+        table.add(("P" + std::to_string(i)).c_str());
+    }
+
+    std::atomic<bool> stop{ false };
+    std::thread writer([&stop]() {
+        for (uint64_t n = 1; !stop.load(std::memory_order_relaxed); ++n) {
+            auto bid = (double)n;
+            table.update((uint32_t)(n % slots), bid, bid + 1., bid + .5, bid);
+        }
+    });
+
+    uint64_t reads = 0;
+    double last[slots] = { 0., 0., 0., 0. };
+    for (; reads < 2000000; ++reads) {
+        auto slot = (uint32_t)(reads % slots);
+        Quote quote;
+        if (!table.read(slot, quote)) {
+            continue;
+        }
+        ASSERT_EQ(quote.ask, quote.bid + 1.);
+        ASSERT_EQ(quote.price, quote.bid + .5);
+        ASSERT_EQ(quote.volume, quote.bid);
+        // and a slot never goes back in time
+        ASSERT_GE(quote.bid, last[slot]);
+        last[slot] = quote.bid;
+    }
+    stop = true;
+    writer.join();
+}
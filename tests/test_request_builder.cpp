@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#include "request.h"
+#include "support/mock_transport.h"
+
+using namespace gdax;
+using gdax::test::MockHttpTransport;
+using gdax::test::MockResponse;
+
+TEST(RequestBuilder, UrlPathAndHeaders) {
+    auto& builder = RequestBuilder::get().reset(Lane::Private);
+    builder.url(std::string("https://api.pro.coinbase.com")).path("/orders").path("?status=open", 12);
+    builder.header("Content-Type:application/json\n").header(std::string("CB-ACCESS-KEY:key"));
+    ASSERT_TRUE(builder.ok());
+    EXPECT_EQ(builder.lane(), Lane::Private);
+    EXPECT_STREQ(builder.url(), "https://api.pro.coinbase.com/orders?status=open");
+    EXPECT_STREQ(builder.path(), "/orders?status=open");
+    EXPECT_EQ(builder.pathLength(), 19u);
+    EXPECT_STREQ(builder.headers(), "Content-Type:application/json\nCB-ACCESS-KEY:key");
+
+    // reset starts over in the same buffers
+    builder.reset(Lane::Public).url("https://api.test").path("/time");
+    EXPECT_EQ(builder.lane(), Lane::Public);
+    EXPECT_STREQ(builder.url(), "https://api.test/time");
+    EXPECT_STREQ(builder.headers(), "");
+    EXPECT_EQ(&builder, &RequestBuilder::get());
+}
+
+TEST(RequestBuilder, Overflow) {
+    auto& builder = RequestBuilder::get().reset(Lane::Public).url("https://api.test");
+    std::string longPath(4096, 'p');
+    builder.path(longPath.c_str());
+    EXPECT_FALSE(builder.ok());
+    // what fitted is kept null-terminated
+    EXPECT_STREQ(builder.url(), "https://api.test");
+
+    builder.reset(Lane::Public);
+    EXPECT_TRUE(builder.ok());
+    std::string longHeader(2048, 'h');
+    builder.header(longHeader);
+    EXPECT_FALSE(builder.ok());
+}
+
+TEST(RequestBuilder, OnePerThread) {
+    auto& mine = RequestBuilder::get().reset(Lane::Private).url("https://mine");
+    const RequestBuilder* theirs = nullptr;
+    std::string theirUrl;
+    std::thread other([&]() {
+        auto& builder = RequestBuilder::get().reset(Lane::Public).url("https://theirs");
+        theirs = &builder;
+        theirUrl = builder.url();
+    });
+    other.join();
+    EXPECT_NE(theirs, &mine);
+    EXPECT_EQ(theirUrl, "https://theirs");
+    EXPECT_STREQ(mine.url(), "https://mine");
+}
+
+TEST(RequestBuilder, ReusedWhileRequestsAreInFlight) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("GET /candles", [](const test::MockRequest& request) {
+        MockResponse response{ "\"" + request.path + "\"" };
+        response.pendingWaits = 2;
+        return response;
+    });
+
+    // the next request is built in the same buffers before the first one completes
+    std::string err;
+    auto& builder = RequestBuilder::get().reset(Lane::Public).url("https://api.test").path("/candles?start=1").header("A:1");
+    int first = send_request(builder.lane(), builder.url(), builder.headers(), nullptr, P_BULK, err);
+    builder.reset(Lane::Public).url("https://api.test").path("/candles?start=2").header("A:2");
+    int second = send_request(builder.lane(), builder.url(), builder.headers(), nullptr, P_BULK, err);
+    ASSERT_NE(first, 0) << err;
+    ASSERT_NE(second, 0) << err;
+    EXPECT_EQ(mock.inFlight(), 2u);
+
+    long n;
+    while (!(n = transport().wait(second, 10))) {}
+    auto secondBody = receive_content(second, n);
+    ASSERT_TRUE(secondBody);
+    EXPECT_STREQ(secondBody.content(), "\"/candles?start=2\"");
+    while (!(n = transport().wait(first, 10))) {}
+    auto firstBody = receive_content(first, n);
+    ASSERT_TRUE(firstBody);
+    EXPECT_STREQ(firstBody.content(), "\"/candles?start=1\"");
+
+    auto requests = mock.requests();
+    ASSERT_EQ(requests.size(), 2u);
+    EXPECT_EQ(requests[0].headers, "A:1");
+    EXPECT_EQ(requests[1].headers, "A:2");
+    EXPECT_EQ(mock.inFlight(), 0u);
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "gdax/signer.h"
+
+using gdax::HmacSigner;
+
+namespace {
+    std::string fromHex(const std::string& hex) {
+        std::string bytes;
+        for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+            bytes.push_back((char)std::stoi(hex.substr(i, 2), nullptr, 16));
+        }
+        return bytes;
+    }
+
+    std::string toBase64(const std::string& bytes) {
+        static const char s_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        uint32_t bits = 0;
+        int32_t n = 0;
+        for (unsigned char c : bytes) {
+            bits = bits << 8 | c;
+            for (n += 8; n >= 6; n -= 6) {
+                out.push_back(s_alphabet[(bits >> (n - 6)) & 0x3f]);
+            }
+        }
+        if (n) {
+            out.push_back(s_alphabet[(bits << (6 - n)) & 0x3f]);
+        }
+        while (out.size() % 4) {
+            out.push_back('=');
+        }
+        return out;
+    }
+
+    std::string sign(const std::string& key, const std::string& message) {
+        HmacSigner signer;
+        signer.setKey((const uint8_t*)key.data(), key.size());
+        char out[HmacSigner::s_base64Size + 1];
+        HmacSigner::Message(signer).update(message.data(), message.size()).finalBase64(out);
+        return out;
+    }
+
+    // HMAC-SHA256 as in RFC 2104, keyed for every message
+    std::string reference(std::string key, const std::string& message) {
+        if (key.size() > HmacSigner::s_blockSize) {
+            std::string digest(HmacSigner::s_digestSize, '\0');
+            CryptoPP::SHA256().CalculateDigest((CryptoPP::byte*)&digest[0], (const CryptoPP::byte*)key.data(), key.size());
+            key = digest;
+        }
+        key.resize(HmacSigner::s_blockSize, '\0');
+        std::string inner = key, outer = key;
+        for (size_t i = 0; i < key.size(); ++i) {
+            inner[i] ^= 0x36;
+            outer[i] ^= 0x5c;
+        }
+        std::string digest(HmacSigner::s_digestSize, '\0');
+        inner += message;
+        CryptoPP::SHA256().CalculateDigest((CryptoPP::byte*)&digest[0], (const CryptoPP::byte*)inner.data(), inner.size());
+        outer += digest;
+        CryptoPP::SHA256().CalculateDigest((CryptoPP::byte*)&digest[0], (const CryptoPP::byte*)outer.data(), outer.size());
+        return toBase64(digest);
+    }
+}
+
+TEST(HmacSigner, Rfc4231) {
+    struct Case {
+        std::string key;
+        std::string data;
+        const char* mac;
+    };
+    const Case cases[] = {
+        { std::string(20, '\x0b'), "Hi There", "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7" },
+        { "Jefe", "what do ya want for nothing?", "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843" },
+        { std::string(20, '\xaa'), std::string(50, '\xdd'), "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe" },
+        { fromHex("0102030405060708090a0b0c0d0e0f10111213141516171819"), std::string(50, '\xcd'),
+            "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b" },
+        // keys longer than the block size are hashed first
+        { std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First",
+            "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54" },
+        { std::string(131, '\xaa'), "This is a test using a larger than block-size key and a larger than block-size data. "
+            "The key needs to be hashed before being used by the HMAC algorithm.",
+            "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2" },
+    };
+    for (auto& c : cases) {
+        EXPECT_EQ(sign(c.key, c.data), toBase64(fromHex(c.mac))) << c.data;
+    }
+}
+
+TEST(HmacSigner, Base64Key) {
+    HmacSigner signer;
+    // base64 of "Jefe"
+    signer.setBase64Key("SmVmZQ==");
+    char out[HmacSigner::s_base64Size + 1];
+    HmacSigner::Message(signer).update("what do ya want for nothing?", 28).finalBase64(out);
+    EXPECT_STREQ(out, toBase64(fromHex("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843")).c_str());
+    EXPECT_EQ(strlen(out), HmacSigner::s_base64Size);
+}
+
+TEST(HmacSigner, MessagesInPartsMatchReference) {
+    // a signer is keyed once and signs many messages, fed in parts like the prehash of a request
+    std::mt19937_64 rng(4231);
+    for (int k = 0; k < 20; ++k) {
+        std::string key(rng() % 200, '\0');
+        for (auto& c : key) {
+            c = (char)rng();
+        }
+        HmacSigner signer;
+        signer.setKey((const uint8_t*)key.data(), key.size());
+
+        for (int m = 0; m < 50; ++m) {
+            std::string message(rng() % 300, '\0');
+            for (auto& c : message) {
+                c = (char)rng();
+            }
+            HmacSigner::Message mac(signer);
+            for (size_t i = 0; i < message.size();) {
+                auto n = std::min<size_t>(rng() % 70, message.size() - i);
+                mac.update(message.data() + i, n);
+                i += n;
+            }
+            char out[HmacSigner::s_base64Size + 1];
+            mac.finalBase64(out);
+            ASSERT_EQ(out, reference(key, message)) << "key " << key.size() << " message " << message.size();
+        }
+    }
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "throttler.h"
+
+using gdax::Throttler;
+
+namespace {
+    // simulated clock of the throttlers under test, in microseconds
+    uint64_t s_now = 0;
+    uint64_t simulatedClock() { return s_now; }
+
+    struct ThrottlerTest : ::testing::Test {
+        void SetUp() override { s_now = 1000000000; }
+    };
+
+    // take tokens until the bucket is empty
+    uint32_t drain(Throttler& throttler, gdax::Priority priority = gdax::P_TRADING) {
+        uint32_t n = 0;
+        while (throttler.tryAcquire(priority) == 0) {
+            ++n;
+        }
+        return n;
+    }
+}
+
+TEST_F(ThrottlerTest, BurstThenRate) {
+    Throttler throttler(5, 10, &simulatedClock);
+    EXPECT_EQ(throttler.waitTime(), 0u);
+    EXPECT_EQ(drain(throttler), 10u);
+
+    // the next token is one interval away
+    EXPECT_EQ(throttler.tryAcquire(), 200000u);
+    EXPECT_EQ(throttler.waitTime(), 200000u);
+    s_now += 199999;
+    EXPECT_EQ(throttler.tryAcquire(), 1u);
+    s_now += 1;
+    EXPECT_EQ(throttler.tryAcquire(), 0u);
+    EXPECT_EQ(throttler.tryAcquire(), 200000u);
+}
+
+TEST_F(ThrottlerTest, RefillsUpToTheBurst) {
+    Throttler throttler(3, 6, &simulatedClock);
+    EXPECT_EQ(drain(throttler), 6u);
+
+    // one second refills 3 tokens
+    s_now += 1000000;
+    EXPECT_EQ(drain(throttler), 3u);
+
+    // an idle minute refills the bucket, not more
+    s_now += 60000000;
+    EXPECT_EQ(drain(throttler), 6u);
+}
+
+TEST_F(ThrottlerTest, SustainedRate) {
+    Throttler throttler(5, 10, &simulatedClock);
+    // a caller sleeping exactly the returned time gets the configured rate after the burst
+    const uint64_t start = s_now;
+    uint32_t sent = 0;
+    while (sent < 60) {
+        auto wait = throttler.tryAcquire();
+        if (wait) {
+            s_now += wait;
+        }
+        else {
+            ++sent;
+        }
+    }
+    // 10 in the burst, then 50 at 5/s
+    EXPECT_EQ(s_now - start, 10000000u);
+}
+
+TEST_F(ThrottlerTest, BurstOfOne) {
+    Throttler throttler(2, 0, &simulatedClock);
+    EXPECT_EQ(throttler.tryAcquire(), 0u);
+    EXPECT_EQ(throttler.tryAcquire(), 500000u);
+    s_now += 500000;
+    EXPECT_EQ(throttler.tryAcquire(), 0u);
+}
+
+TEST_F(ThrottlerTest, BulkKeepsOneTokenInReserve) {
+    Throttler throttler(5, 10, &simulatedClock);
+    EXPECT_EQ(drain(throttler, gdax::P_BULK), 9u);
+    EXPECT_EQ(throttler.tryAcquire(gdax::P_BULK), 200000u);
+    EXPECT_EQ(throttler.tryAcquire(gdax::P_STATUS), 0u);
+    EXPECT_NE(throttler.tryAcquire(gdax::P_TRADING), 0u);
+}
+
+TEST_F(ThrottlerTest, TradingTakesTheReserve) {
+    Throttler throttler(5, 10, &simulatedClock);
+    EXPECT_EQ(drain(throttler, gdax::P_BULK), 9u);
+    EXPECT_EQ(throttler.tryAcquire(gdax::P_TRADING), 0u);
+    EXPECT_EQ(throttler.tryAcquire(gdax::P_TRADING), 200000u);
+}
+
+TEST_F(ThrottlerTest, LowerPrioritiesYieldToWaitingRequests) {
+    Throttler throttler(5, 10, &simulatedClock);
+    EXPECT_EQ(drain(throttler), 10u);
+    {
+        Throttler::Waiting trading(throttler, gdax::P_TRADING);
+        s_now += 200000;
+        // the refilled token goes to the waiting trading request, the others retry one interval later
+        EXPECT_EQ(throttler.tryAcquire(gdax::P_STATUS), 200000u);
+        EXPECT_EQ(throttler.tryAcquire(gdax::P_BULK), 200000u);
+        EXPECT_EQ(throttler.tryAcquire(gdax::P_TRADING), 0u);
+    }
+    s_now += 200000;
+    EXPECT_EQ(throttler.tryAcquire(gdax::P_STATUS), 0u);
+}
+
+TEST_F(ThrottlerTest, StatusYieldsOnlyToTrading) {
+    Throttler throttler(5, 10, &simulatedClock);
+    Throttler::Waiting bulk(throttler, gdax::P_BULK);
+    EXPECT_EQ(throttler.tryAcquire(gdax::P_STATUS), 0u);
+    {
+        Throttler::Waiting status(throttler, gdax::P_STATUS);
+        EXPECT_EQ(throttler.tryAcquire(gdax::P_TRADING), 0u);
+        EXPECT_NE(throttler.tryAcquire(gdax::P_BULK), 0u);
+    }
+    EXPECT_EQ(throttler.tryAcquire(gdax::P_BULK), 0u);
+}
+
+TEST_F(ThrottlerTest, TradingUnderBulkLoad) {
+    // a bulk download sleeping on the throttler leaves the last token to an order
+    Throttler throttler(5, 10, &simulatedClock);
+    Throttler::Waiting bulk(throttler, gdax::P_BULK);
+    for (int i = 0; i < 100; ++i) {
+        s_now += throttler.tryAcquire(gdax::P_BULK);
+    }
+    EXPECT_EQ(throttler.tryAcquire(gdax::P_TRADING), 0u);
+}
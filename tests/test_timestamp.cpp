@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <string>
+
+#include "gdax/timestamp.h"
+
+using gdax::s_nanosPerSecond;
+
+namespace {
+    int64_t parse(const std::string& s) {
+        int64_t nanos = -1;
+        EXPECT_TRUE(gdax::parseTimestamp(s.c_str(), s.size(), nanos)) << s;
+        return nanos;
+    }
+
+    bool parses(const std::string& s) {
+        int64_t nanos;
+        return gdax::parseTimestamp(s.c_str(), s.size(), nanos);
+    }
+
+    std::string format(int64_t nanos, int32_t decimals = 6) {
+        char buf[32];
+        auto n = gdax::formatTimestamp(nanos, buf, decimals);
+        return std::string(buf, n);
+    }
+}
+
+TEST(Timestamp, Parse) {
+    EXPECT_EQ(parse("1970-01-01T00:00:00Z"), 0);
+    EXPECT_EQ(parse("2019-08-14T20:42:27.265123Z"), 1565815347265123000);
+    EXPECT_EQ(parse("2019-08-14 20:42:27.265123+00:00"), 1565815347265123000);
+    EXPECT_EQ(parse("2019-08-14T20:42:27"), 1565815347000000000);
+    EXPECT_EQ(parse("2019-08-14T22:42:27+02:00"), 1565815347000000000);
+    EXPECT_EQ(parse("2019-08-14T18:42:27-02:00"), 1565815347000000000);
+    // more than 9 fraction digits are truncated
+    EXPECT_EQ(parse("1970-01-01T00:00:01.1234567891Z"), 1123456789);
+    EXPECT_EQ(parse("1969-12-31T23:59:59.5Z"), -s_nanosPerSecond / 2);
+    EXPECT_EQ(parse("2000-02-29T00:00:00Z"), 951782400 * s_nanosPerSecond);
+}
+
+TEST(Timestamp, RejectsInvalidStrings) {
+    EXPECT_FALSE(parses(""));
+    EXPECT_FALSE(parses("2019-08-14"));
+    EXPECT_FALSE(parses("2019/08/14T20:42:27Z"));
+    EXPECT_FALSE(parses("2019-13-14T20:42:27Z"));
+    EXPECT_FALSE(parses("2019-00-14T20:42:27Z"));
+    EXPECT_FALSE(parses("2019-08-32T20:42:27Z"));
+    EXPECT_FALSE(parses("2019-08-14T24:42:27Z"));
+    EXPECT_FALSE(parses("2019-08-14T20:42:27ZZ"));
+    EXPECT_FALSE(parses("2019-08-14T20:42:27+0200"));
+    EXPECT_FALSE(parses("2019-08-14T2a:42:27Z"));
+}
+
+TEST(Timestamp, Format) {
+    EXPECT_EQ(format(1565815347265123000), "2019-08-14T20:42:27.265123Z");
+    EXPECT_EQ(format(1565815347265123000, 0), "2019-08-14T20:42:27Z");
+    EXPECT_EQ(format(1565815347265123456, 9), "2019-08-14T20:42:27.265123456Z");
+    EXPECT_EQ(format(1565815347265123456, 12), "2019-08-14T20:42:27.265123456Z");
+    EXPECT_EQ(format(-s_nanosPerSecond / 2, 3), "1969-12-31T23:59:59.500Z");
+    EXPECT_EQ(format(0, 0), "1970-01-01T00:00:00Z");
+}
+
+TEST(Timestamp, MatchesGmtime) {
+    std::mt19937_64 rng(20190814);
+    // 1900 to 2100
+    std::uniform_int_distribution<int64_t> seconds(-2208988800LL, 4102444800LL);
+    char buf[32];
+    char expected[32];
+    for (int i = 0; i < 1000000; ++i) {
+        const int64_t s = seconds(rng);
+        const time_t t = (time_t)s;
+        struct tm tm;
+        ASSERT_EQ(gmtime_s(&tm, &t), 0);
+        strftime(expected, sizeof(expected), "%Y-%m-%dT%H:%M:%SZ", &tm);
+
+        auto n = gdax::formatTimestamp(s * s_nanosPerSecond, buf, 0);
+        ASSERT_STREQ(buf, expected);
+
+        int64_t nanos;
+        ASSERT_TRUE(gdax::parseTimestamp(buf, n, nanos)) << buf;
+        ASSERT_EQ(nanos, s * s_nanosPerSecond) << buf;
+    }
+}
+
+TEST(Timestamp, RoundTrip) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int64_t> nanos(0, 4102444800LL * s_nanosPerSecond);
+    char buf[32];
+    for (int i = 0; i < 100000; ++i) {
+        const int64_t t = nanos(rng);
+        auto n = gdax::formatTimestamp(t, buf, 9);
+        int64_t back;
+        ASSERT_TRUE(gdax::parseTimestamp(buf, n, back)) << buf;
+        ASSERT_EQ(back, t) << buf;
+    }
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gdax/trade_registry.h"
+
+using gdax::Trade;
+using gdax::TradeRegistry;
+using gdax::Uuid;
+
+namespace {
+    Uuid makeId(uint64_t n) {
+        Uuid id;
+        id.hi = 0x1234567890abcdefull;
+        id.lo = n;
+        return id;
+    }
+
+    std::string readFile(const std::string& path) {
+        std::ifstream f(path);
+        std::stringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+
+    size_t countLines(const std::string& s) {
+        size_t n = 0;
+        for (auto c : s) {
+            n += c == '\n';
+        }
+        return n;
+    }
+
+    class TradeRegistryTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            path_ = ::testing::TempDir() + "gdax_trades_" + ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".txt";
+            std::remove(path_.c_str());
+        }
+
+        void TearDown() override {
+            std::remove(path_.c_str());
+        }
+
+        std::string path_;
+    };
+}
+
+TEST_F(TradeRegistryTest, IdsAreFoundAndReusedSlotsGetNewIds) {
+    TradeRegistry trades(path_);
+    auto a = trades.add(makeId(1), nullptr);
+    auto b = trades.add(makeId(2), nullptr);
+    ASSERT_GT(a, 0);
+    ASSERT_GT(b, 0);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(trades.size(), 2u);
+    ASSERT_NE(trades.find(a), nullptr);
+    EXPECT_EQ(trades.find(a)->order_id, makeId(1));
+
+    trades.remove(a);
+    EXPECT_EQ(trades.find(a), nullptr);
+    auto c = trades.add(makeId(3), nullptr);
+    // the slot of a, with another id
+    EXPECT_EQ((uint32_t)c & (TradeRegistry::s_maxTrades - 1), (uint32_t)a & (TradeRegistry::s_maxTrades - 1));
+    EXPECT_NE(c, a);
+    EXPECT_EQ(trades.find(a), nullptr);
+    EXPECT_EQ(trades.find(0), nullptr);
+    EXPECT_EQ(trades.find(-c), nullptr);
+}
+
+TEST_F(TradeRegistryTest, FullRegistryRefusesTrades) {
+    TradeRegistry trades(path_);
+    for (size_t i = 0; i < TradeRegistry::s_maxTrades; ++i) {
+        ASSERT_GT(trades.add(Uuid(), nullptr), 0);
+    }
+    EXPECT_EQ(trades.add(Uuid(), nullptr), 0);
+    EXPECT_EQ(trades.size(), TradeRegistry::s_maxTrades);
+}
+
+TEST_F(TradeRegistryTest, ChangesAreAppendedToTheJournal) {
+    std::vector<int32_t> ids;
+    {
+        TradeRegistry trades(path_);
+        for (uint64_t i = 1; i <= 5; ++i) {
+            ids.push_back(trades.add(makeId(i), nullptr));
+        }
+        trades.remove(ids[1]);
+        // not acknowledged yet, not saved until its order is set
+        auto pending = trades.add(Uuid(), nullptr);
+        EXPECT_EQ(countLines(readFile(path_)), 6u);
+        trades.setOrder(pending, makeId(6), nullptr);
+        ids.push_back(pending);
+        EXPECT_EQ(countLines(readFile(path_)), 7u);
+
+        // a session killed before compacting: the journal is replayed
+        std::ofstream(path_ + ".copy") << readFile(path_);
+        TradeRegistry replayed(path_ + ".copy");
+        EXPECT_EQ(replayed.load(), 5u);
+        EXPECT_EQ(replayed.find(ids[1]), nullptr);
+        ASSERT_NE(replayed.find(ids[5]), nullptr);
+        EXPECT_EQ(replayed.find(ids[5])->order_id, makeId(6));
+    }
+    std::remove((path_ + ".copy").c_str());
+
+    // compacted on destruction, one line per open trade
+    EXPECT_EQ(countLines(readFile(path_)), 5u);
+
+    TradeRegistry trades(path_);
+    EXPECT_EQ(trades.load(), 5u);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i == 1) {
+            EXPECT_EQ(trades.find(ids[i]), nullptr);
+            continue;
+        }
+        auto* trade = trades.find(ids[i]);
+        ASSERT_NE(trade, nullptr);
+        EXPECT_EQ(trade->order_id, makeId(i + 1));
+        EXPECT_EQ(trade->order, nullptr);
+    }
+
+    // new trades do not collide with the loaded ones
+    auto next = trades.add(makeId(7), nullptr);
+    for (auto id : ids) {
+        EXPECT_NE(next, id);
+    }
+    EXPECT_EQ(trades.size(), 6u);
+}
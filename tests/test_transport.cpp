@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "request.h"
+#include "gdax/time.h"
+#include "support/mock_transport.h"
+
+using namespace gdax;
+using gdax::test::MockHttpTransport;
+using gdax::test::MockResponse;
+
+namespace {
+    RequestBuilder& builder(Lane lane, const char* path) {
+        return RequestBuilder::get().reset(lane).url("https://api.test").path(path).header("User-Agent:Zorro");
+    }
+}
+
+TEST(Transport, GetIsParsedInPlace) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("GET /time", R"({"iso":"2021-02-16T06:50:04.467Z","epoch":1613458204.467})");
+
+    auto response = request<Time>(builder(Lane::Public, "/time"));
+    ASSERT_TRUE(response) << response.what();
+    EXPECT_EQ(response.content().iso, "2021-02-16T06:50:04.467Z");
+    EXPECT_EQ(response.content().epoch, 1613458204467u);
+
+    auto requests = mock.requests();
+    ASSERT_EQ(requests.size(), 1u);
+    EXPECT_EQ(requests[0].lane, Lane::Public);
+    EXPECT_EQ(requests[0].method, "GET");
+    EXPECT_EQ(requests[0].path, "/time");
+    EXPECT_EQ(requests[0].headers, "User-Agent:Zorro");
+    EXPECT_EQ(mock.inFlight(), 0u);
+}
+
+TEST(Transport, MethodAndBodyArePassed) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("DELETE /orders/", "\"ok\"");
+    mock.on("POST /orders", "\"ok\"");
+
+    EXPECT_TRUE(request<std::string>(builder(Lane::Private, "/orders/abc"), "#DELETE"));
+    EXPECT_TRUE(request<std::string>(builder(Lane::Private, "/orders"), R"({"size":"1"})"));
+
+    auto requests = mock.requests();
+    ASSERT_EQ(requests.size(), 2u);
+    EXPECT_EQ(requests[0].method, "DELETE");
+    EXPECT_EQ(requests[0].path, "/orders/abc");
+    EXPECT_EQ(requests[0].lane, Lane::Private);
+    EXPECT_EQ(requests[1].method, "POST");
+    EXPECT_EQ(requests[1].body, R"({"size":"1"})");
+}
+
+TEST(Transport, PendingRequestIsWaitedFor) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("GET /time", [](const test::MockRequest&) {
+        MockResponse response{ R"({"iso":"","epoch":1.5})" };
+        response.pendingWaits = 5;
+        return response;
+    });
+
+    auto response = request<Time>(builder(Lane::Public, "/time"));
+    ASSERT_TRUE(response) << response.what();
+    EXPECT_EQ(response.content().epoch, 1500u);
+    EXPECT_EQ(mock.inFlight(), 0u);
+}
+
+TEST(Transport, ErrorsAreReported) {
+    auto& mock = MockHttpTransport::install();
+    mock.on("GET /down", [](const test::MockRequest&) { return MockResponse{ "", -3 }; });
+    mock.on("GET /unknown-host", [](const test::MockRequest&) { return MockResponse{ "", -4 }; });
+
+    auto down = request<Time>(builder(Lane::Public, "/down"));
+    EXPECT_FALSE(down);
+    EXPECT_EQ(down.what(), "Website did not response");
+
+    auto unresolved = request<Time>(builder(Lane::Public, "/unknown-host"));
+    EXPECT_FALSE(unresolved);
+    EXPECT_EQ(unresolved.what(), "Host could not be resolved");
+
+    // no handler, answered like Coinbase answers an unknown path
+    auto notFound = request<Time>(builder(Lane::Public, "/nothing"));
+    EXPECT_FALSE(notFound);
+    EXPECT_EQ(notFound.what(), "NotFound");
+    EXPECT_EQ(mock.inFlight(), 0u);
+}
+
+TEST(Transport, TooLongRequestIsNotSent) {
+    auto& mock = MockHttpTransport::install();
+    std::string path(4096, 'a');
+    auto response = request<Time>(builder(Lane::Public, path.c_str()));
+    EXPECT_FALSE(response);
+    EXPECT_TRUE(mock.requests().empty());
+}
@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "rapidjson/document.h"
+#include "gdax/websocket.h"
+#include "support/zorro_stubs.h"
+
+using namespace gdax;
+
+namespace {
+    // base64 of "secret"
+    const char* s_secret = "c2VjcmV0";
+
+    struct WebsocketTest : ::testing::Test {
+        std::unique_ptr<GdaxWebsocket> ws = std::make_unique<GdaxWebsocket>();
+
+        void SetUp() override {
+            test::takeBrokerErrors();
+        }
+
+        void open() {
+            ASSERT_TRUE(ws->login("key", "phrase", s_secret, true));
+            ws->onWebsocketOpened(ws->lastId);
+        }
+
+        void receive(const std::string& msg) {
+            ws->onWebsocketData(ws->lastId, msg.data(), msg.size(), 0);
+        }
+
+        size_t subscriptions(const std::string& product) {
+            size_t n = 0;
+            for (auto& msg : ws->sent) {
+                n += msg.find("\"subscribe\"") != std::string::npos && msg.find("\"" + product + "\"") != std::string::npos;
+            }
+            return n;
+        }
+    };
+
+    // reference level2 book, rebuilt from the replayed messages with a DOM
+    struct ReferenceBook {
+        std::map<Decimal, Decimal, std::greater<Decimal>> bids;
+        std::map<Decimal, Decimal> asks;
+        double price = NAN;
+        double volume = NAN;
+
+        void set(bool buy, const rapidjson::Value& price, const rapidjson::Value& size) {
+            Decimal p, s;
+            ASSERT_TRUE(Decimal::parse(price.GetString(), price.GetStringLength(), p));
+            ASSERT_TRUE(Decimal::parse(size.GetString(), size.GetStringLength(), s));
+            if (buy) {
+                s.isZero() ? (void)bids.erase(p) : (void)(bids[p] = s);
+            }
+            else {
+                s.isZero() ? (void)asks.erase(p) : (void)(asks[p] = s);
+            }
+        }
+    };
+
+    std::string snapshot(const char* product, double mid, double tick) {
+        std::string bids, asks;
+        for (int i = 1; i <= 5; ++i) {
+            char level[64];
+            snprintf(level, sizeof(level), "%s[\"%.3f\",\"%d.5\"]", i > 1 ? "," : "", mid - tick * i * 10, i);
+            bids += level;
+            snprintf(level, sizeof(level), "%s[\"%.3f\",\"%d.5\"]", i > 1 ? "," : "", mid + tick * i * 10, i);
+            asks += level;
+        }
+        return std::string("{\"type\":\"snapshot\",\"product_id\":\"") + product + "\",\"bids\":[" + bids + "],\"asks\":[" + asks + "]}";
+    }
+}
+
+TEST_F(WebsocketTest, SubscribesOnceWhenOpened) {
+    ASSERT_TRUE(ws->login("key", "phrase", s_secret, true));
+    EXPECT_EQ(ws->openedUrl, "wss://ws-feed-public.sandbox.pro.coinbase.com");
+
+    // requested before the websocket is opened, subscribed by onWebsocketOpened()
+    EXPECT_FALSE(ws->subscribe("BTC-USD"));
+    EXPECT_TRUE(ws->sent.empty());
+    ws->onWebsocketOpened(ws->lastId);
+    EXPECT_TRUE(ws->isOpened());
+    EXPECT_EQ(subscriptions("BTC-USD"), 1u);
+    // the user channel is signed
+    EXPECT_NE(ws->sent[0].find("\"user\""), std::string::npos);
+    EXPECT_NE(ws->sent[0].find("\"signature\""), std::string::npos);
+
+    EXPECT_TRUE(ws->subscribe("BTC-USD"));
+    EXPECT_TRUE(ws->subscribe("ETH-USD"));
+    EXPECT_EQ(subscriptions("BTC-USD"), 1u);
+    EXPECT_EQ(subscriptions("ETH-USD"), 1u);
+}
+
+TEST_F(WebsocketTest, ResubscribesAfterRelogin) {
+    open();
+    ws->subscribe("BTC-USD");
+    receive(R"({"type":"ticker","product_id":"BTC-USD","price":"100","best_bid":"99","best_ask":"101","volume_24h":"5"})");
+    Quote quote;
+    ASSERT_TRUE(ws->getQuote("BTC-USD", quote));
+
+    ws->logout();
+    EXPECT_FALSE(ws->isOpened());
+    ASSERT_EQ(ws->closed.size(), 1u);
+    EXPECT_EQ(ws->closed[0], 1u);
+    EXPECT_FALSE(ws->getQuote("BTC-USD", quote));
+    // the websocket thread drops the quotes once closed
+    ws->onWebsocketClosed(1);
+
+    ws->sent.clear();
+    open();
+    EXPECT_EQ(subscriptions("BTC-USD"), 1u);
+    EXPECT_FALSE(ws->getQuote("BTC-USD", quote));
+}
+
+TEST_F(WebsocketTest, TickerQuotesUntilTheBookIsSynced) {
+    open();
+    ws->subscribe("ETH-USD");
+    receive(R"({"type":"ticker","product_id":"ETH-USD","price":"3015.5","best_bid":"3015.12","best_ask":"3015.5","volume_24h":"912345678901234.5"})");
+    Quote quote;
+    ASSERT_TRUE(ws->getQuote("ETH-USD", quote));
+    EXPECT_EQ(quote.bid, 3015.12);
+    EXPECT_EQ(quote.ask, 3015.5);
+    EXPECT_EQ(quote.price, 3015.5);
+    EXPECT_EQ(quote.volume, 912345678901234.5);
+
+    // updates before the snapshot are ignored
+    receive(R"({"type":"l2update","product_id":"ETH-USD","changes":[["buy","3015.40","1"]]})");
+    ASSERT_TRUE(ws->getQuote("ETH-USD", quote));
+    EXPECT_EQ(quote.bid, 3015.12);
+
+    receive(R"({"type":"snapshot","product_id":"ETH-USD","bids":[["3015.00","1"],["3014.00","2"]],"asks":[["3016.00","1"]]})");
+    receive(R"({"type":"l2update","product_id":"ETH-USD","changes":[["buy","3015.00","0"],["sell","3015.80","0.1"]]})");
+    // the book has the best bid and ask, the ticker the last trade
+    receive(R"({"type":"ticker","product_id":"ETH-USD","price":"3015.7","best_bid":"1","best_ask":"2","volume_24h":"10"})");
+    ASSERT_TRUE(ws->getQuote("ETH-USD", quote));
+    EXPECT_EQ(quote.bid, 3014.);
+    EXPECT_EQ(quote.ask, 3015.8);
+    EXPECT_EQ(quote.price, 3015.7);
+    EXPECT_EQ(quote.volume, 10.);
+
+    // products which are not subscribed are ignored
+    receive(R"({"type":"ticker","product_id":"BTC-USD","price":"1"})");
+    EXPECT_FALSE(ws->getQuote("BTC-USD", quote));
+}
+
+TEST_F(WebsocketTest, ChunkedMessage) {
+    open();
+    ws->subscribe("BTC-USD");
+    std::string msg = R"({"type":"ticker","product_id":"BTC-USD","price":"48726.63","best_bid":"48726.62","best_ask":"48726.63"})";
+    ws->onWebsocketData(ws->lastId, msg.data(), 20, msg.size() - 20);
+    ws->onWebsocketData(ws->lastId, msg.data() + 20, 30, msg.size() - 50);
+    ws->onWebsocketData(ws->lastId, msg.data() + 50, msg.size() - 50, 0);
+    Quote quote;
+    ASSERT_TRUE(ws->getQuote("BTC-USD", quote));
+    EXPECT_EQ(quote.price, 48726.63);
+}
+
+TEST_F(WebsocketTest, ErrorMessageIsReported) {
+    open();
+    receive(R"({"type":"error","message":"Failed to subscribe","reason":"XYZ-USD is not a valid product"})");
+    auto errors = test::takeBrokerErrors();
+    ASSERT_EQ(errors.size(), 1u);
+    EXPECT_EQ(errors[0], "Websocket error: Failed to subscribe XYZ-USD is not a valid product");
+}
+
+TEST_F(WebsocketTest, ReplayRecordedFeed) {
+    open();
+    std::map<std::string, ReferenceBook> books;
+    const char* products[] = { "BTC-USD", "ETH-USD", "SOL-USD" };
+    const double mids[] = { 48726.63, 3015.12, 71.234 };
+    const double ticks[] = { 0.01, 0.01, 0.001 };
+    for (int i = 0; i < 3; ++i) {
+        ws->subscribe(products[i]);
+        auto msg = snapshot(products[i], mids[i], ticks[i]);
+        receive(msg);
+
+        rapidjson::Document d;
+        d.Parse(msg.c_str());
+        for (auto& level : d["bids"].GetArray()) {
+            books[products[i]].set(true, level[0], level[1]);
+        }
+        for (auto& level : d["asks"].GetArray()) {
+            books[products[i]].set(false, level[0], level[1]);
+        }
+    }
+
+    std::ifstream in(TEST_DATA_DIR "/feed.jsonl");
+    ASSERT_TRUE(in.good());
+    size_t messages = 0;
+    for (std::string line; std::getline(in, line); ++messages) {
+        receive(line);
+
+        rapidjson::Document d;
+        d.Parse(line.c_str());
+        ASSERT_FALSE(d.HasParseError());
+        std::string type = d["type"].GetString();
+        if (type == "l2update") {
+            auto& book = books[d["product_id"].GetString()];
+            for (auto& change : d["changes"].GetArray()) {
+                book.set(strcmp(change[0].GetString(), "buy") == 0, change[1], change[2]);
+            }
+        }
+        else if (type == "ticker") {
+            auto& book = books[d["product_id"].GetString()];
+            book.price = atof(d["price"].GetString());
+            book.volume = atof(d["volume_24h"].GetString());
+        }
+        else {
+            continue;
+        }
+
+        auto product = d["product_id"].GetString();
+        auto& book = books[product];
+        Quote quote;
+        ASSERT_TRUE(ws->getQuote(product, quote));
+        ASSERT_FALSE(book.bids.empty());
+        ASSERT_FALSE(book.asks.empty());
+        ASSERT_EQ(quote.bid, book.bids.begin()->first.toDouble()) << line;
+        ASSERT_EQ(quote.ask, book.asks.begin()->first.toDouble()) << line;
+        if (!std::isnan(book.price)) {
+            ASSERT_EQ(quote.price, book.price) << line;
+            ASSERT_EQ(quote.volume, book.volume) << line;
+        }
+    }
+    EXPECT_GT(messages, 400u);
+    EXPECT_TRUE(test::takeBrokerErrors().empty());
+}